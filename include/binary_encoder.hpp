@@ -0,0 +1,176 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "exception.hpp"
+#include "measurement.hpp"
+
+namespace qds_buffer {
+
+    namespace core {
+
+        /*
+        * Compact binary encoding of a QDS data set (see IDataSourceIn::AddBinary)
+        *
+        * Layout (all integers little-endian, varint = unsigned LEB128):
+        * - header:      version (1 byte, kBinaryFormatVersion), measurement count (4 bytes)
+        * - measurement: type tag (1 byte, numeric value of MeasurementType), name (varint length + bytes),
+        *                unit (varint length + bytes, length 0 = no unit), value
+        * - value:       STRING/WORD/TIMESTAMP/REF/FOREIGN_KEY: varint length + bytes
+        *                INTEGER/LONG: zigzag encoded varint
+        *                FLOAT/DOUBLE: IEEE 754 double (8 bytes)
+        *                BOOL: 1 byte (0 or 1)
+        */
+        const std::uint8_t kBinaryFormatVersion = 1;
+        const size_t kBinaryHeaderSize = 5;
+
+        /*
+        * Builds a binary encoded QDS data set, measurement by measurement
+        *
+        * Not Thread-Safe
+        */
+        class BinaryEncoder {
+        public:
+            BinaryEncoder() : count_(0) {
+                bytes_.resize(kBinaryHeaderSize);
+            }
+
+            /*
+            * Encodes a complete data set
+            *
+            * @throws ParsingException if a VALUE does not match its TYPE
+            */
+            static std::vector<std::uint8_t> Encode(const std::vector<Measurement>& measurements) {
+                BinaryEncoder encoder;
+                for (auto& measurement : measurements) {
+                    encoder.Add(measurement);
+                }
+                return encoder.Finish();
+            }
+
+            /*
+            * Adds a measurement; the value has to be stored in the variant type matching its TYPE
+            *
+            * @throws ParsingException if the VALUE does not match its TYPE
+            */
+            void Add(const Measurement& measurement) {
+                switch (measurement.value_.which()) {
+                    case 1: return Add(measurement.name_, measurement.type_, boost::get<std::string>(measurement.value_), measurement.unit_);
+                    case 2: return Add(measurement.name_, measurement.type_, boost::get<std::int64_t>(measurement.value_), measurement.unit_);
+                    case 3: return Add(measurement.name_, measurement.type_, boost::get<double>(measurement.value_), measurement.unit_);
+                    case 4: return Add(measurement.name_, measurement.type_, boost::get<bool>(measurement.value_), measurement.unit_);
+                    default: throw ParsingException("Measurement missing VALUE", "BinaryEncoder::Add");
+                }
+            }
+
+            /*
+            * Adds a STRING, WORD, TIMESTAMP, REF or FOREIGN_KEY measurement
+            */
+            void Add(const std::string& name, MeasurementType type, const std::string& value, const std::string& unit = "") {
+                CheckType(name, IsStringType(type));
+                AddHeader(name, type, unit);
+                AddString(value);
+            }
+
+            void Add(const std::string& name, MeasurementType type, const char* value, const std::string& unit = "") {
+                Add(name, type, std::string(value), unit);
+            }
+
+            /*
+            * Adds an INTEGER or LONG measurement
+            */
+            void Add(const std::string& name, MeasurementType type, std::int64_t value, const std::string& unit = "") {
+                CheckType(name, type == MeasurementType::kInteger || type == MeasurementType::kLong);
+                AddHeader(name, type, unit);
+                AddVarint((static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+            }
+
+            void Add(const std::string& name, MeasurementType type, int value, const std::string& unit = "") {
+                Add(name, type, static_cast<std::int64_t>(value), unit);
+            }
+
+            /*
+            * Adds a FLOAT or DOUBLE measurement
+            */
+            void Add(const std::string& name, MeasurementType type, double value, const std::string& unit = "") {
+                CheckType(name, type == MeasurementType::kFloat || type == MeasurementType::kDouble);
+                AddHeader(name, type, unit);
+                std::uint64_t bits;
+                memcpy(&bits, &value, sizeof(bits));
+                for (int i = 0; i < 8; i++) {
+                    bytes_.push_back(static_cast<std::uint8_t>(bits >> (8 * i)));
+                }
+            }
+
+            /*
+            * Adds a BOOL measurement
+            */
+            void Add(const std::string& name, MeasurementType type, bool value, const std::string& unit = "") {
+                CheckType(name, type == MeasurementType::kBool);
+                AddHeader(name, type, unit);
+                bytes_.push_back(value ? 1 : 0);
+            }
+
+            /*
+            * Returns the encoded data set and resets the encoder
+            */
+            std::vector<std::uint8_t> Finish() {
+                bytes_[0] = kBinaryFormatVersion;
+                for (int i = 0; i < 4; i++) {
+                    bytes_[1 + i] = static_cast<std::uint8_t>(count_ >> (8 * i));
+                }
+
+                std::vector<std::uint8_t> bytes;
+                bytes.swap(bytes_);
+                bytes_.resize(kBinaryHeaderSize);
+                count_ = 0;
+                return bytes;
+            }
+
+            /*
+            * Returns true if values of the given type are encoded as length-prefixed string
+            */
+            static bool IsStringType(MeasurementType type) {
+                return type == MeasurementType::kString || type == MeasurementType::kWord || type == MeasurementType::kTimestamp ||
+                       type == MeasurementType::kRef || type == MeasurementType::kForeignKey;
+            }
+
+        private:
+            void CheckType(const std::string& name, bool matches) {
+                if (!matches) {
+                    throw ParsingException("VALUE of '" + name + "' does not match its TYPE", "BinaryEncoder::Add");
+                }
+            }
+
+            void AddHeader(const std::string& name, MeasurementType type, const std::string& unit) {
+                bytes_.push_back(static_cast<std::uint8_t>(type));
+                AddString(name);
+                AddString(unit);
+                count_++;
+            }
+
+            void AddString(const std::string& value) {
+                AddVarint(value.size());
+                bytes_.insert(bytes_.end(), value.begin(), value.end());
+            }
+
+            void AddVarint(std::uint64_t value) {
+                while (value >= 0x80) {
+                    bytes_.push_back(static_cast<std::uint8_t>(value | 0x80));
+                    value >>= 7;
+                }
+                bytes_.push_back(static_cast<std::uint8_t>(value));
+            }
+
+            std::vector<std::uint8_t> bytes_;
+            std::uint32_t count_;
+        };
+    } // namespace core
+} // namespace qds_buffer
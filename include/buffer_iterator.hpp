@@ -0,0 +1,159 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include <boost/container/small_vector.hpp>
+
+#include "types.hpp"
+
+namespace qds_buffer {
+
+    namespace core {
+
+        /*
+        * Forward iterator over the entries of one or more buffers (shards) of a data source
+        *
+        * With a single buffer, it iterates in buffer order. With several buffers, the entries are merged by id: every step
+        * continues with the smallest id among the current entries of all buffers (in counter mode 0, every buffer is ordered
+        * by id, so the merged sequence is ordered by id as well).
+        *
+        * The end iterator holds no entry; all iterators are invalidated by modifications of the buffers, so the buffer mutex
+        * must be locked while using them.
+        * Not Thread-Safe
+        */
+        class BufferIterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = BufferEntry;
+            using difference_type = std::ptrdiff_t;
+            using pointer = BufferEntry*;
+            using reference = BufferEntry&;
+
+            using Range = std::pair<BufferQueueType::iterator, BufferQueueType::iterator>;   // [begin, end) of a buffer
+
+            /*
+            * end iterator
+            */
+            BufferIterator() : active_(0), seek_pending_(false), seek_id_(0) {}
+
+            /*
+            * Iterator to 'position' in a single range
+            */
+            BufferIterator(const Range& range, BufferQueueType::iterator position) : active_(0), seek_pending_(false), seek_id_(0) {
+                if (position != range.second) {
+                    cursors_.push_back(Cursor{position, range.second});
+                }
+            }
+
+            /*
+            * Iterator to the first entry of the merged ranges
+            */
+            explicit BufferIterator(const std::vector<Range>& ranges) : active_(0), seek_pending_(false), seek_id_(0) {
+                for (auto& range : ranges) {
+                    if (range.first != range.second) {
+                        cursors_.push_back(Cursor{range.first, range.second});
+                    }
+                }
+                SelectActive();
+            }
+
+            /*
+            * Iterator to 'position' (not end) in the range with the given index; incrementing continues with the entries of
+            * all ranges in id order. The other ranges are only searched for their continuation on the first increment.
+            */
+            BufferIterator(const std::vector<Range>& ranges, size_t index, BufferQueueType::iterator position)
+                : active_(0), seek_pending_(ranges.size() > 1), seek_id_(position->id_) {
+                for (size_t i = 0; i < ranges.size(); i++) {
+                    if (i == index) {
+                        active_ = cursors_.size();
+                        cursors_.push_back(Cursor{position, ranges[i].second});
+                    } else if (ranges[i].first != ranges[i].second) {
+                        cursors_.push_back(Cursor{ranges[i].first, ranges[i].second});
+                    }
+                }
+            }
+
+            reference operator*() const { return *cursors_[active_].current_; }
+            pointer operator->() const { return &*cursors_[active_].current_; }
+
+            BufferIterator& operator++() {
+                Cursor& cursor = cursors_[active_];
+                ++cursor.current_;
+
+                if (cursors_.size() == 1) {
+                    // single buffer
+                    if (cursor.current_ == cursor.end_) {
+                        cursors_.clear();
+                    }
+                    return *this;
+                }
+
+                if (seek_pending_) {
+                    // continuation of a Find(): skip the entries in front of the found one
+                    seek_pending_ = false;
+                    for (size_t i = 0; i < cursors_.size(); i++) {
+                        if (i == active_) continue;
+                        while (cursors_[i].current_ != cursors_[i].end_ && cursors_[i].current_->id_ < seek_id_) {
+                            ++cursors_[i].current_;
+                        }
+                    }
+                }
+                SelectActive();
+                return *this;
+            }
+            BufferIterator operator++(int) { BufferIterator it = *this; ++*this; return it; }
+
+            // O(n)
+            BufferIterator operator+(difference_type n) const {
+                BufferIterator it = *this;
+                while (n-- > 0) ++it;
+                return it;
+            }
+
+            bool operator==(const BufferIterator& other) const {
+                if (cursors_.empty() || other.cursors_.empty()) {
+                    return cursors_.empty() && other.cursors_.empty();
+                }
+                return &**this == &*other;
+            }
+            bool operator!=(const BufferIterator& other) const { return !(*this == other); }
+
+        private:
+            struct Cursor {
+                BufferQueueType::iterator current_;
+                BufferQueueType::iterator end_;
+            };
+
+            // points active_ to the cursor with the smallest id; drops exhausted cursors, no cursor left means end
+            void SelectActive() {
+                size_t count = 0;
+                for (size_t i = 0; i < cursors_.size(); i++) {
+                    if (cursors_[i].current_ != cursors_[i].end_) {
+                        cursors_[count++] = cursors_[i];
+                    }
+                }
+                cursors_.resize(count);
+
+                active_ = 0;
+                for (size_t i = 1; i < cursors_.size(); i++) {
+                    if (cursors_[i].current_->id_ < cursors_[active_].current_->id_) {
+                        active_ = i;
+                    }
+                }
+            }
+
+            boost::container::small_vector<Cursor, 4> cursors_;   // one per buffer that has entries left
+            size_t active_;                                       // cursor of the current entry
+            bool seek_pending_;
+            int64_t seek_id_;
+        };
+    } // namespace core
+} // namespace qds_buffer
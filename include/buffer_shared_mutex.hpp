@@ -0,0 +1,73 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/thread.hpp>
+
+namespace qds_buffer {
+
+    namespace core {
+
+        /*
+        * Mutex of the buffers (shards) of a data source
+        *
+        * Satisfies the Lockable and SharedLockable requirements, so it can be used with boost::shared_lock, std::shared_lock
+        * and boost::unique_lock. Locking locks the mutexes of all buffers, always in the same order.
+        * Thread-Safe
+        */
+        class BufferSharedMutex {
+        public:
+            explicit BufferSharedMutex(std::vector<boost::shared_mutex*> mutexes) : mutexes_(mutexes) {}
+
+            BufferSharedMutex(const BufferSharedMutex&) = delete;
+            BufferSharedMutex& operator=(const BufferSharedMutex&) = delete;
+
+            void lock() {
+                for (auto mutex : mutexes_) mutex->lock();
+            }
+            bool try_lock() {
+                for (size_t i = 0; i < mutexes_.size(); i++) {
+                    if (!mutexes_[i]->try_lock()) {
+                        while (i-- > 0) mutexes_[i]->unlock();
+                        return false;
+                    }
+                }
+                return true;
+            }
+            void unlock() {
+                for (size_t i = mutexes_.size(); i-- > 0;) mutexes_[i]->unlock();
+            }
+
+            void lock_shared() {
+                for (auto mutex : mutexes_) mutex->lock_shared();
+            }
+            bool try_lock_shared() {
+                for (size_t i = 0; i < mutexes_.size(); i++) {
+                    if (!mutexes_[i]->try_lock_shared()) {
+                        while (i-- > 0) mutexes_[i]->unlock_shared();
+                        return false;
+                    }
+                }
+                return true;
+            }
+            void unlock_shared() {
+                for (size_t i = mutexes_.size(); i-- > 0;) mutexes_[i]->unlock_shared();
+            }
+
+            /*
+            * @returns the mutexes of the single buffers in locking order
+            */
+            const std::vector<boost::shared_mutex*>& GetMutexes() const {
+                return mutexes_;
+            }
+
+        private:
+            const std::vector<boost::shared_mutex*> mutexes_;
+        };
+    } // namespace core
+} // namespace qds_buffer
@@ -0,0 +1,135 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "types.hpp"
+
+namespace qds_buffer {
+
+    namespace core {
+
+        /*
+        * Immutable buffer entries at a point in time (see IDataSourceOut::GetSnapshot)
+        *
+        * The entries are stored as ranges of chunks. A buffer publishes a new snapshot on every modification that refers to
+        * the unchanged chunks of the previous one, so neither publishing nor reading a snapshot copies the whole buffer.
+        * Iterating is O(1) per entry, operator[] is O(log c) with c chunks.
+        * Thread-Safe
+        */
+        class SnapshotView {
+        public:
+            /*
+            * Entries of a chunk; the ones within a range of a published snapshot are never modified
+            */
+            using Chunk = std::vector<BufferEntry>;
+
+            /*
+            * Entries [begin_, end_) of a chunk, never empty
+            */
+            struct Range {
+                std::shared_ptr<const Chunk> chunk_;
+                size_t begin_;
+                size_t end_;
+            };
+
+            class const_iterator {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = BufferEntry;
+                using difference_type = std::ptrdiff_t;
+                using pointer = const BufferEntry*;
+                using reference = const BufferEntry&;
+
+                const_iterator() : ranges_(nullptr), range_(0), position_(0) {}
+
+                const_iterator(const std::vector<Range>* ranges, size_t range) : ranges_(ranges), range_(range), position_(0) {
+                    if (range_ < ranges_->size()) {
+                        position_ = (*ranges_)[range_].begin_;
+                    }
+                }
+
+                reference operator*() const { return (*(*ranges_)[range_].chunk_)[position_]; }
+                pointer operator->() const { return &**this; }
+
+                const_iterator& operator++() {
+                    if (++position_ == (*ranges_)[range_].end_) {
+                        *this = const_iterator(ranges_, range_ + 1);
+                    }
+                    return *this;
+                }
+
+                const_iterator operator++(int) {
+                    const_iterator previous = *this;
+                    ++*this;
+                    return previous;
+                }
+
+                bool operator==(const const_iterator& other) const { return range_ == other.range_ && position_ == other.position_; }
+                bool operator!=(const const_iterator& other) const { return !(*this == other); }
+
+            private:
+                const std::vector<Range>* ranges_;
+                size_t range_;
+                size_t position_;
+            };
+            using iterator = const_iterator;
+
+            SnapshotView() : size_(0) {}
+
+            explicit SnapshotView(std::vector<Range> ranges) : ranges_(std::move(ranges)), size_(0) {
+                offsets_.reserve(ranges_.size());
+                for (auto& range : ranges_) {
+                    offsets_.push_back(size_);
+                    size_ += range.end_ - range.begin_;
+                }
+            }
+
+            /*
+            * Snapshot of entries in a single chunk
+            */
+            explicit SnapshotView(Chunk entries) : size_(0) {
+                if (!entries.empty()) {
+                    size_t size = entries.size();
+                    ranges_.push_back(Range{std::make_shared<const Chunk>(std::move(entries)), 0, size});
+                    offsets_.push_back(0);
+                    size_ = size;
+                }
+            }
+
+            size_t size() const { return size_; }
+            bool empty() const { return size_ == 0; }
+
+            const BufferEntry& operator[](size_t index) const {
+                // last range beginning at or before index
+                size_t range = std::upper_bound(offsets_.begin(), offsets_.end(), index) - offsets_.begin() - 1;
+                return (*ranges_[range].chunk_)[ranges_[range].begin_ + index - offsets_[range]];
+            }
+
+            const BufferEntry& front() const { return (*ranges_.front().chunk_)[ranges_.front().begin_]; }
+            const BufferEntry& back() const { return (*ranges_.back().chunk_)[ranges_.back().end_ - 1]; }
+
+            const_iterator begin() const { return const_iterator(&ranges_, 0); }
+            const_iterator end() const { return const_iterator(&ranges_, ranges_.size()); }
+
+        private:
+            std::vector<Range> ranges_;
+            std::vector<size_t> offsets_;   // index of the first entry of every range
+            size_t size_;
+        };
+
+        /*
+        * Immutable, reference-counted buffer entries at a point in time (see IDataSourceOut::GetSnapshot)
+        */
+        using BufferSnapshot = std::shared_ptr<const SnapshotView>;
+
+    } // namespace core
+} // namespace qds_buffer
@@ -0,0 +1,382 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/json/string_view.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
+#include "measurement.hpp"
+#include "qds_core_export.h"            // generated by cmake 'generate_export_header' command
+
+namespace qds_buffer {
+
+    namespace core {
+
+        /*
+        * Measurement value in 16 bytes: a number, a bool or a string, tagged with its kind
+        *
+        * Strings of up to kSmallStringSize_ characters are stored inline, longer ones in a single heap block. Unlike
+        * Measurement::value_, reading a number doesn't need a variant visitor: check GetKind() and read it directly, or
+        * call Visit() with a visitor that has an operator() for every kind.
+        *
+        * Not Thread-Safe
+        */
+        class CompactValue {
+        public:
+            enum class Kind : std::uint8_t { kBlank, kInteger, kDouble, kBool, kString };
+            // argument of Visit() for a value that is not set
+            struct Blank {};
+
+            static const size_t kSmallStringSize_ = 15;
+
+            CompactValue() { SetTag(Kind::kBlank, 0); }
+            explicit CompactValue(std::int64_t value) { Store(value, Kind::kInteger); }
+            explicit CompactValue(double value) { Store(value, Kind::kDouble); }
+            explicit CompactValue(bool value) { Store(value, Kind::kBool); }
+            CompactValue(const char* data, size_t size) { StoreString(data, size); }
+            explicit CompactValue(const std::string& value) { StoreString(value.data(), value.size()); }
+            // converts Measurement::value_
+            explicit CompactValue(const boost::variant<boost::blank, std::string, std::int64_t, double, bool>& value) {
+                switch (value.which()) {
+                    case 1: {
+                        const std::string& string = boost::get<std::string>(value);
+                        StoreString(string.data(), string.size());
+                        break;
+                    }
+                    case 2: Store(boost::get<std::int64_t>(value), Kind::kInteger); break;
+                    case 3: Store(boost::get<double>(value), Kind::kDouble); break;
+                    case 4: Store(boost::get<bool>(value), Kind::kBool); break;
+                    default: SetTag(Kind::kBlank, 0);
+                }
+            }
+
+            CompactValue(const CompactValue& other) {
+                if (other.IsHeapString()) {
+                    StoreString(other.GetStringData(), other.GetStringSize());
+                } else {
+                    std::memcpy(bytes_, other.bytes_, sizeof(bytes_));
+                }
+            }
+            CompactValue(CompactValue&& other) noexcept {
+                std::memcpy(bytes_, other.bytes_, sizeof(bytes_));
+                other.SetTag(Kind::kBlank, 0);
+            }
+            ~CompactValue() { Free(); }
+
+            CompactValue& operator=(const CompactValue& other) {
+                if (this != &other) {
+                    CompactValue copy(other);
+                    *this = std::move(copy);
+                }
+                return *this;
+            }
+            CompactValue& operator=(CompactValue&& other) noexcept {
+                if (this != &other) {
+                    Free();
+                    std::memcpy(bytes_, other.bytes_, sizeof(bytes_));
+                    other.SetTag(Kind::kBlank, 0);
+                }
+                return *this;
+            }
+
+            Kind GetKind() const { return static_cast<Kind>(bytes_[kTagByte_] & kKindMask_); }
+
+            // the value must be of the kind
+            std::int64_t GetInteger() const { return Load<std::int64_t>(); }
+            double GetDouble() const { return Load<double>(); }
+            bool GetBool() const { return Load<bool>(); }
+            const char* GetStringData() const { return IsHeapString() ? HeapBlock() + sizeof(std::uint64_t) : bytes_; }
+            size_t GetStringSize() const {
+                if (!IsHeapString()) return static_cast<std::uint8_t>(bytes_[kTagByte_]) >> kKindBits_;
+                std::uint64_t size;
+                std::memcpy(&size, HeapBlock(), sizeof(size));
+                return static_cast<size_t>(size);
+            }
+            boost::json::string_view GetString() const { return boost::json::string_view(GetStringData(), GetStringSize()); }
+
+            /*
+            * Calls visitor(Blank), visitor(std::int64_t), visitor(double), visitor(bool) or
+            * visitor(boost::json::string_view) depending on the kind
+            */
+            template <typename Visitor>
+            void Visit(Visitor&& visitor) const {
+                switch (GetKind()) {
+                    case Kind::kInteger: visitor(GetInteger()); break;
+                    case Kind::kDouble: visitor(GetDouble()); break;
+                    case Kind::kBool: visitor(GetBool()); break;
+                    case Kind::kString: visitor(GetString()); break;
+                    default: visitor(Blank());
+                }
+            }
+
+            /*
+            * Converts to Measurement::value_
+            */
+            boost::variant<boost::blank, std::string, std::int64_t, double, bool> ToVariant() const {
+                switch (GetKind()) {
+                    case Kind::kInteger: return GetInteger();
+                    case Kind::kDouble: return GetDouble();
+                    case Kind::kBool: return GetBool();
+                    case Kind::kString: return std::string(GetStringData(), GetStringSize());
+                    default: return boost::blank();
+                }
+            }
+
+            /*
+            * Converts the value to string like Measurement::ValueToString
+            */
+            std::string ToString() const {
+                switch (GetKind()) {
+                    case Kind::kInteger: return std::to_string(GetInteger());
+                    case Kind::kDouble: return std::to_string(GetDouble());
+                    case Kind::kBool: return GetBool() ? "true" : "false";
+                    case Kind::kString: return std::string(GetStringData(), GetStringSize());
+                    default: return "";
+                }
+            }
+
+            // heap memory of the value in bytes
+            size_t HeapSize() const { return IsHeapString() ? sizeof(std::uint64_t) + GetStringSize() : 0; }
+
+        private:
+            // the last byte holds the kind (low bits) and the size of an inline string (high bits)
+            static const size_t kTagByte_ = 15;
+            static const int kKindBits_ = 3;
+            static const std::uint8_t kKindMask_ = (1 << kKindBits_) - 1;
+            // size bits of a string stored in a heap block (prefixed by its size)
+            static const std::uint8_t kHeapString_ = 0xF8;
+
+            template <typename T>
+            void Store(T value, Kind kind) {
+                std::memcpy(bytes_, &value, sizeof(value));
+                SetTag(kind, 0);
+            }
+
+            template <typename T>
+            T Load() const {
+                T value;
+                std::memcpy(&value, bytes_, sizeof(value));
+                return value;
+            }
+
+            void StoreString(const char* data, size_t size) {
+                if (size <= kSmallStringSize_) {
+                    std::memcpy(bytes_, data, size);
+                    SetTag(Kind::kString, static_cast<std::uint8_t>(size));
+                    return;
+                }
+
+                char* block = new char[sizeof(std::uint64_t) + size];
+                std::uint64_t block_size = size;
+                std::memcpy(block, &block_size, sizeof(block_size));
+                std::memcpy(block + sizeof(block_size), data, size);
+                std::memcpy(bytes_, &block, sizeof(block));
+                bytes_[kTagByte_] = static_cast<char>(kHeapString_ | static_cast<std::uint8_t>(Kind::kString));
+            }
+
+            void SetTag(Kind kind, std::uint8_t string_size) {
+                bytes_[kTagByte_] = static_cast<char>((string_size << kKindBits_) | static_cast<std::uint8_t>(kind));
+            }
+
+            bool IsHeapString() const {
+                return (static_cast<std::uint8_t>(bytes_[kTagByte_]) & ~kKindMask_) == kHeapString_ && GetKind() == Kind::kString;
+            }
+
+            const char* HeapBlock() const { return Load<const char*>(); }
+
+            void Free() {
+                if (IsHeapString()) delete[] HeapBlock();
+            }
+
+            alignas(8) char bytes_[16];
+        };
+
+        static_assert(sizeof(CompactValue) == 16, "CompactValue must stay 16 bytes");
+
+        /*
+        * Names, types and units of the measurements of a data set, shared by all data sets with the same layout
+        *
+        * Thread-Safe (immutable)
+        */
+        struct MeasurementSchema {
+            struct Field {
+                InternedString name_;
+                MeasurementType type_;
+                InternedString unit_;
+            };
+            std::vector<Field> fields_;
+
+            /*
+            * @returns the schema of the measurements; data sets with the same names, types and units get the same schema as
+            *          long as it is in use (see SchemaTable)
+            */
+            static std::shared_ptr<const MeasurementSchema> Get(const std::vector<Measurement>& measurements);
+        };
+
+        /*
+        * Process-wide table of the schemas in use, keyed by the interned names and units
+        *
+        * Only references the schemas, so a schema is freed when the last data set using it is gone. Schemas with names or
+        * units that are not interned, and new schemas while the table holds kMaxSize_ of them, are not shared. Instance() is
+        * defined in the library like StringInternTable::Instance(), so the data source and its users share one table.
+        *
+        * Thread-Safe
+        */
+        class SchemaTable {
+        public:
+            static const size_t kMaxSize_ = 4096;
+
+            static QDS_CORE_EXPORT SchemaTable& Instance();
+
+            std::shared_ptr<const MeasurementSchema> Get(const std::vector<Measurement>& measurements) {
+                bool shareable = true;
+                for (auto& measurement : measurements) {
+                    shareable = shareable && measurement.name_.IsInterned() && measurement.unit_.IsInterned();
+                }
+                if (!shareable) return Create(measurements);
+
+                // interned strings are equal if they are the same, so their addresses identify the layout
+                static thread_local std::string key;
+                key.clear();
+                for (auto& measurement : measurements) {
+                    const std::string* name = &measurement.name_.str();
+                    const std::string* unit = &measurement.unit_.str();
+                    key.append(reinterpret_cast<const char*>(&name), sizeof(name));
+                    key.append(reinterpret_cast<const char*>(&unit), sizeof(unit));
+                    key.push_back(static_cast<char>(measurement.type_));
+                }
+
+                {
+                    boost::shared_lock<boost::shared_mutex> lock(mutex_);
+                    auto it = schemas_.find(key);
+                    if (it != schemas_.end()) {
+                        if (auto schema = it->second.lock()) return schema;
+                    }
+                }
+
+                boost::unique_lock<boost::shared_mutex> lock(mutex_);
+                auto it = schemas_.find(key);
+                if (it != schemas_.end()) {
+                    if (auto schema = it->second.lock()) return schema;
+                    schemas_.erase(it);
+                }
+                auto schema = Create(measurements);
+                if (schemas_.size() >= kMaxSize_) {
+                    // make room by dropping the schemas that are no longer in use
+                    for (auto expired = schemas_.begin(); expired != schemas_.end();) {
+                        expired = expired->second.expired() ? schemas_.erase(expired) : std::next(expired);
+                    }
+                }
+                if (schemas_.size() < kMaxSize_) {
+                    schemas_.emplace(key, schema);
+                }
+                return schema;
+            }
+
+            size_t GetSize() const {
+                boost::shared_lock<boost::shared_mutex> lock(mutex_);
+                return schemas_.size();
+            }
+
+        private:
+            SchemaTable() = default;
+            SchemaTable(const SchemaTable&) = delete;
+            SchemaTable& operator=(const SchemaTable&) = delete;
+
+            static std::shared_ptr<const MeasurementSchema> Create(const std::vector<Measurement>& measurements) {
+                auto schema = std::make_shared<MeasurementSchema>();
+                schema->fields_.reserve(measurements.size());
+                for (auto& measurement : measurements) {
+                    schema->fields_.push_back(MeasurementSchema::Field{measurement.name_, measurement.type_, measurement.unit_});
+                }
+                return schema;
+            }
+
+            mutable boost::shared_mutex mutex_;
+            std::unordered_map<std::string, std::weak_ptr<const MeasurementSchema>> schemas_;
+        };
+
+        inline std::shared_ptr<const MeasurementSchema> MeasurementSchema::Get(const std::vector<Measurement>& measurements) {
+            return SchemaTable::Instance().Get(measurements);
+        }
+
+        /*
+        * Compact representation of a set of measurements: the values are stored contiguously, 16 bytes each, the names,
+        * types and units in a shared schema. Meant for consumers scanning many values; converts from and to the
+        * measurements used by the data source interfaces. A data source created with compact_data_sets builds it once when
+        * a data set is added and hands it out with the entry (see BufferEntry::compact_).
+        *
+        * Not Thread-Safe
+        */
+        class CompactDataSet {
+        public:
+            CompactDataSet() : schema_(std::make_shared<MeasurementSchema>()) {}
+            explicit CompactDataSet(const std::vector<Measurement>& measurements) : schema_(MeasurementSchema::Get(measurements)) {
+                values_.reserve(measurements.size());
+                for (auto& measurement : measurements) {
+                    values_.emplace_back(measurement.value_);
+                }
+            }
+
+            std::vector<Measurement> ToMeasurements() const {
+                std::vector<Measurement> measurements(values_.size());
+                for (size_t i = 0; i < values_.size(); i++) {
+                    const MeasurementSchema::Field& field = schema_->fields_[i];
+                    measurements[i].name_ = field.name_;
+                    measurements[i].type_ = field.type_;
+                    measurements[i].unit_ = field.unit_;
+                    measurements[i].value_ = values_[i].ToVariant();
+                }
+                return measurements;
+            }
+
+            size_t size() const { return values_.size(); }
+            bool empty() const { return values_.empty(); }
+
+            const InternedString& GetName(size_t i) const { return schema_->fields_[i].name_; }
+            MeasurementType GetType(size_t i) const { return schema_->fields_[i].type_; }
+            const InternedString& GetUnit(size_t i) const { return schema_->fields_[i].unit_; }
+            const CompactValue& GetValue(size_t i) const { return values_[i]; }
+            // all values in measurement order, e.g. for scans
+            const std::vector<CompactValue>& GetValues() const { return values_; }
+            const std::shared_ptr<const MeasurementSchema>& GetSchema() const { return schema_; }
+
+            /*
+            * @returns position of the first measurement with the given name or size(); O(n)
+            */
+            size_t Find(const std::string& name) const {
+                for (size_t i = 0; i < values_.size(); i++) {
+                    if (schema_->fields_[i].name_ == name) return i;
+                }
+                return values_.size();
+            }
+
+            /*
+            * Approximates the memory used by the data set in bytes; the shared schema is not counted
+            */
+            size_t ByteSize() const {
+                size_t size = sizeof(*this) + values_.capacity() * sizeof(CompactValue);
+                for (auto& value : values_) {
+                    size += value.HeapSize();
+                }
+                return size;
+            }
+
+        private:
+            std::shared_ptr<const MeasurementSchema> schema_;
+            std::vector<CompactValue> values_;
+        };
+    } // namespace core
+} // namespace qds_buffer
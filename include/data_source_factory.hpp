@@ -31,11 +31,30 @@ namespace qds_buffer {
                 * @param reset_information_size: Size of the reset information list
                 * @param deletion_information_size: Size of the deletion information list
                 * @param enable_memory_info_logging: Enable memory info logging after each Add operation
+                * @param staging_queue_size: Size of the lock-free staging queue (0 = disabled); if enabled, Add() only parses and
+                *                            queues the data set and a publisher thread stores it in the buffer in batches, so
+                *                            producers never wait for the buffer lock. Errors that occur when storing (e.g. bad ID,
+                *                            buffer overflow not allowed) are not reported to the producer then, Add() returns 0.
+                * @param shard_count: Number of shards (1 = not sharded); the data sets are partitioned by ID across several buffers
+                *                     with separate locks. The buffer size is split evenly across the shards, iterate via
+                *                     IDataSourceOut::MergedBegin().
+                * @param max_age_ms: Maximum age of the data sets in milliseconds (0 = unlimited); a background thread deletes older
+                *                    unlocked data sets and reports them like an overflow (see IDataSourceOut::IsOverflown)
+                * @param eviction_policy: Data sets discarded first on an overflow: the oldest, the largest (measurements and
+                *                        referenced contents) or the ones with the lowest priority (see IDataSourceIn::SetPriority)
+                * @param max_bytes: Maximum memory used by the data sets including their references in bytes (0 = unlimited);
+                *                   exceeding it overflows the buffer like exceeding buffer_size. Split evenly across shards.
+                * @param compact_data_sets: Also store every data set in compact form (see compact_measurement.hpp), built once
+                *                           when it is added and handed out with it (BufferEntry::compact_,
+                *                           DataSetHandle::compact_); costs the conversion per added data set and counts
+                *                           towards max_bytes, saves converting on every read
                 */
                 static std::shared_ptr<IDataSourceInOut> CreateDataSource(
                         size_t buffer_size = 100, int8_t counter_mode = 0, bool allow_overflow = true,
                         size_t reset_information_size = 100, size_t deletion_information_size = 100,
-                        bool enable_memory_info_logging = false);
+                        bool enable_memory_info_logging = false, size_t staging_queue_size = 0, size_t shard_count = 1,
+                        uint32_t max_age_ms = 0, EvictionPolicy eviction_policy = EvictionPolicy::OLDEST,
+                        size_t max_bytes = 0, bool compact_data_sets = false);
                 };
         }
 } // namespace
@@ -4,6 +4,11 @@
 
 #pragma once
 
+#include <cstdint>
+#include <exception>
+#include <utility>
+#include <vector>
+
 #include <boost/json/string_view.hpp>
 #include "types.hpp"
 
@@ -11,6 +16,20 @@ namespace qds_buffer {
     
     namespace core {
 
+        /*
+        * Batch of QDS data sets (ID and JSON representation), see IDataSourceIn::AddBatch
+        */
+        using DataSetBatch = std::vector<std::pair<int64_t, boost::json::string_view>>;
+
+        /*
+        * Result of adding a single data set of a batch (see IDataSourceIn::AddBatch)
+        */
+        struct AddResult {
+            int deletion_count_;            // number of deleted data or -1 (see IDataSourceIn::Add); -1 if the data set was rejected
+            std::string error_;             // empty on success, otherwise the message of the exception Add would have thrown
+            std::exception_ptr exception_;  // null on success, otherwise the exception Add would have thrown (can be rethrown)
+        };
+
         /*
         * Interface exposes the input methods of a DataSource object
         */
@@ -44,6 +63,61 @@ namespace qds_buffer {
             //virtual bool Add(int64_t id, std::string_view json) = 0;
             virtual int Add(int64_t id, boost::json::string_view json) = 0;
 
+            /*
+            * Adds new QDS data to the buffer without a JSON round trip.
+            *
+            * The measurements are validated with the same rules as JSON input (NAME, TYPE and VALUE are required,
+            * VALUE has to match TYPE, INTEGER/FLOAT ranges and WORD/TIMESTAMP formats are checked) and are moved
+            * into the buffer without copying.
+            *
+            * @param id: ID (counter) of the QDS data set
+            * @param measurements: QDS data (set of measurements); the values have to be stored in the matching
+            *                      variant type (STRING/WORD/TIMESTAMP/REF/FOREIGN_KEY: std::string,
+            *                      INTEGER/LONG: std::int64_t, FLOAT/DOUBLE: double, BOOL: bool)
+            *
+            * @returns number of deleted data
+            *          or -1
+            *
+            * @throws ParsingException, RefException, RingBufferException RingBufferOverflowException
+            */
+            virtual int Add(int64_t id, std::vector<Measurement>&& measurements) = 0;
+
+            /*
+            * Adds new QDS data in the compact binary format (see binary_encoder.hpp) to the buffer.
+            *
+            * The decoded measurements are validated with the same rules as JSON input.
+            *
+            * @param id: ID (counter) of the QDS data set
+            * @param bytes: binary encoded QDS data (set of measurements), e.g. created with BinaryEncoder
+            *
+            * @returns number of deleted data
+            *          or -1
+            *
+            * @throws ParsingException, RefException, RingBufferException RingBufferOverflowException
+            */
+            virtual int AddBinary(int64_t id, const std::vector<std::uint8_t>& bytes) = 0;
+
+            /*
+            * Adds a batch of QDS data sets to the buffer.
+            *
+            * All data sets are parsed first (in parallel for large batches), afterwards they are stored in the given order
+            * under a single buffer lock. Behaves like calling Add() for each data set, but does not throw on invalid data sets:
+            * the outcome of each data set is reported in the result at the same position.
+            *
+            * @param data_sets: IDs and JSON representations of the QDS data sets (see Add)
+            *
+            * @returns one result per data set, in the order of data_sets
+            */
+            virtual std::vector<AddResult> AddBatch(const DataSetBatch& data_sets) = 0;
+
+            /*
+            * Waits until all data sets added before the call are stored in the buffer.
+            *
+            * Only relevant with a staging queue (see DataSourceFactory::CreateDataSource): Add() then returns as soon as the
+            * data set is queued, and a publisher thread stores it in the buffer. Without staging queue this returns immediately.
+            */
+            virtual void Flush() = 0;
+
             /*
             * Stores a new reference (REF data type)
             *
@@ -55,6 +129,18 @@ namespace qds_buffer {
             */
             virtual void SetReference(const std::string& ref, const std::string& data, const std::string& data_format) = 0;
 
+            /*
+            * Sets the priority of a stored data set (default 0). With the eviction policy PRIORITY (see
+            * DataSourceFactory::CreateDataSource), data sets with a lower priority are discarded first on an overflow; no
+            * effect with the other policies. With a staging queue, call Flush() first to make sure the data set is stored.
+            *
+            * @param id: ID (counter) of the QDS data set
+            * @param priority: the priority
+            *
+            * @returns false if there is no data set with the given ID
+            */
+            virtual bool SetPriority(int64_t id, int32_t priority) = 0;
+
             /*
             * Completely resets the buffer (deletes all data)
             *
@@ -27,6 +27,17 @@ namespace qds_buffer {
             virtual size_t GetDeletionInformationSize() const = 0;
             virtual size_t GetResetInformationSize() const = 0;
             virtual bool GetEnableMemoryInfoLogging() const = 0;
+            virtual size_t GetStagingQueueSize() const = 0;
+            virtual size_t GetShardCount() const = 0;
+            virtual uint32_t GetMaxAgeMs() const = 0;
+            virtual EvictionPolicy GetEvictionPolicy() const = 0;
+            virtual size_t GetMaxBytes() const = 0;
+            // true if the data sets are handed out in compact form as well (see BufferEntry::compact_)
+            virtual bool GetCompactDataSets() const = 0;
+            /*
+            * @returns memory used by the stored data sets and their references in bytes (see BufferEntry::bytes_)
+            */
+            virtual size_t GetMemoryUsage() const = 0;
         };
     }
 } // namespace
@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include "buffer_iterator.hpp"
+#include "buffer_shared_mutex.hpp"
+#include "buffer_snapshot.hpp"
 #include "types.hpp"
 
 #include <boost/thread.hpp>
@@ -37,6 +40,24 @@ namespace qds_buffer {
             * @throws RingBufferException
             */
             virtual void Delete(int64_t id) = 0;
+            /*
+            * Deletes several QDS data sets with a single lock acquisition, e.g. to acknowledge a batch of processed data sets
+            *
+            * @param ids: IDs (counter) of the QDS data sets to delete; unknown IDs are ignored
+            *
+            * @returns number of deleted data sets
+            */
+            virtual size_t Delete(const std::vector<int64_t>& ids) = 0;
+            /*
+            * Deletes all QDS data sets up to and including the given ID with a single lock acquisition (counter mode 0 only)
+            *
+            * @param id: ID (counter) of the newest QDS data set to delete
+            *
+            * @returns number of deleted data sets
+            *
+            * @throws RingBufferException in counter mode 1
+            */
+            virtual size_t DeleteUpTo(int64_t id) = 0;
 
             /**
              * Check if a reset has happened since the last call to AcknowledgeReset()
@@ -50,7 +71,8 @@ namespace qds_buffer {
             virtual ResetInformationList AcknowledgeReset() = 0;
 
             /**
-             * Check if an overflow has happened since the last call to AcknowledgeOverflow()
+             * Check if an overflow has happened since the last call to AcknowledgeOverflow(); data sets deleted because they
+             * exceeded the maximum age (see DataSourceFactory::CreateDataSource) are reported the same way
              */
             virtual bool IsOverflown() const = 0;
 
@@ -62,25 +84,178 @@ namespace qds_buffer {
 
             /*
             * @returns buffer mutex; use in combination with begin() and end() when iterating through the buffer
+            *
+            * @throws RingBufferException for a sharded data source, which has a buffer per shard (see GetMergedSharedMutex())
             */
             virtual boost::shared_mutex& GetBufferSharedMutex() const = 0;
             /*
             * @returns iterator to the beginning of the buffer; must lock mutex via GetBufferSharedMutex() before iterating
+            *
+            * @throws RingBufferException for a sharded data source (see MergedBegin())
             */
             virtual BufferQueueType::iterator begin() = 0;
             /*
             * @returns iterator to the end of the buffer; must lock mutex via GetBufferSharedMutex() before iterating
+            *
+            * @throws RingBufferException for a sharded data source (see MergedEnd())
             */
             virtual BufferQueueType::iterator end() = 0;
+            /*
+            * Looks up a single QDS data set without iterating through the buffer (constant time)
+            *
+            * @param id: ID (counter) of the QDS data set
+            *
+            * @returns iterator to the entry or end() if there is no entry with the given id;
+            *          must lock mutex via GetBufferSharedMutex() before calling Find() and while using the iterator
+            *
+            * @throws RingBufferException for a sharded data source (see MergedFind())
+            */
+            virtual BufferQueueType::iterator Find(int64_t id) = 0;
+            /*
+            * @returns mutex of the buffers of all shards; use in combination with MergedBegin() and MergedEnd() when iterating
+            *          through a data source that may be sharded (see DataSourceFactory::CreateDataSource)
+            */
+            virtual BufferSharedMutex& GetMergedSharedMutex() const = 0;
+            /*
+            * @returns forward iterator to the beginning of the buffers of all shards, merged by id; must lock mutex via
+            *          GetMergedSharedMutex() before iterating. Iterates in buffer order if the data source is not sharded.
+            */
+            virtual BufferIterator MergedBegin() = 0;
+            /*
+            * @returns iterator to the end of the buffers of all shards; must lock mutex via GetMergedSharedMutex() before iterating
+            */
+            virtual BufferIterator MergedEnd() = 0;
+            /*
+            * Like Find(), for a data source that may be sharded
+            *
+            * @param id: ID (counter) of the QDS data set
+            *
+            * @returns iterator to the entry, which continues in id order, or MergedEnd() if there is no entry with the given
+            *          id; must lock mutex via GetMergedSharedMutex() before calling MergedFind() and while using the iterator
+            */
+            virtual BufferIterator MergedFind(int64_t id) = 0;
+            /*
+            * Returns the current entries as an immutable snapshot, which can be iterated without locking the buffer mutex.
+            * The first call copies the buffer under its lock; from then on, adding and deleting data publishes a new snapshot
+            * that shares the unchanged chunks of entries with the previous one (O(1) amortized per added entry), so this
+            * doesn't lock or copy the buffer and never waits for readers of a snapshot. The snapshot keeps its entries (and
+            * their measurements) alive until it is released; the measurements of a deleted entry may stay alive as long as the
+            * other entries of its chunk. A sharded data source merges the snapshots of its shards on the first call after a
+            * modification, without locking them.
+            *
+            * @returns entries in the order of begin()/end(); the lock state of an entry is the one when it was added (or when
+            *          the buffer was copied)
+            */
+            virtual BufferSnapshot GetSnapshot() = 0;
+            /*
+            * Returns the QDS data sets added after a known one, e.g. for a consumer that reconnects. The buffer lock is only
+            * held during the call; the handles keep the measurements alive even if the data sets are deleted meanwhile.
+            *
+            * @param last_id: ID (counter) of the last QDS data set the consumer has seen (-1 = none)
+            * @param max_n: maximum number of data sets to return
+            *
+            * @returns handles of the data sets with an ID greater than last_id, ordered by ID
+            */
+            virtual std::vector<DataSetHandle> ReadSince(int64_t last_id, size_t max_n) = 0;
+            /*
+            * Returns the QDS data sets added within a time range, e.g. all data sets of the last 10 seconds
+            *
+            * @param from_ms: start of the range, inclusive (milliseconds since epoch, see BufferEntry::timestamp_ms_)
+            * @param to_ms: end of the range, inclusive
+            * @param max_n: maximum number of data sets to return
+            *
+            * @returns handles of the data sets, oldest first
+            */
+            virtual std::vector<DataSetHandle> ReadTimeRange(uint64_t from_ms, uint64_t to_ms, size_t max_n) = 0;
+
+            /*
+            * Claims (locks) up to max_n of the oldest unclaimed QDS data sets; concurrent consumers never claim the same data
+            * set. Claimed data sets are not deleted on a buffer overflow or replaced in counter mode 1 until they are
+            * released, deleted or their lease expires. No need to lock the buffer mutex.
+            *
+            * @param max_n: maximum number of data sets to claim
+            * @param lease_ms: lease duration (0 = no lease); data sets still claimed after lease_ms are released
+            *                  automatically, so a crashed consumer can't pin them forever
+            *
+            * @returns copies of the claimed entries, oldest first
+            */
+            virtual std::vector<BufferEntry> ClaimBatch(size_t max_n, uint32_t lease_ms = 0) = 0;
+            /*
+            * Releases (unlocks) claimed QDS data sets, e.g. if they could not be processed
+            *
+            * @param ids: IDs (counter) of the QDS data sets; unknown or unclaimed IDs are ignored
+            *
+            * @returns number of released data sets
+            */
+            virtual size_t Release(const std::vector<int64_t>& ids) = 0;
+            /*
+            * @returns number of claimed data sets that were released because their lease expired
+            */
+            virtual uint64_t GetExpiredLeaseCount() const = 0;
+            /*
+            * Blocks until new data is available instead of polling GetSize()/GetLastId(). A burst of data sets added
+            * while a consumer is busy results in a single wakeup.
+            *
+            * In counter mode 1, the IDs are not ordered: the call waits for a data set added after the one with after_id
+            * (e.g. from GetLastId()), and returns right away if there is no such data set but the buffer isn't empty. A data
+            * set that is added again with after_id right before the call is not detected.
+            *
+            * @param after_id: ID (counter) of the last data set the consumer knows of (-1 = none)
+            * @param timeout_ms: maximum time to wait
+            *
+            * @returns true if a data set with an ID greater than after_id (counter mode 0) or added after the one with
+            *          after_id (counter mode 1) was added or the data source was reset, false on timeout
+            */
+            virtual bool WaitForNewData(int64_t after_id, uint32_t timeout_ms) = 0;
+
+            /*
+            * Registers a named consumer group. Every group reads all QDS data sets with its own cursor, independent of the
+            * other groups (e.g. an OPC-UA server and a REST exporter). A new group starts at the oldest data set; no effect
+            * if the group already exists.
+            *
+            * @param group: name of the consumer group
+            */
+            virtual void RegisterConsumerGroup(const std::string& group) = 0;
+            /*
+            * Removes a consumer group; data sets that all remaining groups acknowledged are deleted
+            *
+            * @param group: name of the consumer group
+            */
+            virtual void UnregisterConsumerGroup(const std::string& group) = 0;
+            /*
+            * Reads the next QDS data sets behind the cursor of the group and moves the cursor behind them. Reading does not
+            * lock the data sets, an overflow still discards the oldest unlocked data sets. No need to lock the buffer mutex.
+            *
+            * @param group: name of the consumer group
+            * @param max_n: maximum number of data sets to read
+            *
+            * @returns copies of the entries, oldest first
+            *
+            * @throws RingBufferException if the group is not registered
+            */
+            virtual std::vector<BufferEntry> ReadGroup(const std::string& group, size_t max_n) = 0;
+            /*
+            * Acknowledges processed QDS data sets for a group. A data set is deleted as soon as all registered groups
+            * acknowledged it; use this instead of Delete() when working with consumer groups.
+            *
+            * @param group: name of the consumer group
+            * @param ids: IDs (counter) of the QDS data sets; unknown or already acknowledged IDs are ignored
+            *
+            * @returns number of acknowledged data sets
+            *
+            * @throws RingBufferException if the group is not registered
+            */
+            virtual size_t AcknowledgeGroup(const std::string& group, const std::vector<int64_t>& ids) = 0;
 
             /*
             * @param ref: reference name
             *
-            * @returns a reference data object (REF data type)
+            * @returns the reference data object (REF data type), shared with the data source rather than copied; it stays
+            *          valid and unchanged if the reference is deleted or moved meanwhile
             *
             * @throws RefException
             */
-            virtual const ReferenceData& GetReference(const std::string& ref) const = 0;
+            virtual std::shared_ptr<const ReferenceData> GetReference(const std::string& ref) const = 0;
 
 
             ////////////////////////////////// shared methods //////////////////////////////////
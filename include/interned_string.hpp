@@ -0,0 +1,213 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <unordered_set>
+
+#include <boost/thread/locks.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
+#include "qds_core_export.h"            // generated by cmake 'generate_export_header' command
+
+namespace qds_buffer {
+
+    namespace core {
+
+        /*
+        * Process-wide table of strings that are stored once and never freed (e.g. measurement names and units)
+        *
+        * The table is split into stripes by hash, each with its own lock; lookups of existing strings only take the shared
+        * lock of one stripe and don't allocate. Since the strings are never freed, the table stops growing once its strings
+        * take kMaxBytes_, so producers sending ever new (or ever longer) names can't exhaust the memory.
+        *
+        * Instance() is defined in the library, so a shared library and the executable using it share one table and interned
+        * strings can be compared by address.
+        *
+        * Thread-Safe
+        */
+        class StringInternTable {
+        public:
+            static const size_t kMaxBytes_ = 4 * 1024 * 1024;
+
+            static QDS_CORE_EXPORT StringInternTable& Instance();
+
+            /*
+            * @returns the stored string equal to the given one, which stays valid until the end of the process;
+            *          nullptr if the string is not stored yet and the table is full
+            */
+            const std::string* Intern(const char* data, size_t len) {
+                // reused per thread, so looking up doesn't allocate
+                static thread_local std::string key;
+                key.assign(data, len);
+
+                Stripe& stripe = stripes_[std::hash<std::string>()(key) % kStripes_];
+                {
+                    boost::shared_lock<boost::shared_mutex> lock(stripe.mutex_);
+                    auto it = stripe.strings_.find(key);
+                    if (it != stripe.strings_.end()) return &*it;
+                }
+
+                boost::unique_lock<boost::shared_mutex> lock(stripe.mutex_);
+                auto it = stripe.strings_.find(key);
+                if (it != stripe.strings_.end()) return &*it;
+                size_t bytes = GetBytes(key);
+                if (stripe.bytes_ + bytes > kMaxBytes_ / kStripes_) return nullptr;
+
+                // the elements of an unordered_set don't move on rehash
+                stripe.bytes_ += bytes;
+                return &*stripe.strings_.insert(key).first;
+            }
+
+            size_t GetSize() const {
+                size_t size = 0;
+                for (auto& stripe : stripes_) {
+                    boost::shared_lock<boost::shared_mutex> lock(stripe.mutex_);
+                    size += stripe.strings_.size();
+                }
+                return size;
+            }
+
+            // memory taken by the strings, see kMaxBytes_
+            size_t GetBytes() const {
+                size_t bytes = 0;
+                for (auto& stripe : stripes_) {
+                    boost::shared_lock<boost::shared_mutex> lock(stripe.mutex_);
+                    bytes += stripe.bytes_;
+                }
+                return bytes;
+            }
+
+        private:
+            static const size_t kStripes_ = 16;
+
+            struct Stripe {
+                Stripe() : bytes_(0) {}
+
+                mutable boost::shared_mutex mutex_;
+                std::unordered_set<std::string> strings_;
+                size_t bytes_;
+            };
+
+            // the string, its characters and the hash node holding it
+            static size_t GetBytes(const std::string& value) {
+                return sizeof(std::string) + 2 * sizeof(void*) + value.size() + 1;
+            }
+
+            StringInternTable() = default;
+            StringInternTable(const StringInternTable&) = delete;
+            StringInternTable& operator=(const StringInternTable&) = delete;
+
+            Stripe stripes_[kStripes_];
+        };
+
+        /*
+        * Compact handle of an immutable string that is stored once in the StringInternTable
+        *
+        * Behaves like a const std::string (implicit conversion, comparison, concatenation), copies only copy the handle.
+        * If the table is full, the handle owns a private copy of the string instead.
+        *
+        * Not Thread-Safe (like std::string; the table is)
+        */
+        class InternedString {
+        public:
+            InternedString() : value_(&Empty()), owned_(false) {}
+            InternedString(const std::string& value) : InternedString() { assign(value.data(), value.size()); }
+            InternedString(const char* value) : InternedString() { assign(value, std::strlen(value)); }
+            InternedString(const InternedString& other)
+                : value_(other.owned_ ? new std::string(*other.value_) : other.value_), owned_(other.owned_) {}
+            InternedString(InternedString&& other) noexcept : value_(other.value_), owned_(other.owned_) {
+                other.value_ = &Empty();
+                other.owned_ = false;
+            }
+            ~InternedString() { Free(); }
+
+            InternedString& operator=(const InternedString& other) {
+                if (this != &other) {
+                    Free();
+                    value_ = other.owned_ ? new std::string(*other.value_) : other.value_;
+                    owned_ = other.owned_;
+                }
+                return *this;
+            }
+            InternedString& operator=(InternedString&& other) noexcept {
+                if (this != &other) {
+                    Free();
+                    value_ = other.value_;
+                    owned_ = other.owned_;
+                    other.value_ = &Empty();
+                    other.owned_ = false;
+                }
+                return *this;
+            }
+            InternedString& operator=(const std::string& value) { return assign(value.data(), value.size()); }
+            InternedString& operator=(const char* value) { return assign(value, std::strlen(value)); }
+
+            InternedString& assign(const char* data, size_t len) {
+                Free();
+                if (len == 0) {
+                    value_ = &Empty();
+                    owned_ = false;
+                    return *this;
+                }
+
+                value_ = StringInternTable::Instance().Intern(data, len);
+                owned_ = value_ == nullptr;
+                if (owned_) {
+                    value_ = new std::string(data, len);
+                }
+                return *this;
+            }
+
+            operator const std::string&() const { return *value_; }
+            const std::string& str() const { return *value_; }
+            const char* c_str() const { return value_->c_str(); }
+            const char* data() const { return value_->data(); }
+            size_t size() const { return value_->size(); }
+            bool empty() const { return value_->empty(); }
+
+            // false if the handle owns a private copy (see StringInternTable::kMaxBytes_)
+            bool IsInterned() const { return !owned_; }
+
+        private:
+            static const std::string& Empty() {
+                static const std::string empty;
+                return empty;
+            }
+
+            void Free() {
+                if (owned_) delete value_;
+            }
+
+            const std::string* value_;
+            bool owned_;
+        };
+
+        inline bool operator==(const InternedString& a, const InternedString& b) {
+            // interned strings are equal if they are the same
+            return (a.IsInterned() && b.IsInterned()) ? &a.str() == &b.str() : a.str() == b.str();
+        }
+        inline bool operator==(const InternedString& a, const std::string& b) { return a.str() == b; }
+        inline bool operator==(const std::string& a, const InternedString& b) { return a == b.str(); }
+        inline bool operator==(const InternedString& a, const char* b) { return a.str() == b; }
+        inline bool operator==(const char* a, const InternedString& b) { return a == b.str(); }
+        inline bool operator!=(const InternedString& a, const InternedString& b) { return !(a == b); }
+        inline bool operator!=(const InternedString& a, const std::string& b) { return !(a == b); }
+        inline bool operator!=(const std::string& a, const InternedString& b) { return !(a == b); }
+        inline bool operator!=(const InternedString& a, const char* b) { return !(a == b); }
+        inline bool operator!=(const char* a, const InternedString& b) { return !(a == b); }
+
+        inline std::string operator+(const std::string& a, const InternedString& b) { return a + b.str(); }
+        inline std::string operator+(const InternedString& a, const std::string& b) { return a.str() + b; }
+        inline std::string operator+(const char* a, const InternedString& b) { return a + b.str(); }
+        inline std::string operator+(const InternedString& a, const char* b) { return a.str() + b; }
+
+        inline std::ostream& operator<<(std::ostream& stream, const InternedString& value) { return stream << value.str(); }
+    } // namespace core
+} // namespace qds_buffer
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstring>
 #include <map>
 #include <sstream>
 #include <string>
@@ -12,6 +13,8 @@
 #include <boost/json.hpp>
 #include <boost/variant.hpp>
 
+#include "interned_string.hpp"
+
 namespace qds_buffer { 
     
     namespace core {
@@ -37,56 +40,61 @@ namespace qds_buffer {
         * Stores a QDS measurement and offers helper methods for type conversion and serialization
         */
         struct Measurement {
-            std::string name_;                                                              // name of the measurement
+            InternedString name_;                                                           // name of the measurement
             MeasurementType type_ = MeasurementType::kNotSet;                               // type of the measurement
-            std::string unit_;                                                              // unit of the measurement
+            InternedString unit_;                                                           // unit of the measurement
             boost::variant<boost::blank, std::string, std::int64_t, double, bool> value_;   // value of the measurement
 
             /*
             * Converts measurement type to string
             */
             std::string TypeToString() const {
-                static const std::map<MeasurementType, std::string> types_map = {
-                        {MeasurementType::kString, "STRING"},
-                        {MeasurementType::kInteger, "INTEGER"},
-                        {MeasurementType::kFloat, "FLOAT"},
-                        {MeasurementType::kLong, "LONG"},
-                        {MeasurementType::kDouble, "DOUBLE"},
-                        {MeasurementType::kBool, "BOOL"},
-                        {MeasurementType::kWord, "WORD"},
-                        {MeasurementType::kTimestamp, "TIMESTAMP"},
-                        {MeasurementType::kRef, "REF"},
-                        {MeasurementType::kForeignKey, "FOREIGN_KEY"}
-                };
-                auto it = types_map.find(type_);
-                if (it == types_map.end()) {
-                    return "";
+                switch (type_) {
+                    case MeasurementType::kString: return "STRING";
+                    case MeasurementType::kInteger: return "INTEGER";
+                    case MeasurementType::kFloat: return "FLOAT";
+                    case MeasurementType::kLong: return "LONG";
+                    case MeasurementType::kDouble: return "DOUBLE";
+                    case MeasurementType::kBool: return "BOOL";
+                    case MeasurementType::kWord: return "WORD";
+                    case MeasurementType::kTimestamp: return "TIMESTAMP";
+                    case MeasurementType::kRef: return "REF";
+                    case MeasurementType::kForeignKey: return "FOREIGN_KEY";
+                    default: return "";
                 }
-                return it->second;
             }
 
             /*
             * Converts string to measurement type
             */
             void SetTypeFromString(const std::string& type) {
-                static const std::map<std::string, MeasurementType> types_map = {
-                    {"STRING", MeasurementType::kString},
-                    {"INTEGER", MeasurementType::kInteger},
-                    {"INT", MeasurementType::kInteger},
-                    {"FLOAT", MeasurementType::kFloat},
-                    {"LONG", MeasurementType::kLong},
-                    {"DOUBLE", MeasurementType::kDouble},
-                    {"BOOL", MeasurementType::kBool},
-                    {"WORD", MeasurementType::kWord},
-                    {"TIMESTAMP", MeasurementType::kTimestamp},
-                    {"REF", MeasurementType::kRef},
-                    {"FOREIGN_KEY", MeasurementType::kForeignKey}
-                };
-                auto it = types_map.find(type);
-                if (it == types_map.end()) {
-                    type_ = MeasurementType::kNotSet;
-                } else {
-                    type_ = it->second;
+                type_ = TypeFromString(type.data(), type.size());
+            }
+
+            /*
+            * Converts string to measurement type without allocating; returns kNotSet if the type name is unknown.
+            * Type names are dispatched by length and first character and then compared exactly.
+            */
+            static MeasurementType TypeFromString(const char* type, size_t len) {
+                switch (len) {
+                    case 3: {
+                        if (type[0] == 'I') return Matches(type, "INT", 3) ? MeasurementType::kInteger : MeasurementType::kNotSet;
+                        return Matches(type, "REF", 3) ? MeasurementType::kRef : MeasurementType::kNotSet;
+                    }
+                    case 4: {
+                        if (type[0] == 'L') return Matches(type, "LONG", 4) ? MeasurementType::kLong : MeasurementType::kNotSet;
+                        if (type[0] == 'B') return Matches(type, "BOOL", 4) ? MeasurementType::kBool : MeasurementType::kNotSet;
+                        return Matches(type, "WORD", 4) ? MeasurementType::kWord : MeasurementType::kNotSet;
+                    }
+                    case 5: return Matches(type, "FLOAT", 5) ? MeasurementType::kFloat : MeasurementType::kNotSet;
+                    case 6: {
+                        if (type[0] == 'S') return Matches(type, "STRING", 6) ? MeasurementType::kString : MeasurementType::kNotSet;
+                        return Matches(type, "DOUBLE", 6) ? MeasurementType::kDouble : MeasurementType::kNotSet;
+                    }
+                    case 7: return Matches(type, "INTEGER", 7) ? MeasurementType::kInteger : MeasurementType::kNotSet;
+                    case 9: return Matches(type, "TIMESTAMP", 9) ? MeasurementType::kTimestamp : MeasurementType::kNotSet;
+                    case 11: return Matches(type, "FOREIGN_KEY", 11) ? MeasurementType::kForeignKey : MeasurementType::kNotSet;
+                    default: return MeasurementType::kNotSet;
                 }
             }
 
@@ -105,10 +113,10 @@ namespace qds_buffer {
                 boost::json::array measurementArray;
                 for (auto& data : list) {
                     boost::json::object measurementObj;
-                    measurementObj["NAME"] = data.name_;
+                    measurementObj["NAME"] = data.name_.str();
                     measurementObj["TYPE"] = data.TypeToString();
                     if (!data.unit_.empty()) {
-                        measurementObj["UNIT"] = data.unit_;
+                        measurementObj["UNIT"] = data.unit_.str();
                     }
                     measurementObj["VALUE"] = data.ValueToString();
                     measurementArray.push_back(measurementObj);
@@ -116,7 +124,38 @@ namespace qds_buffer {
                 return boost::json::serialize(measurementArray);
             }
 
+            /*
+            * Approximates the memory used by a set of measurements in bytes: the vector and the heap memory of the strings
+            * that don't fit into the small string buffer; interned names and units are shared and not counted
+            */
+            static size_t ByteSize(const std::vector<Measurement>& list) {
+                size_t size = sizeof(list) + list.capacity() * sizeof(Measurement);
+                for (auto& data : list) {
+                    size += InternedSize(data.name_) + InternedSize(data.unit_);
+                    if (const std::string* value = boost::get<std::string>(&data.value_)) {
+                        size += StringHeapSize(*value);
+                    }
+                }
+                return size;
+            }
+
+            /*
+            * Heap memory of a string in bytes; 0 if it fits into the small string buffer
+            */
+            static size_t StringHeapSize(const std::string& value) {
+                static const size_t kSmallStringCapacity = std::string().capacity();
+                return value.capacity() > kSmallStringCapacity ? value.capacity() + 1 : 0;
+            }
+
         private:
+            static size_t InternedSize(const InternedString& value) {
+                return value.IsInterned() ? 0 : sizeof(std::string) + StringHeapSize(value.str());
+            }
+
+            static bool Matches(const char* value, const char* literal, size_t len) {
+                return std::memcmp(value, literal, len) == 0;
+            }
+
             /*
             * Helper struct for variant conversion
             */
@@ -0,0 +1,353 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace qds_buffer {
+
+    namespace core {
+
+        /*
+        * Fixed-capacity FIFO queue on a circular array of preallocated slots
+        *
+        * Erasing an element leaves a tombstone in its slot instead of moving the following elements; tombstones at the
+        * front and at the back are dropped right away (O(1) head advance). The array holds 50% more slots than the capacity.
+        * Tombstones in the middle are compacted incrementally: once the elements span 25% more slots than the capacity,
+        * every push_back moves the elements of at most kCompactionStep_ slots until the compaction is done, so no single
+        * push_back moves all elements.
+        *
+        * Iterators skip tombstones and stay valid on erase of other elements; push_back may invalidate all iterators.
+        * Unlike the iterators of a deque, they are bidirectional: stepping over n elements (it + n, it2 - it1) is O(1) as
+        * long as there are no tombstones in the middle, O(n) otherwise.
+        * Not Thread-Safe
+        */
+        template <typename T>
+        class SlotQueue {
+            struct Slot {
+                T value_;
+                bool occupied_;
+            };
+
+        public:
+            /*
+            * Bidirectional iterator over the occupied slots in insertion order; also supports it + n and it2 - it1, see
+            * SlotQueue
+            */
+            template <typename Value, typename Queue>
+            class Iterator {
+            public:
+                using iterator_category = std::bidirectional_iterator_tag;
+                using value_type = T;
+                using difference_type = std::ptrdiff_t;
+                using pointer = Value*;
+                using reference = Value&;
+
+                Iterator() : queue_(nullptr), slot_(0) {}
+                Iterator(Queue* queue, size_t slot) : queue_(queue), slot_(slot) {}
+
+                // iterator -> const_iterator
+                template <typename OtherValue, typename OtherQueue>
+                Iterator(const Iterator<OtherValue, OtherQueue>& other) : queue_(other.queue_), slot_(other.slot_) {}
+
+                reference operator*() const { return queue_->slots_[slot_].value_; }
+                pointer operator->() const { return &queue_->slots_[slot_].value_; }
+
+                Iterator& operator++() { slot_ = queue_->Next(slot_); return *this; }
+                Iterator operator++(int) { Iterator it = *this; ++*this; return it; }
+                Iterator& operator--() { slot_ = queue_->Prev(slot_); return *this; }
+                Iterator operator--(int) { Iterator it = *this; --*this; return it; }
+
+                /*
+                * Steps over n elements; O(1) without tombstones in the middle, otherwise O(n) since they have to be skipped
+                */
+                Iterator& operator+=(difference_type n) {
+                    if (queue_->span_ == queue_->size_) {
+                        slot_ = queue_->SlotIndex(queue_->Offset(slot_) + n);
+                        return *this;
+                    }
+                    for (; n > 0; --n) ++*this;
+                    for (; n < 0; ++n) --*this;
+                    return *this;
+                }
+                Iterator& operator-=(difference_type n) { return *this += -n; }
+                Iterator operator+(difference_type n) const { Iterator it = *this; return it += n; }
+                Iterator operator-(difference_type n) const { Iterator it = *this; return it -= n; }
+
+                /*
+                * Number of elements from other to this iterator; same complexity as operator+=
+                */
+                template <typename OtherValue, typename OtherQueue>
+                difference_type operator-(const Iterator<OtherValue, OtherQueue>& other) const {
+                    difference_type offset = static_cast<difference_type>(queue_->Offset(slot_));
+                    difference_type other_offset = static_cast<difference_type>(queue_->Offset(other.slot_));
+                    if (queue_->span_ == queue_->size_) {
+                        return offset - other_offset;
+                    }
+                    difference_type sign = offset < other_offset ? -1 : 1;
+                    Iterator it = sign < 0 ? *this : Iterator(queue_, other.slot_);
+                    Iterator last = sign < 0 ? Iterator(queue_, other.slot_) : *this;
+                    difference_type count = 0;
+                    for (; it != last; ++it) count++;
+                    return sign * count;
+                }
+
+                /*
+                * Slot of the element; stays the same until the element is erased or moved by a compaction (see push_back)
+                */
+                size_t slot() const { return slot_; }
+
+                template <typename OtherValue, typename OtherQueue>
+                bool operator==(const Iterator<OtherValue, OtherQueue>& other) const { return slot_ == other.slot_; }
+                template <typename OtherValue, typename OtherQueue>
+                bool operator!=(const Iterator<OtherValue, OtherQueue>& other) const { return slot_ != other.slot_; }
+                template <typename OtherValue, typename OtherQueue>
+                bool operator<(const Iterator<OtherValue, OtherQueue>& other) const {
+                    return queue_->Offset(slot_) < queue_->Offset(other.slot_);
+                }
+                template <typename OtherValue, typename OtherQueue>
+                bool operator>(const Iterator<OtherValue, OtherQueue>& other) const { return other < *this; }
+                template <typename OtherValue, typename OtherQueue>
+                bool operator<=(const Iterator<OtherValue, OtherQueue>& other) const { return !(other < *this); }
+                template <typename OtherValue, typename OtherQueue>
+                bool operator>=(const Iterator<OtherValue, OtherQueue>& other) const { return !(*this < other); }
+
+            private:
+                template <typename, typename> friend class Iterator;
+                friend class SlotQueue;
+
+                Queue* queue_;
+                size_t slot_;
+            };
+
+            using iterator = Iterator<T, SlotQueue>;
+            using const_iterator = Iterator<const T, const SlotQueue>;
+
+            explicit SlotQueue(size_t capacity = 0)
+                : slots_(capacity + capacity / 2 + 2, Slot{T(), false}),
+                capacity_(capacity),
+                head_(0),
+                span_(0),
+                size_(0),
+                compacting_(false),
+                compaction_read_(0),
+                compaction_write_(0) {}
+
+            size_t size() const { return size_; }
+            bool empty() const { return size_ == 0; }
+            size_t capacity() const { return capacity_; }
+
+            // the first and the last slot of the span are always occupied
+            T& front() { return slots_[head_].value_; }
+            const T& front() const { return slots_[head_].value_; }
+            T& back() { return slots_[SlotIndex(span_ - 1)].value_; }
+            const T& back() const { return slots_[SlotIndex(span_ - 1)].value_; }
+
+            iterator begin() { return iterator(this, head_); }
+            iterator end() { return iterator(this, SlotIndex(span_)); }
+            const_iterator begin() const { return const_iterator(this, head_); }
+            const_iterator end() const { return const_iterator(this, SlotIndex(span_)); }
+
+            /*
+            * @returns iterator to the element stored in the given (occupied) slot, see Iterator::slot()
+            */
+            iterator from_slot(size_t slot) { return iterator(this, slot); }
+            const_iterator from_slot(size_t slot) const { return const_iterator(this, slot); }
+
+            /*
+            * Appends an element; the caller has to make room first if size() == capacity()
+            *
+            * @returns iterator to the new element
+            */
+            iterator push_back(T value) {
+                return push_back(std::move(value), [](T&, size_t) {});
+            }
+
+            /*
+            * Appends an element; on_move(element, new_slot) is called for every element that a compaction moves
+            * to another slot
+            */
+            template <typename OnMove>
+            iterator push_back(T value, OnMove on_move) {
+                if (compacting_ || span_ > capacity_ + capacity_ / 4) {
+                    CompactStep(on_move, kCompactionStep_);
+                }
+                if (span_ + 1 >= slots_.size()) {
+                    // only for tiny capacities, the incremental compaction keeps up with the pushes otherwise
+                    CompactStep(on_move, slots_.size());
+                }
+
+                size_t index = SlotIndex(span_);
+                Slot& slot = slots_[index];
+                slot.value_ = std::move(value);
+                slot.occupied_ = true;
+                span_++;
+                size_++;
+                return iterator(this, index);
+            }
+
+            /*
+            * Removes the element and returns an iterator to the following element; O(1) amortized
+            */
+            iterator erase(iterator position) {
+                Slot& slot = slots_[position.slot_];
+                slot.value_ = T();
+                slot.occupied_ = false;
+                size_--;
+
+                if (position.slot_ == head_) {
+                    // advance head over the leading tombstones
+                    size_t advance = 0;
+                    while (span_ > 0 && !slots_[head_].occupied_) {
+                        head_ = SlotIndex(1);
+                        span_--;
+                        advance++;
+                    }
+                    // the compaction offsets are relative to head; the head can't stop in between them, only tombstones
+                    // are there
+                    compaction_read_ -= std::min(compaction_read_, advance);
+                    compaction_write_ -= std::min(compaction_write_, advance);
+                    return begin();
+                }
+
+                size_t next = Next(position.slot_);
+                if (next == SlotIndex(span_)) {
+                    // drop trailing tombstones
+                    while (!slots_[SlotIndex(span_ - 1)].occupied_) {
+                        span_--;
+                    }
+                    compaction_read_ = std::min(compaction_read_, span_);
+                    compaction_write_ = std::min(compaction_write_, span_);
+                    return end();
+                }
+                return iterator(this, next);
+            }
+
+            /*
+            * Binary search for the first element for which pred(element) is false; the elements must be partitioned
+            * (pred true for all elements in front of the ones it is false for). O(log n) plus the tombstones skipped.
+            *
+            * @returns iterator to the element or end()
+            */
+            template <typename Pred>
+            iterator partition_point(Pred pred) {
+                size_t low = 0;
+                size_t high = span_;
+                while (low < high) {
+                    size_t middle = low + (high - low) / 2;
+                    size_t offset = middle;
+                    while (offset < high && !slots_[SlotIndex(offset)].occupied_) {
+                        offset++;
+                    }
+
+                    if (offset < high && pred(slots_[SlotIndex(offset)].value_)) {
+                        low = offset + 1;
+                    } else {
+                        // only tombstones between middle and offset
+                        high = middle;
+                    }
+                }
+
+                // low is the offset of an element or of a tombstone in front of it
+                while (low < span_ && !slots_[SlotIndex(low)].occupied_) {
+                    low++;
+                }
+                return iterator(this, SlotIndex(low));
+            }
+
+            void clear() {
+                for (size_t offset = 0; offset < span_; offset++) {
+                    Slot& slot = slots_[SlotIndex(offset)];
+                    slot.value_ = T();
+                    slot.occupied_ = false;
+                }
+                head_ = 0;
+                span_ = 0;
+                size_ = 0;
+                compacting_ = false;
+                compaction_read_ = 0;
+                compaction_write_ = 0;
+            }
+
+        private:
+            size_t SlotIndex(size_t offset) const {
+                size_t slot = head_ + offset;
+                return slot < slots_.size() ? slot : slot - slots_.size();
+            }
+
+            size_t Offset(size_t slot) const {
+                return slot >= head_ ? slot - head_ : slot + slots_.size() - head_;
+            }
+
+            size_t Next(size_t slot) const {
+                size_t end = SlotIndex(span_);
+                do {
+                    slot = slot + 1 < slots_.size() ? slot + 1 : 0;
+                } while (slot != end && !slots_[slot].occupied_);
+                return slot;
+            }
+
+            size_t Prev(size_t slot) const {
+                do {
+                    slot = slot > 0 ? slot - 1 : slots_.size() - 1;
+                } while (slot != head_ && !slots_[slot].occupied_);
+                return slot;
+            }
+
+            /*
+            * Continues moving the elements to the front of the span, over at most max_slots slots; the slots between
+            * compaction_write_ and compaction_read_ only hold tombstones. Once all slots are passed, the span ends behind
+            * the last element.
+            */
+            template <typename OnMove>
+            void CompactStep(OnMove& on_move, size_t max_slots) {
+                if (!compacting_) {
+                    compacting_ = true;
+                    compaction_read_ = 0;
+                    compaction_write_ = 0;
+                }
+
+                for (size_t step = 0; step < max_slots && compaction_read_ < span_; step++, compaction_read_++) {
+                    Slot& slot = slots_[SlotIndex(compaction_read_)];
+                    if (!slot.occupied_) continue;
+
+                    if (compaction_read_ != compaction_write_) {
+                        Slot& target = slots_[SlotIndex(compaction_write_)];
+                        target.value_ = std::move(slot.value_);
+                        target.occupied_ = true;
+                        slot.value_ = T();
+                        slot.occupied_ = false;
+                        on_move(target.value_, SlotIndex(compaction_write_));
+                    }
+                    compaction_write_++;
+                }
+
+                if (compaction_read_ == span_) {
+                    // elements moved already may have been erased since
+                    span_ = compaction_write_;
+                    while (span_ > 0 && !slots_[SlotIndex(span_ - 1)].occupied_) {
+                        span_--;
+                    }
+                    compacting_ = false;
+                }
+            }
+
+            const size_t kCompactionStep_ = 8;   // slots passed by the compaction per push_back
+
+            std::vector<Slot> slots_;
+            const size_t capacity_;
+            size_t head_;      // slot of the first element
+            size_t span_;      // number of slots from the first to the last element, including tombstones
+            size_t size_;      // number of elements
+            bool compacting_;              // a compaction is in progress
+            size_t compaction_read_;       // offset of the next slot the compaction passes
+            size_t compaction_write_;      // offset the compaction moves the next element to
+        };
+    } // namespace core
+} // namespace qds_buffer
@@ -4,32 +4,118 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <vector>
 
+#include "compact_measurement.hpp"
 #include "measurement.hpp"
+#include "slot_queue.hpp"
 #include <boost/container/deque.hpp>
 
 namespace qds_buffer {
     
     namespace core {
 
+        /*
+        * Lock state of a buffer entry, behaves like a bool
+        *
+        * The state is atomic, so consumers holding the shared buffer lock can lock and unlock entries concurrently; use
+        * TryLock() to claim an entry exclusively. Unlocking (assigning false to a locked entry that is stored in a buffer)
+        * increments the buffer's release counter; this tells the buffer to re-check the locked entries it skipped on overflow.
+        * Copies are not attached to a buffer.
+        */
+        class LockFlag {
+        public:
+            LockFlag(bool locked = false) : locked_(locked), releases_(nullptr) {}
+            LockFlag(const LockFlag& other) : locked_(other.locked_.load()), releases_(nullptr) {}
+
+            // copies the lock state (entry moved within the buffer); the flag stays attached to its buffer
+            LockFlag& operator=(const LockFlag& other) {
+                locked_ = other.locked_.load();
+                return *this;
+            }
+
+            LockFlag& operator=(bool locked) {
+                if (locked) {
+                    locked_ = true;
+                } else {
+                    Unlock();
+                }
+                return *this;
+            }
+
+            operator bool() const {
+                return locked_;
+            }
+
+            /*
+            * @returns true if the flag was unlocked and is now locked by the caller
+            */
+            bool TryLock() {
+                bool unlocked = false;
+                return locked_.compare_exchange_strong(unlocked, true);
+            }
+
+            /*
+            * @returns true if the flag was locked and is now unlocked by the caller
+            */
+            bool Unlock() {
+                if (!locked_.exchange(false)) {
+                    return false;
+                }
+                if (releases_ != nullptr) {
+                    releases_->fetch_add(1);
+                }
+                return true;
+            }
+
+            /*
+            * Attaches the flag to the release counter of a buffer (internal use)
+            */
+            void Attach(std::atomic<uint64_t>* releases) {
+                releases_ = releases;
+            }
+
+        private:
+            std::atomic<bool> locked_;
+            std::atomic<uint64_t>* releases_;
+        };
+
         /*
         * Stores a buffer entry
         */
         struct BufferEntry {
             int64_t id_;                                             // ID (counter) of the set
             std::shared_ptr<std::vector<Measurement>> measurements_; // set of measurements (QDS data)
-            uint64_t timestamp_ms_;                                  // timestamp of when this entry got added
-            bool locked_;                                            // indicates whether this entry is locked or not;
+            uint64_t timestamp_ms_;                                  // timestamp of when this entry got added; never less
+                                                                     // than the one of the entry before
+            LockFlag locked_;                                        // indicates whether this entry is locked or not;
                                                                     // a locked entry is not deleted if the buffer overflows
                                                                     // or overridden with counter mode 1
+            size_t bytes_;                                           // memory used by this entry, its measurements and the
+                                                                     // contents of its references (see RingBuffer)
+            std::shared_ptr<const CompactDataSet> compact_;          // the measurements in compact form, built once when the
+                                                                     // entry got added; null unless the data source was
+                                                                     // created with compact_data_sets
+        };
+
+        /*
+        * Reference to the data of a buffer entry; keeps the measurements alive after the entry is deleted, so it can be
+        * used without holding the buffer lock (see IDataSourceOut::ReadSince)
+        */
+        struct DataSetHandle {
+            int64_t id_;                                                    // ID (counter) of the set
+            uint64_t timestamp_ms_;                                         // timestamp of when the entry got added
+            std::shared_ptr<const std::vector<Measurement>> measurements_;  // set of measurements (QDS data)
+            std::shared_ptr<const CompactDataSet> compact_;                 // see BufferEntry::compact_
         };
 
         /*
         * type of the buffer
         */
-        using BufferQueueType = boost::container::deque<BufferEntry>;
+        using BufferQueueType = SlotQueue<BufferEntry>;
 
         /**
          * Reset Reason
@@ -41,6 +127,15 @@ namespace qds_buffer {
             USER        // the reset is caused by a user action (e.g. due to a manual buffer reset action)
         };
 
+        /**
+         * Eviction Policy: which unlocked entries are discarded first when a full buffer overflows
+         */
+        enum class EvictionPolicy {
+            OLDEST,     // the oldest entries (default)
+            LARGEST,    // the entries with the most bytes (measurements and referenced contents), oldest first if equal
+            PRIORITY    // the entries with the lowest priority (see IDataSourceIn::SetPriority), oldest first if equal
+        };
+
         /**
          * Stores information about a buffer reset
          */
@@ -0,0 +1,113 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace qds_buffer {
+
+    namespace core {
+
+        namespace benchmark {
+
+            using BenchmarkFunction = std::function<void()>;
+
+            /*
+            * Holds all benchmarks registered via QDS_BENCHMARK
+            */
+            inline std::vector<std::pair<std::string, BenchmarkFunction>>& GetBenchmarks() {
+                static std::vector<std::pair<std::string, BenchmarkFunction>> benchmarks;
+                return benchmarks;
+            }
+
+            struct BenchmarkRegistrar {
+                BenchmarkRegistrar(const std::string& name, BenchmarkFunction function) {
+                    GetBenchmarks().emplace_back(name, function);
+                }
+            };
+
+            /*
+            * Measures elapsed wall-clock time
+            */
+            class Stopwatch {
+            public:
+                Stopwatch() : start_(std::chrono::steady_clock::now()) {}
+
+                double ElapsedSeconds() const {
+                    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+                }
+
+                double ElapsedNs() const {
+                    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start_).count();
+                }
+
+            private:
+                std::chrono::steady_clock::time_point start_;
+            };
+
+            /*
+            * Number of heap allocations (operator new) of the benchmark process so far, see benchmark_main.cpp
+            */
+            std::uint64_t GetAllocationCount();
+
+            /*
+            * Prints a single result line: <benchmark> <metric> <value> <unit>
+            */
+            inline void Report(const std::string& benchmark, const std::string& metric, double value, const std::string& unit) {
+                printf("%-48s %-32s %14.2f %s\n", benchmark.c_str(), metric.c_str(), value, unit.c_str());
+            }
+
+            /*
+            * Returns the given percentile (0-100) of a set of samples; sorts the samples
+            */
+            inline double Percentile(std::vector<double>& samples, double percentile) {
+                if (samples.empty()) return 0;
+
+                std::sort(samples.begin(), samples.end());
+                size_t index = static_cast<size_t>(percentile / 100.0 * (samples.size() - 1) + 0.5);
+                return samples[std::min(index, samples.size() - 1)];
+            }
+
+            /*
+            * Builds a typical QDS data set (JSON) with the given number of measurements, mixing all common types
+            */
+            inline std::string MakeDataSetJson(size_t measurement_count) {
+                std::string json = "[";
+                for (size_t i = 0; i < measurement_count; i++) {
+                    if (i > 0) json += ",";
+                    std::string name = "\"NAME\":\"Measurement" + std::to_string(i) + "\"";
+                    switch (i % 6) {
+                        case 0: json += "{" + name + ",\"TYPE\":\"TIMESTAMP\",\"VALUE\":\"2022-03-14T12:34:56.789+01:00\"}"; break;
+                        case 1: json += "{" + name + ",\"TYPE\":\"INTEGER\",\"UNIT\":\"mm\",\"VALUE\":" + std::to_string(i * 7) + "}"; break;
+                        case 2: json += "{" + name + ",\"TYPE\":\"DOUBLE\",\"UNIT\":\"kW\",\"VALUE\":" + std::to_string(i * 0.25) + "}"; break;
+                        case 3: json += "{" + name + ",\"TYPE\":\"STRING\",\"VALUE\":\"Program-" + std::to_string(i) + "\"}"; break;
+                        case 4: json += "{" + name + ",\"TYPE\":\"BOOL\",\"VALUE\":true}"; break;
+                        default: json += "{" + name + ",\"TYPE\":\"WORD\",\"VALUE\":\"0a1F\"}"; break;
+                    }
+                }
+                return json + "]";
+            }
+        } // namespace benchmark
+    } // namespace core
+} // namespace qds_buffer
+
+#define QDS_BENCHMARK_CONCAT_(a, b) a##b
+#define QDS_BENCHMARK_CONCAT(a, b) QDS_BENCHMARK_CONCAT_(a, b)
+
+/*
+* Registers a benchmark, usage: QDS_BENCHMARK(Group, Name) { ... }
+*/
+#define QDS_BENCHMARK(group, name)                                                                                      \
+    static void QDS_BENCHMARK_CONCAT(group##_, name)();                                                                 \
+    static ::qds_buffer::core::benchmark::BenchmarkRegistrar QDS_BENCHMARK_CONCAT(group##_registrar_, name)(           \
+        #group "." #name, &QDS_BENCHMARK_CONCAT(group##_, name));                                                       \
+    static void QDS_BENCHMARK_CONCAT(group##_, name)()
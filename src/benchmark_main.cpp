@@ -0,0 +1,51 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "benchmark.hpp"
+
+using namespace qds_buffer::core::benchmark;
+
+namespace {
+
+std::atomic<std::uint64_t> allocation_count(0);
+
+void* Allocate(std::size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* pointer = std::malloc(size == 0 ? 1 : size)) return pointer;
+    throw std::bad_alloc();
+}
+
+}  // namespace
+
+// count the allocations of the whole process
+void* operator new(std::size_t size) { return Allocate(size); }
+void* operator new[](std::size_t size) { return Allocate(size); }
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+
+std::uint64_t qds_buffer::core::benchmark::GetAllocationCount() { return allocation_count.load(std::memory_order_relaxed); }
+
+/*
+* Runs all registered benchmarks; if arguments are given, only benchmarks whose name contains one of them
+*/
+int main(int argc, char** argv) {
+    for (auto& benchmark : GetBenchmarks()) {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; i++) {
+            if (benchmark.first.find(argv[i]) != std::string::npos) {
+                selected = true;
+            }
+        }
+        if (!selected) continue;
+
+        printf("### %s\n", benchmark.first.c_str());
+        benchmark.second();
+        fflush(stdout);
+    }
+    return 0;
+}
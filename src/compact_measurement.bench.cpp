@@ -0,0 +1,169 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#include <compact_measurement.hpp>
+
+#include "benchmark.hpp"
+#include "data_source_internal.hpp"
+
+using namespace qds_buffer::core;
+using namespace qds_buffer::core::benchmark;
+
+namespace {
+
+const size_t kDataSetCount = 10000;
+const size_t kMeasurementCount = 50;
+
+volatile double sink;
+
+// mostly numeric values, like the data sets of a machine; every 6th value is a short string
+std::vector<Measurement> MakeMeasurements(size_t seed) {
+    std::vector<Measurement> measurements(kMeasurementCount);
+    for (size_t i = 0; i < kMeasurementCount; i++) {
+        measurements[i].name_ = "Zone" + std::to_string(i / 10) + ".LaserPowerSetpoint" + std::to_string(i % 10);
+        if (i % 6 == 5) {
+            measurements[i].type_ = MeasurementType::kString;
+            measurements[i].value_ = std::string("Program-") + std::to_string(i);
+        } else if (i % 2 == 0) {
+            measurements[i].type_ = MeasurementType::kDouble;
+            measurements[i].unit_ = "kW";
+            measurements[i].value_ = static_cast<double>(seed + i) * 0.25;
+        } else {
+            measurements[i].type_ = MeasurementType::kLong;
+            measurements[i].unit_ = "mm";
+            measurements[i].value_ = static_cast<std::int64_t>(seed * i);
+        }
+    }
+    return measurements;
+}
+
+}  // namespace
+
+QDS_BENCHMARK(CompactMeasurement, ScanNumbers) {
+    const int passes = 20;
+
+    std::vector<std::vector<Measurement>> data_sets;
+    std::vector<CompactDataSet> compact_data_sets;
+    size_t bytes = 0;
+    size_t compact_bytes = 0;
+    for (size_t i = 0; i < kDataSetCount; i++) {
+        data_sets.push_back(MakeMeasurements(i));
+        compact_data_sets.emplace_back(data_sets.back());
+        bytes += Measurement::ByteSize(data_sets.back());
+        compact_bytes += compact_data_sets.back().ByteSize();
+    }
+
+    {
+        // reference: sum the numeric values via the variant
+        Stopwatch stopwatch;
+        for (int pass = 0; pass < passes; pass++) {
+            double sum = 0;
+            for (auto& data_set : data_sets) {
+                for (auto& measurement : data_set) {
+                    if (const double* value = boost::get<double>(&measurement.value_)) {
+                        sum += *value;
+                    } else if (const std::int64_t* integer = boost::get<std::int64_t>(&measurement.value_)) {
+                        sum += static_cast<double>(*integer);
+                    }
+                }
+            }
+            sink = sum;
+        }
+        Report("ScanNumbers/10k x 50", "Measurement variant (former)",
+               stopwatch.ElapsedNs() / passes / (kDataSetCount * kMeasurementCount), "ns/value");
+        Report("ScanNumbers/10k x 50", "Measurement variant (former)", bytes / 1e6, "MB");
+    }
+    {
+        Stopwatch stopwatch;
+        for (int pass = 0; pass < passes; pass++) {
+            double sum = 0;
+            for (auto& data_set : compact_data_sets) {
+                for (auto& value : data_set.GetValues()) {
+                    if (value.GetKind() == CompactValue::Kind::kDouble) {
+                        sum += value.GetDouble();
+                    } else if (value.GetKind() == CompactValue::Kind::kInteger) {
+                        sum += static_cast<double>(value.GetInteger());
+                    }
+                }
+            }
+            sink = sum;
+        }
+        Report("ScanNumbers/10k x 50", "CompactDataSet",
+               stopwatch.ElapsedNs() / passes / (kDataSetCount * kMeasurementCount), "ns/value");
+        Report("ScanNumbers/10k x 50", "CompactDataSet", compact_bytes / 1e6, "MB");
+    }
+}
+
+QDS_BENCHMARK(CompactMeasurement, Convert) {
+    auto measurements = MakeMeasurements(1);
+    const int iterations = 20000;
+
+    Stopwatch stopwatch;
+    for (int i = 0; i < iterations; i++) {
+        CompactDataSet data_set(measurements);
+        sink = static_cast<double>(data_set.size());
+    }
+    Report("Convert/50 measurements", "to CompactDataSet", stopwatch.ElapsedNs() / iterations / 1000, "us/data set");
+
+    CompactDataSet data_set(measurements);
+    stopwatch = Stopwatch();
+    for (int i = 0; i < iterations; i++) {
+        sink = static_cast<double>(data_set.ToMeasurements().size());
+    }
+    Report("Convert/50 measurements", "to measurements", stopwatch.ElapsedNs() / iterations / 1000, "us/data set");
+}
+
+QDS_BENCHMARK(CompactMeasurement, ReadSince) {
+    const int passes = 20;
+
+    // the same data sets in a data source without and one with compact data sets
+    DataSourceInternal plain{kDataSetCount};
+    DataSourceInternal compact{kDataSetCount, 0, true, 100, 100, false, 0, 0, EvictionPolicy::OLDEST, 0, true};
+    for (DataSourceInternal* ds : {&plain, &compact}) {
+        Stopwatch stopwatch;
+        for (size_t i = 0; i < kDataSetCount; i++) {
+            ds->Add(static_cast<int64_t>(i), MakeMeasurements(i));
+        }
+        Report("ReadSince/10k x 50", ds == &plain ? "Add (former)" : "Add with compact_data_sets",
+               stopwatch.ElapsedNs() / kDataSetCount / 1000, "us/data set");
+        Report("ReadSince/10k x 50", ds == &plain ? "memory usage (former)" : "memory usage with compact_data_sets",
+               ds->GetMemoryUsage() / 1e6, "MB");
+    }
+
+    auto scan = [](const CompactDataSet& data_set) {
+        double sum = 0;
+        for (auto& value : data_set.GetValues()) {
+            if (value.GetKind() == CompactValue::Kind::kDouble) {
+                sum += value.GetDouble();
+            } else if (value.GetKind() == CompactValue::Kind::kInteger) {
+                sum += static_cast<double>(value.GetInteger());
+            }
+        }
+        return sum;
+    };
+
+    {
+        // converting the handed out measurements on every read
+        Stopwatch stopwatch;
+        for (int pass = 0; pass < passes; pass++) {
+            double sum = 0;
+            for (auto& handle : plain.ReadSince(-1, kDataSetCount)) {
+                sum += scan(CompactDataSet(*handle.measurements_));
+            }
+            sink = sum;
+        }
+        Report("ReadSince/10k x 50", "read, convert and scan (former)", stopwatch.ElapsedNs() / passes / kDataSetCount, "ns/data set");
+    }
+    {
+        Stopwatch stopwatch;
+        for (int pass = 0; pass < passes; pass++) {
+            double sum = 0;
+            for (auto& handle : compact.ReadSince(-1, kDataSetCount)) {
+                sum += scan(*handle.compact_);
+            }
+            sink = sum;
+        }
+        Report("ReadSince/10k x 50", "read and scan compact_", stopwatch.ElapsedNs() / passes / kDataSetCount, "ns/data set");
+    }
+}
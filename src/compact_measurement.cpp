@@ -0,0 +1,16 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#include <compact_measurement.hpp>
+
+namespace qds_buffer {
+
+    namespace core {
+
+        SchemaTable& SchemaTable::Instance() {
+            static SchemaTable table;
+            return table;
+        }
+    } // namespace core
+} // namespace qds_buffer
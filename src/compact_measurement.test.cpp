@@ -0,0 +1,119 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include <compact_measurement.hpp>
+
+using namespace qds_buffer::core;
+
+namespace {
+
+std::vector<Measurement> MakeMeasurements() {
+    std::vector<Measurement> measurements(6);
+    measurements[0].name_ = "CompactMeasurementTest.Power";
+    measurements[0].type_ = MeasurementType::kDouble;
+    measurements[0].unit_ = "kW";
+    measurements[0].value_ = 2.5;
+    measurements[1].name_ = "CompactMeasurementTest.Count";
+    measurements[1].type_ = MeasurementType::kLong;
+    measurements[1].value_ = std::int64_t(-123456789012);
+    measurements[2].name_ = "CompactMeasurementTest.Ok";
+    measurements[2].type_ = MeasurementType::kBool;
+    measurements[2].value_ = true;
+    measurements[3].name_ = "CompactMeasurementTest.Program";
+    measurements[3].type_ = MeasurementType::kString;
+    measurements[3].value_ = std::string("test");
+    measurements[4].name_ = "CompactMeasurementTest.Timestamp";
+    measurements[4].type_ = MeasurementType::kTimestamp;
+    measurements[4].value_ = std::string("2022-03-14T12:34:56.789+01:00");
+    measurements[5].name_ = "CompactMeasurementTest.Empty";
+    return measurements;
+}
+
+}  // namespace
+
+TEST(CompactMeasurementTest, Value) {
+    EXPECT_EQ(16u, sizeof(CompactValue));
+
+    EXPECT_EQ(CompactValue::Kind::kBlank, CompactValue().GetKind());
+    EXPECT_EQ(-5, CompactValue(std::int64_t(-5)).GetInteger());
+    EXPECT_EQ(0.25, CompactValue(0.25).GetDouble());
+    EXPECT_FALSE(CompactValue(false).GetBool());
+    EXPECT_EQ(CompactValue::Kind::kBool, CompactValue(false).GetKind());
+
+    // inline and heap strings
+    for (size_t size : {size_t(0), size_t(1), CompactValue::kSmallStringSize_, CompactValue::kSmallStringSize_ + 1, size_t(1000)}) {
+        std::string string(size, 'x');
+        CompactValue value(string);
+        EXPECT_EQ(CompactValue::Kind::kString, value.GetKind());
+        EXPECT_EQ(string, value.ToString());
+        EXPECT_EQ(size > CompactValue::kSmallStringSize_, value.HeapSize() > 0);
+
+        CompactValue copy(value);
+        EXPECT_EQ(string, copy.ToString());
+        CompactValue moved(std::move(copy));
+        EXPECT_EQ(string, moved.ToString());
+        EXPECT_EQ(CompactValue::Kind::kBlank, copy.GetKind());
+        moved = value;
+        EXPECT_EQ(string, moved.ToString());
+        moved = CompactValue(std::int64_t(1));
+        EXPECT_EQ(1, moved.GetInteger());
+    }
+}
+
+TEST(CompactMeasurementTest, Visit) {
+    struct Visitor {
+        std::string result_;
+        void operator()(CompactValue::Blank) { result_ = "blank"; }
+        void operator()(std::int64_t value) { result_ = "integer " + std::to_string(value); }
+        void operator()(double value) { result_ = "double " + std::to_string(value); }
+        void operator()(bool value) { result_ = value ? "bool true" : "bool false"; }
+        void operator()(boost::json::string_view value) { result_ = "string " + std::string(value.data(), value.size()); }
+    };
+
+    Visitor visitor;
+    CompactValue().Visit(visitor);
+    EXPECT_EQ("blank", visitor.result_);
+    CompactValue(std::int64_t(7)).Visit(visitor);
+    EXPECT_EQ("integer 7", visitor.result_);
+    CompactValue(1.5).Visit(visitor);
+    EXPECT_EQ("double 1.500000", visitor.result_);
+    CompactValue(true).Visit(visitor);
+    EXPECT_EQ("bool true", visitor.result_);
+    CompactValue(std::string("abc")).Visit(visitor);
+    EXPECT_EQ("string abc", visitor.result_);
+}
+
+TEST(CompactMeasurementTest, DataSet) {
+    auto measurements = MakeMeasurements();
+    CompactDataSet data_set(measurements);
+
+    ASSERT_EQ(measurements.size(), data_set.size());
+    for (size_t i = 0; i < measurements.size(); i++) {
+        EXPECT_EQ(measurements[i].name_, data_set.GetName(i));
+        EXPECT_EQ(measurements[i].type_, data_set.GetType(i));
+        EXPECT_EQ(measurements[i].unit_, data_set.GetUnit(i));
+        EXPECT_EQ(measurements[i].ValueToString(), data_set.GetValue(i).ToString());
+    }
+    EXPECT_EQ(3u, data_set.Find("CompactMeasurementTest.Program"));
+    EXPECT_EQ(data_set.size(), data_set.Find("unknown"));
+
+    // converts back without loss
+    auto converted = data_set.ToMeasurements();
+    EXPECT_EQ(Measurement::ToJson(measurements), Measurement::ToJson(converted));
+    for (size_t i = 0; i < measurements.size(); i++) {
+        EXPECT_EQ(measurements[i].value_.which(), converted[i].value_.which());
+    }
+
+    // data sets with the same layout share the schema
+    measurements[0].value_ = 3.5;
+    CompactDataSet other(measurements);
+    EXPECT_EQ(data_set.GetSchema(), other.GetSchema());
+    measurements[0].unit_ = "W";
+    EXPECT_NE(data_set.GetSchema(), CompactDataSet(measurements).GetSchema());
+}
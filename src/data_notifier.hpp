@@ -0,0 +1,117 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include <boost/thread.hpp>
+
+namespace qds_buffer {
+
+    namespace core {
+
+        /*
+        * Wakes up consumers waiting for new data
+        *
+        * Producers only pay for an atomic update as long as nobody waits. Waiters are woken up once per notification,
+        * however many entries it covers, so notifying after a batch instead of after every entry coalesces the wakeups.
+        *
+        * Waiting for an id greater than a known one only works if the ids increase (counter mode 0). Otherwise (counter
+        * mode 1), every entry gets a sequence number in the order of adding (NextSequence()) and the number of notified
+        * entries only increases, so a waiter knowing the entry with sequence number s waits until more than s entries were
+        * notified: at least one of them was added after the known one.
+        *
+        * Thread-Safe
+        */
+        class DataNotifier {
+        public:
+            DataNotifier() : last_id_(-1), sequence_(0), notified_(0), resets_(0), waiters_(0) {}
+
+            /*
+            * Records that count entries with ids up to the given one were added and wakes up the waiters
+            */
+            void Notify(int64_t id, uint64_t count = 1) {
+                int64_t last_id = last_id_.load();
+                while (id > last_id && !last_id_.compare_exchange_weak(last_id, id)) {
+                }
+                notified_ += count;
+                WakeUp();
+            }
+
+            /*
+            * @returns the sequence number of an entry that is being added (1, 2, ...); must be called in the order the entries
+            *          are added (e.g. under the buffer lock), and Notify() must count the entry afterwards
+            */
+            uint64_t NextSequence() { return ++sequence_; }
+
+            // sequence number of the entry added last (0 = none)
+            uint64_t GetSequence() const { return sequence_.load(); }
+
+            /*
+            * Forgets the ids added before and wakes up the waiters
+            */
+            void Reset() {
+                last_id_ = -1;
+                resets_++;
+                WakeUp();
+            }
+
+            /*
+            * @returns true if data with an id greater than after_id was added or a reset happened before the timeout
+            */
+            bool Wait(int64_t after_id, uint32_t timeout_ms) {
+                uint64_t resets = resets_.load();
+                if (last_id_.load() > after_id) return true;
+
+                boost::unique_lock<boost::mutex> lock(mutex_);
+                waiters_++;
+                bool result = condition_.timed_wait(lock, boost::posix_time::milliseconds(timeout_ms), [this, after_id, resets]() {
+                    return last_id_.load() > after_id || resets_.load() != resets;
+                });
+                waiters_--;
+                return result;
+            }
+
+            /*
+            * @returns true if more than 'sequence' entries were notified, i.e. an entry added after the one with this
+            *          sequence number, or if a reset happened before the timeout
+            */
+            bool WaitForSequence(uint64_t sequence, uint32_t timeout_ms) {
+                uint64_t resets = resets_.load();
+                if (notified_.load() > sequence) return true;
+
+                boost::unique_lock<boost::mutex> lock(mutex_);
+                waiters_++;
+                bool result = condition_.timed_wait(lock, boost::posix_time::milliseconds(timeout_ms), [this, sequence, resets]() {
+                    return notified_.load() > sequence || resets_.load() != resets;
+                });
+                waiters_--;
+                return result;
+            }
+
+            // greatest id added since the last reset (-1 = none)
+            int64_t GetLastId() const { return last_id_.load(); }
+
+        private:
+            void WakeUp() {
+                if (waiters_.load() == 0) return;
+
+                // a waiter between checking the condition and waiting holds the mutex, don't notify in between
+                { boost::lock_guard<boost::mutex> lock(mutex_); }
+                condition_.notify_all();
+            }
+
+            std::atomic<int64_t> last_id_;
+            std::atomic<uint64_t> sequence_;   // entries numbered so far, never reset
+            std::atomic<uint64_t> notified_;   // entries notified so far, never reset
+            std::atomic<uint64_t> resets_;
+            std::atomic<int> waiters_;   // modified under mutex_
+
+            boost::mutex mutex_;
+            boost::condition_variable condition_;
+        };
+    } // namespace core
+} // namespace qds_buffer
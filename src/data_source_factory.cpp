@@ -5,6 +5,7 @@
 #include <data_source_factory.hpp>
 
 #include "data_source_internal.hpp"
+#include "sharded_data_source.hpp"
 
 namespace qds_buffer {
     
@@ -12,9 +13,18 @@ namespace qds_buffer {
 
         std::shared_ptr<IDataSourceInOut> DataSourceFactory::CreateDataSource(size_t buffer_size, int8_t counter_mode, bool allow_overflow,
                                                                             size_t reset_information_size, size_t deletion_information_size,
-                                                                            bool enable_memory_info_logging) {
+                                                                            bool enable_memory_info_logging, size_t staging_queue_size,
+                                                                            size_t shard_count, uint32_t max_age_ms,
+                                                                            EvictionPolicy eviction_policy, size_t max_bytes,
+                                                                            bool compact_data_sets) {
+            if (shard_count > 1) {
+                return std::make_shared<ShardedDataSource>(shard_count, buffer_size, counter_mode, allow_overflow,
+                                                           reset_information_size, deletion_information_size, enable_memory_info_logging,
+                                                           staging_queue_size, max_age_ms, eviction_policy, max_bytes, compact_data_sets);
+            }
             return std::make_shared<DataSourceInternal>(buffer_size, counter_mode, allow_overflow,
-                                                        reset_information_size, deletion_information_size, enable_memory_info_logging);
+                                                        reset_information_size, deletion_information_size, enable_memory_info_logging,
+                                                        staging_queue_size, max_age_ms, eviction_policy, max_bytes, compact_data_sets);
         }
     } //namespace core
 } // namespace qds_buffer
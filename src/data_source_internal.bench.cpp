@@ -0,0 +1,478 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iterator>
+#include <thread>
+
+#include <boost/thread.hpp>
+
+#ifdef __linux__
+#include <malloc.h>
+#endif
+
+#include "benchmark.hpp"
+#include "data_source_internal.hpp"
+#include "parsing/data_validator.hpp"
+#include "parsing/json_parser_pool.hpp"
+
+using namespace qds_buffer::core;
+using namespace qds_buffer::core::benchmark;
+
+namespace {
+
+/*
+* Adds 'datasets_per_producer' data sets from each of 'producer_count' threads and returns the throughput in data sets/s;
+* 'serialize' puts a global mutex around Add() to emulate the former single-parser behavior as reference
+*/
+double RunProducers(size_t producer_count, int datasets_per_producer, const std::string& json, bool serialize) {
+    // counter mode 1, so concurrent producers don't need globally increasing ids
+    DataSourceInternal ds{10000, 1};
+    boost::mutex serialize_mutex;
+
+    Stopwatch stopwatch;
+    boost::thread_group producers;
+    for (size_t p = 0; p < producer_count; p++) {
+        producers.create_thread([&, p]() {
+            for (int i = 0; i < datasets_per_producer; i++) {
+                int64_t id = static_cast<int64_t>(p) * datasets_per_producer + i + 1;
+                if (serialize) {
+                    boost::lock_guard<boost::mutex> lock(serialize_mutex);
+                    ds.Add(id, json);
+                } else {
+                    ds.Add(id, json);
+                }
+            }
+        });
+    }
+    producers.join_all();
+
+    return producer_count * datasets_per_producer / stopwatch.ElapsedSeconds();
+}
+
+}  // namespace
+
+QDS_BENCHMARK(DataSourceInternal, MultiProducerAdd) {
+    const std::string json = MakeDataSetJson(50);
+    const int datasets_per_producer = 4000;
+
+    for (size_t producers = 1; producers <= 8; producers *= 2) {
+        std::string name = "MultiProducerAdd/" + std::to_string(producers);
+        Report(name, "serialized (single parser)", RunProducers(producers, datasets_per_producer, json, true), "datasets/s");
+        Report(name, "parser pool", RunProducers(producers, datasets_per_producer, json, false), "datasets/s");
+    }
+}
+
+namespace {
+
+/*
+* Measures the latency of each Add() while a consumer repeatedly holds the buffer lock for 'hold_us' microseconds,
+* returns the latency samples in ns
+*/
+std::vector<double> RunAddLatency(size_t producer_count, int datasets_per_producer, const std::string& json,
+                                  size_t staging_queue_size, int hold_us) {
+    DataSourceInternal ds{10000, 1, true, 100, 100, false, staging_queue_size};
+    std::atomic<bool> stop(false);
+
+    boost::thread consumer([&]() {
+        while (!stop) {
+            boost::shared_lock<boost::shared_mutex> lock(ds.GetBufferSharedMutex());
+            // e.g. a consumer sending the data sets it iterates over
+            std::this_thread::sleep_for(std::chrono::microseconds(hold_us));
+            lock.unlock();
+            boost::this_thread::yield();
+        }
+    });
+
+    std::vector<std::vector<double>> samples(producer_count);
+    boost::thread_group producers;
+    for (size_t p = 0; p < producer_count; p++) {
+        producers.create_thread([&, p]() {
+            samples[p].reserve(datasets_per_producer);
+            for (int i = 0; i < datasets_per_producer; i++) {
+                int64_t id = static_cast<int64_t>(p) * datasets_per_producer + i + 1;
+                Stopwatch stopwatch;
+                ds.Add(id, json);
+                samples[p].push_back(stopwatch.ElapsedNs());
+            }
+        });
+    }
+    producers.join_all();
+    stop = true;
+    consumer.join();
+
+    std::vector<double> all;
+    for (auto& producer_samples : samples) all.insert(all.end(), producer_samples.begin(), producer_samples.end());
+    return all;
+}
+
+}  // namespace
+
+QDS_BENCHMARK(DataSourceInternal, AddLatency) {
+    const std::string json = MakeDataSetJson(5);
+    const int datasets_per_producer = 5000;
+    const int hold_us = 200;
+
+    for (size_t producers = 1; producers <= 4; producers *= 2) {
+        std::string name = "AddLatency/" + std::to_string(producers) + " (reader holds lock " + std::to_string(hold_us) + "us)";
+        auto direct = RunAddLatency(producers, datasets_per_producer, json, 0, hold_us);
+        Report(name, "p50 direct (former)", Percentile(direct, 50), "ns");
+        Report(name, "p99 direct (former)", Percentile(direct, 99), "ns");
+        Report(name, "p99.9 direct (former)", Percentile(direct, 99.9), "ns");
+        auto staged = RunAddLatency(producers, datasets_per_producer, json, 4096, hold_us);
+        Report(name, "p50 staging queue", Percentile(staged, 50), "ns");
+        Report(name, "p99 staging queue", Percentile(staged, 99), "ns");
+        Report(name, "p99.9 staging queue", Percentile(staged, 99.9), "ns");
+    }
+}
+
+namespace {
+
+/*
+* Measures the latency of each Add() while 'reader_count' consumers continuously iterate over the full buffer and convert
+* every value to a string (e.g. for sending), either under the shared buffer lock or on a snapshot; returns the latency
+* samples in ns
+*/
+std::vector<double> RunAddWithReaders(size_t reader_count, bool use_snapshot, size_t buffer_size, int dataset_count,
+                                      double& reader_passes_per_second) {
+    DataSourceInternal ds{buffer_size, 0};
+    Measurement measurement;
+    measurement.name_ = "Power";
+    measurement.type_ = MeasurementType::kDouble;
+    measurement.value_ = 2.5;
+
+    int64_t id = 1;
+    for (; id <= static_cast<int64_t>(buffer_size); id++) {
+        ds.Add(id, std::vector<Measurement>{measurement});
+    }
+
+    std::atomic<bool> stop(false);
+    std::atomic<uint64_t> reader_passes(0);
+    boost::thread_group readers;
+    for (size_t r = 0; r < reader_count; r++) {
+        readers.create_thread([&]() {
+            while (!stop) {
+                size_t length = 0;
+                if (use_snapshot) {
+                    auto snapshot = ds.GetSnapshot();
+                    for (const BufferEntry& entry : *snapshot) {
+                        length += entry.measurements_->front().ValueToString().size();
+                    }
+                } else {
+                    boost::shared_lock<boost::shared_mutex> lock(ds.GetBufferSharedMutex());
+                    for (const BufferEntry& entry : ds) {
+                        length += entry.measurements_->front().ValueToString().size();
+                    }
+                }
+                if (length > 0) reader_passes++;
+            }
+        });
+    }
+
+    Stopwatch total;
+    std::vector<double> samples;
+    samples.reserve(dataset_count);
+    for (int i = 0; i < dataset_count; i++, id++) {
+        Stopwatch stopwatch;
+        ds.Add(id, std::vector<Measurement>{measurement});
+        samples.push_back(stopwatch.ElapsedNs());
+    }
+    stop = true;
+    readers.join_all();
+
+    reader_passes_per_second = reader_passes / total.ElapsedSeconds();
+    return samples;
+}
+
+}  // namespace
+
+QDS_BENCHMARK(DataSourceInternal, AddWithReaders) {
+    const size_t buffer_size = 10000;
+    const int dataset_count = 20000;
+
+    for (size_t readers = 1; readers <= 4; readers *= 2) {
+        std::string name = "AddWithReaders/" + std::to_string(readers) + " readers";
+        double passes = 0;
+
+        auto locked = RunAddWithReaders(readers, false, buffer_size, dataset_count, passes);
+        Report(name, "p99 shared lock (former)", Percentile(locked, 99), "ns");
+        Report(name, "p99.9 shared lock (former)", Percentile(locked, 99.9), "ns");
+        Report(name, "max shared lock (former)", Percentile(locked, 100), "ns");
+        Report(name, "reader passes shared lock (former)", passes, "1/s");
+
+        auto snapshot = RunAddWithReaders(readers, true, buffer_size, dataset_count, passes);
+        Report(name, "p99 snapshot", Percentile(snapshot, 99), "ns");
+        Report(name, "p99.9 snapshot", Percentile(snapshot, 99.9), "ns");
+        Report(name, "max snapshot", Percentile(snapshot, 100), "ns");
+        Report(name, "reader passes snapshot", passes, "1/s");
+    }
+}
+
+namespace {
+
+/*
+* Measures the time from Add() until a consumer notices the new data set, either by polling GetLastId() every poll_ms or
+* by WaitForNewData(); returns the latency samples in ns and the number of consumer wakeups
+*/
+std::vector<double> RunNewDataLatency(bool use_wait, int poll_ms, int dataset_count, uint64_t& wakeups) {
+    DataSourceInternal ds{1000, 0};
+    std::vector<Measurement> measurements(1);
+    measurements[0].name_ = "Power";
+    measurements[0].type_ = MeasurementType::kDouble;
+    measurements[0].value_ = 2.5;
+
+    std::vector<std::chrono::steady_clock::time_point> added(dataset_count + 1);
+    std::vector<double> samples;
+    samples.reserve(dataset_count);
+    wakeups = 0;
+
+    boost::thread consumer([&]() {
+        int64_t last_id = 0;
+        while (last_id < dataset_count) {
+            if (use_wait) {
+                ds.WaitForNewData(last_id, 1000);
+            } else {
+                std::this_thread::sleep_for(std::chrono::milliseconds(poll_ms));
+            }
+            wakeups++;
+
+            int64_t id = ds.GetLastId();
+            if (id > last_id) {
+                auto now = std::chrono::steady_clock::now();
+                samples.push_back(std::chrono::duration<double, std::nano>(now - added[id]).count());
+                last_id = id;
+            }
+        }
+    });
+
+    for (int64_t id = 1; id <= dataset_count; id++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(3));
+        added[id] = std::chrono::steady_clock::now();
+        auto copy = measurements;
+        ds.Add(id, std::move(copy));
+    }
+    consumer.join();
+    return samples;
+}
+
+}  // namespace
+
+QDS_BENCHMARK(DataSourceInternal, WaitForNewData) {
+    const int dataset_count = 300;
+    const std::string name = "WaitForNewData/data set every 3ms";
+
+    uint64_t wakeups = 0;
+    auto polled = RunNewDataLatency(false, 1, dataset_count, wakeups);
+    Report(name, "p50 poll every 1ms (former)", Percentile(polled, 50), "ns");
+    Report(name, "p99 poll every 1ms (former)", Percentile(polled, 99), "ns");
+    Report(name, "consumer poll every 1ms (former)", static_cast<double>(wakeups), "wakeups");
+    auto waited = RunNewDataLatency(true, 0, dataset_count, wakeups);
+    Report(name, "p50 WaitForNewData", Percentile(waited, 50), "ns");
+    Report(name, "p99 WaitForNewData", Percentile(waited, 99), "ns");
+    Report(name, "consumer WaitForNewData", static_cast<double>(wakeups), "wakeups");
+}
+
+QDS_BENCHMARK(DataSourceInternal, DeleteBatch) {
+    const std::string json = MakeDataSetJson(5);
+    const int64_t dataset_count = 10000;
+    const size_t batch_size = 100;
+
+    for (int mode = 0; mode < 3; mode++) {
+        DataSourceInternal ds{static_cast<size_t>(dataset_count), 0};
+        for (int64_t id = 1; id <= dataset_count; id++) {
+            ds.Add(id, json);
+        }
+
+        // acknowledge the whole buffer batch by batch
+        Stopwatch stopwatch;
+        for (int64_t first = 1; first <= dataset_count; first += batch_size) {
+            std::vector<int64_t> ids;
+            for (int64_t id = first; id < first + static_cast<int64_t>(batch_size); id++) {
+                ids.push_back(id);
+            }
+            if (mode == 0) {
+                for (int64_t id : ids) {
+                    ds.Delete(id);
+                }
+            } else if (mode == 1) {
+                ds.Delete(ids);
+            } else {
+                ds.DeleteUpTo(ids.back());
+            }
+        }
+        const char* metric = mode == 0 ? "Delete(id) per data set (former)" : mode == 1 ? "Delete(ids)" : "DeleteUpTo(id)";
+        Report("DeleteBatch/10k batch 100", metric, stopwatch.ElapsedNs() / (dataset_count / batch_size) / 1000, "us/batch");
+    }
+}
+
+QDS_BENCHMARK(DataSourceInternal, MaxBytes) {
+    const size_t buffer_size = 1000;
+    const size_t max_bytes = 10 * 1000 * 1000;
+    const int64_t dataset_count = 2000;
+
+    // data sets with 3 to 1000 measurements; phases of large data sets, e.g. while a quality check logs every point
+    const std::string small_json = MakeDataSetJson(3);
+    const std::string large_json = MakeDataSetJson(1000);
+
+    for (size_t budget : {size_t(0), max_bytes}) {
+        DataSourceInternal ds{buffer_size, 0, true, 100, 100, false, 0, 0, EvictionPolicy::OLDEST, budget};
+
+        size_t peak_bytes = 0;
+        Stopwatch stopwatch;
+        for (int64_t id = 1; id <= dataset_count; id++) {
+            ds.Add(id, (id / 200) % 2 == 1 ? large_json : small_json);
+            peak_bytes = std::max(peak_bytes, ds.GetMemoryUsage());
+        }
+        double us_per_add = stopwatch.ElapsedNs() / dataset_count / 1000;
+
+        std::string metric = budget == 0 ? "entry count only (former)" : "max_bytes 10MB";
+        Report("MaxBytes/1k entries 3..1000 values", metric + " peak", peak_bytes / 1e6, "MB");
+        Report("MaxBytes/1k entries 3..1000 values", metric + " add", us_per_add, "us/add");
+    }
+}
+
+namespace {
+
+// bytes allocated on the heap; 0 where not available
+size_t HeapInUse() {
+#ifdef __linux__
+    return mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+// reference: former layout with a separate name and unit string per measurement
+struct FormerMeasurement {
+    std::string name_;
+    MeasurementType type_;
+    std::string unit_;
+    boost::variant<boost::blank, std::string, std::int64_t, double, bool> value_;
+};
+
+}  // namespace
+
+QDS_BENCHMARK(DataSourceInternal, MeasurementFootprint) {
+    const int64_t dataset_count = 10000;
+    const size_t measurement_count = 50;
+
+    // ~200 names and ~20 units repeated over all data sets
+    std::vector<std::string> names;
+    for (int i = 0; i < 200; i++) names.push_back("Zone" + std::to_string(i / 10) + ".LaserPowerSetpoint" + std::to_string(i % 10));
+    std::vector<std::string> units;
+    for (int i = 0; i < 20; i++) units.push_back("unit" + std::to_string(i));
+
+    {
+        std::vector<std::vector<FormerMeasurement>> data_sets;
+        size_t heap = HeapInUse();
+        for (int64_t id = 0; id < dataset_count; id++) {
+            std::vector<FormerMeasurement> measurements(measurement_count);
+            for (size_t i = 0; i < measurement_count; i++) {
+                measurements[i].name_ = names[(id + i) % names.size()];
+                measurements[i].type_ = MeasurementType::kDouble;
+                measurements[i].unit_ = units[i % units.size()];
+                measurements[i].value_ = 2.5;
+            }
+            data_sets.push_back(std::move(measurements));
+        }
+        Report("MeasurementFootprint/10k x 50", "sizeof std::string name/unit (former)", sizeof(FormerMeasurement), "bytes");
+        Report("MeasurementFootprint/10k x 50", "heap std::string name/unit (former)", (HeapInUse() - heap) / 1e6, "MB");
+    }
+    {
+        std::vector<std::vector<Measurement>> data_sets;
+        size_t heap = HeapInUse();
+        for (int64_t id = 0; id < dataset_count; id++) {
+            std::vector<Measurement> measurements(measurement_count);
+            for (size_t i = 0; i < measurement_count; i++) {
+                measurements[i].name_ = names[(id + i) % names.size()];
+                measurements[i].type_ = MeasurementType::kDouble;
+                measurements[i].unit_ = units[i % units.size()];
+                measurements[i].value_ = 2.5;
+            }
+            data_sets.push_back(std::move(measurements));
+        }
+        Report("MeasurementFootprint/10k x 50", "sizeof interned name/unit", sizeof(Measurement), "bytes");
+        Report("MeasurementFootprint/10k x 50", "heap interned name/unit", (HeapInUse() - heap) / 1e6, "MB");
+    }
+
+    // parsing interns the names on the way, see DataValidator
+    std::string json = "[";
+    for (size_t i = 0; i < measurement_count; i++) {
+        if (i > 0) json += ",";
+        json += "{\"NAME\":\"" + names[i] + "\",\"TYPE\":\"DOUBLE\",\"UNIT\":\"" + units[i % units.size()] + "\",\"VALUE\":2.5}";
+    }
+    json += "]";
+    DataSourceInternal ds{static_cast<size_t>(dataset_count), 0};
+    Stopwatch stopwatch;
+    for (int64_t id = 1; id <= dataset_count; id++) {
+        ds.Add(id, json);
+    }
+    Report("MeasurementFootprint/10k x 50", "Add interned", stopwatch.ElapsedNs() / dataset_count / 1000, "us/add");
+    Report("MeasurementFootprint/10k x 50", "GetMemoryUsage interned", ds.GetMemoryUsage() / 1e6, "MB");
+}
+
+QDS_BENCHMARK(DataSourceInternal, AllocationsPerAdd) {
+    const size_t buffer_size = 1000;
+    const int64_t dataset_count = 5000;
+
+    for (size_t measurement_count : {size_t(5), size_t(50)}) {
+        const std::string json = MakeDataSetJson(measurement_count);
+        std::string name = "AllocationsPerAdd/" + std::to_string(measurement_count) + " measurements";
+
+        // the steps of DataSourceInternal::Add() on a full buffer, so every Add also discards a data set; 'former' parses
+        // into a new vector that grows with every measurement and frees the discarded measurements under the buffer lock,
+        // otherwise they are parsed into the per-thread scratch vector, moved into one of the exact size (TakeScratch) and
+        // freed after unlocking
+        for (bool former : {true, false}) {
+            parsing::JsonParserPool parser_pool(&parsing::DataValidator::ParserCallback);
+            RingBuffer buffer{buffer_size, 0, true, [former](const BufferEntry* entry, bool, uint64_t) {
+                                  if (former && entry) std::vector<Measurement>().swap(*entry->measurements_);
+                              }};
+            auto scratch = std::make_shared<std::vector<Measurement>>();
+            auto add = [&](int64_t id) {
+                if (former) {
+                    parsing::ParsingState state;
+                    parser_pool.Parse(json, &state);
+                    buffer.Push(id, state.data_);
+                } else {
+                    parsing::ParsingState state(scratch);
+                    parser_pool.Parse(json, &state);
+                    auto data = std::make_shared<std::vector<Measurement>>(std::make_move_iterator(scratch->begin()),
+                                                                           std::make_move_iterator(scratch->end()));
+                    scratch->clear();
+                    buffer.Push(id, data);
+                }
+            };
+
+            int64_t id = 1;
+            for (; id <= static_cast<int64_t>(buffer_size); id++) {
+                add(id);
+            }
+            std::uint64_t allocations = GetAllocationCount();
+            Stopwatch stopwatch;
+            for (int64_t i = 0; i < dataset_count; i++, id++) {
+                add(id);
+            }
+            std::string metric = former ? "new vector, free locked (former)" : "TakeScratch, free unlocked";
+            Report(name, metric, static_cast<double>(GetAllocationCount() - allocations) / dataset_count, "allocs/add");
+            Report(name, metric, stopwatch.ElapsedNs() / dataset_count / 1000, "us/add");
+        }
+
+        // the same on the data source itself
+        DataSourceInternal ds{buffer_size, 0};
+        int64_t id = 1;
+        for (; id <= static_cast<int64_t>(buffer_size); id++) {
+            ds.Add(id, json);
+        }
+        std::uint64_t allocations = GetAllocationCount();
+        Stopwatch stopwatch;
+        for (int64_t i = 0; i < dataset_count; i++, id++) {
+            ds.Add(id, json);
+        }
+        Report(name, "DataSourceInternal::Add", static_cast<double>(GetAllocationCount() - allocations) / dataset_count, "allocs/add");
+        Report(name, "DataSourceInternal::Add", stopwatch.ElapsedNs() / dataset_count / 1000, "us/add");
+    }
+}
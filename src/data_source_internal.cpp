@@ -4,11 +4,14 @@
 
 #include "data_source_internal.hpp"
 
+#include <algorithm>
 #include <boost/thread.hpp>
 #include <exception.hpp>
 #include <fstream>
+#include <iterator>
 #include <unordered_set>
 
+#include "parsing/binary_parser.hpp"
 #include "parsing/data_validator.hpp"
 #include "mem_info.hpp"
     
@@ -19,16 +22,31 @@ namespace core {
 using namespace std::placeholders;
 
 DataSourceInternal::DataSourceInternal(size_t buffer_size, int8_t counter_mode, bool allow_overflow, size_t reset_information_size,
-                                       size_t deletion_information_size, bool enable_memory_info_logging)
-    : parser_(std::bind(&parsing::DataValidator::ParserCallback, _1, _2, _3, _4, _5)),  // @suppress("Symbol is not resolved")
-      buffer_(buffer_size, counter_mode, allow_overflow,                                // @suppress("Symbol is not resolved")
-              std::bind(&DataSourceInternal::OnDeleteCallback, this, _1, _2, _3)),
+                                       size_t deletion_information_size, bool enable_memory_info_logging, size_t staging_queue_size,
+                                       uint32_t max_age_ms, EvictionPolicy eviction_policy, size_t max_bytes, bool compact_data_sets, const std::string& ref_prefix, ReferenceResolverType reference_resolver,
+                                       std::shared_ptr<DataNotifier> notifier)
+    : parser_pool_(&parsing::DataValidator::ParserCallback),
+      parse_workers_(boost::thread::hardware_concurrency()),
+      buffer_(buffer_size, counter_mode, allow_overflow,                                     // @suppress("Symbol is not resolved")
+              std::bind(&DataSourceInternal::OnDeleteCallback, this, _1, _2, _3), notifier,
+              std::bind(&DataSourceInternal::OnDeleteBatchCallback, this, _1, _2), eviction_policy,
+              std::bind(&DataSourceInternal::GetEntrySize, this, _1, _2), max_bytes, compact_data_sets),
+      buffer_mutex_({&buffer_.GetSharedMutex()}),
       ref_counter_(0),
+      kRefPrefix_(ref_prefix),
+      reference_resolver_(reference_resolver),
       kResetInformationSize_(reset_information_size),
       kDeletionInformationSize_(deletion_information_size),
       enable_memory_info_logging_(enable_memory_info_logging) {
     reset_information_list_.exceeded_max_entries_ = false;
     deletion_information_list_.exceeded_max_entries_ = false;
+
+    if (staging_queue_size > 0) {
+        staging_publisher_.reset(new StagingPublisher(staging_queue_size, std::bind(&DataSourceInternal::Publish, this, _1)));
+    }
+    if (max_age_ms > 0) {
+        retention_reaper_.reset(new RetentionReaper(max_age_ms, std::bind(&RingBuffer::DeleteOlderThan, &buffer_, _1, _2)));
+    }
 }
 
 DataSourceInternal::~DataSourceInternal() {
@@ -41,34 +59,96 @@ DataSourceInternal::~DataSourceInternal() {
  */
 
 int DataSourceInternal::Add(int64_t id, boost::json::string_view json) {
-    parsing::ParsingState state;
+    return Store(id, Parse(json, "DataSourceInternal::Add"));
+}
 
-    auto jsonTuple = parser_.Parse(json, &state);
-    bool ok = std::get<0>(jsonTuple);
-    std::string error_msg = std::get<1>(jsonTuple);
+int DataSourceInternal::Add(int64_t id, std::vector<Measurement>&& measurements) {
+    auto data = std::make_shared<std::vector<Measurement>>(std::move(measurements));
+    parsing::DataValidator::Validate(*data);
 
-    if (!ok) {
-        throw ParsingException(error_msg, "DataSourceInternal::Add");
+    return Store(id, data);
+}
+
+int DataSourceInternal::AddBinary(int64_t id, const std::vector<std::uint8_t>& bytes) {
+    std::vector<Measurement>& scratch = *GetScratch();
+    parsing::BinaryParser::Parse(bytes.data(), bytes.size(), scratch);
+    parsing::DataValidator::Validate(scratch);
+
+    return Store(id, TakeScratch(scratch));
+}
+
+std::vector<AddResult> DataSourceInternal::AddBatch(const DataSetBatch& data_sets) {
+    std::vector<AddResult> results(data_sets.size(), AddResult{-1, "", nullptr});
+    std::vector<std::shared_ptr<std::vector<Measurement>>> data(data_sets.size());
+
+    ParseBatch(data_sets, data, results);
+    StoreBatch(data_sets, data, results);
+    return results;
+}
+
+void DataSourceInternal::ParseBatch(const DataSetBatch& data_sets, std::vector<std::shared_ptr<std::vector<Measurement>>>& data,
+                                    std::vector<AddResult>& results) {
+    // the parser pool allows parsing on several threads, which pays off for larger batches; smaller ones are parsed inline
+    const size_t kMinDataSetsPerThread = 32;
+    size_t part_count = std::min<size_t>(parse_workers_.GetThreadCount(), data_sets.size() / kMinDataSetsPerThread);
+    if (part_count > 1) {
+        parse_workers_.Run(part_count, [&](size_t part) { ParseBatchPart(data_sets, part, part_count, data, results); });
+    } else {
+        ParseBatchPart(data_sets, 0, 1, data, results);
     }
-       
+}
 
-    auto measurement = state.data_;
-    ProcessRefMapping(id, *measurement);
-    int deletion_count = 0;
+void DataSourceInternal::StoreBatch(const DataSetBatch& data_sets, const std::vector<std::shared_ptr<std::vector<Measurement>>>& data,
+                                    std::vector<AddResult>& results) {
+    // keep the order of previously staged data sets
+    Flush();
+
+    // process references in order, then store all valid data sets under a single buffer lock
+    std::vector<std::pair<int64_t, std::shared_ptr<std::vector<Measurement>>>> entries;
+    std::vector<size_t> entry_positions;
+    entries.reserve(data_sets.size());
+    entry_positions.reserve(data_sets.size());
+
+    for (size_t i = 0; i < data_sets.size(); i++) {
+        if (!data[i]) continue;
+
+        try {
+            ProcessRefMapping(data_sets[i].first, *data[i]);
+            entries.emplace_back(data_sets[i].first, data[i]);
+            entry_positions.push_back(i);
+        } catch (const std::exception& e) {
+            results[i] = AddResult{-1, e.what(), std::current_exception()};
+        }
+    }
 
-    try {
-        deletion_count = buffer_.Push(id, measurement);
-        if (deletion_count < 0) {
-            DeleteRefMapping(id, false);
+    auto push_results = buffer_.PushBatch(entries);
+
+    for (size_t k = 0; k < push_results.size(); k++) {
+        AddResult& result = results[entry_positions[k]];
+        result.deletion_count_ = push_results[k].deletion_count_;
+
+        if (push_results[k].error_) {
+            result.exception_ = push_results[k].error_;
+            try {
+                std::rethrow_exception(result.exception_);
+            } catch (const std::exception& e) {
+                result.error_ = e.what();
+            }
+        }
+        if (result.deletion_count_ < 0) {
+            DeleteRefMapping(entries[k].first, false);
         }
-    } catch (...) {
-        DeleteRefMapping(id, false);
-        throw;
     }
+
     if(enable_memory_info_logging_) {
         print_heap_stats();
     }
-    return deletion_count;
+}
+
+void DataSourceInternal::Flush() {
+    if (staging_publisher_) {
+        staging_publisher_->Flush();
+    }
 }
 
 void DataSourceInternal::SetReference(const std::string& ref, const std::string& data, const std::string& data_format) {
@@ -82,10 +162,15 @@ void DataSourceInternal::SetReference(const std::string& ref, const std::string&
     // id = 0, it will get updated once the measurement arrives
     // ref_mapping_.emplace(ReferenceData{0, ref, data_format, data}); // @suppress("Symbol is not resolved")
 
-    ref_mapping_.emplace(ReferenceData{0, ref, data_format, data});  // @suppress("Symbol is not resolved")
+    ref_mapping_.emplace(std::make_shared<ReferenceData>(ReferenceData{0, ref, data_format, data}));  // @suppress("Symbol is not resolved")
 }
 
+bool DataSourceInternal::SetPriority(int64_t id, int32_t priority) { return buffer_.SetPriority(id, priority); }
+
 void DataSourceInternal::Reset(ResetReason reason) {
+    // staged data sets were added before the reset
+    Flush();
+
     boost::unique_lock<boost::shared_mutex> lock(reset_information_list_mutex_);
     auto& list = reset_information_list_.list_;
 
@@ -109,6 +194,10 @@ void DataSourceInternal::Reset(ResetReason reason) {
 
 void DataSourceInternal::Delete(int64_t id) { buffer_.Delete(id); }
 
+size_t DataSourceInternal::Delete(const std::vector<int64_t>& ids) { return buffer_.Delete(ids); }
+
+size_t DataSourceInternal::DeleteUpTo(int64_t id) { return buffer_.DeleteUpTo(id); }
+
 bool DataSourceInternal::IsReset() const {
     boost::shared_lock<boost::shared_mutex> lock(reset_information_list_mutex_);
 
@@ -157,7 +246,61 @@ BufferQueueType::iterator DataSourceInternal::end() {
     return buffer_.end();
 }
 
-const ReferenceData& DataSourceInternal::GetReference(const std::string& ref) const {
+BufferQueueType::iterator DataSourceInternal::Find(int64_t id) {
+    // must lock mutex via GetBufferSharedMutex() before calling Find()
+    return buffer_.Find(id);
+}
+
+BufferSharedMutex& DataSourceInternal::GetMergedSharedMutex() const { return buffer_mutex_; }
+
+BufferIterator DataSourceInternal::MergedBegin() {
+    // must lock mutex via GetMergedSharedMutex() before calling MergedBegin() and MergedEnd()
+    return BufferIterator(BufferIterator::Range(buffer_.begin(), buffer_.end()), buffer_.begin());
+}
+
+BufferIterator DataSourceInternal::MergedEnd() {
+    // must lock mutex via GetMergedSharedMutex() before calling MergedBegin() and MergedEnd()
+    return BufferIterator();
+}
+
+BufferIterator DataSourceInternal::MergedFind(int64_t id) {
+    // must lock mutex via GetMergedSharedMutex() before calling MergedFind()
+    return BufferIterator(BufferIterator::Range(buffer_.begin(), buffer_.end()), buffer_.Find(id));
+}
+
+BufferSnapshot DataSourceInternal::GetSnapshot() { return buffer_.GetSnapshot(); }
+
+std::vector<DataSetHandle> DataSourceInternal::ReadSince(int64_t last_id, size_t max_n) { return buffer_.ReadSince(last_id, max_n); }
+
+std::vector<DataSetHandle> DataSourceInternal::ReadTimeRange(uint64_t from_ms, uint64_t to_ms, size_t max_n) {
+    return buffer_.ReadTimeRange(from_ms, to_ms, max_n);
+}
+
+std::vector<BufferEntry> DataSourceInternal::ClaimBatch(size_t max_n, uint32_t lease_ms) {
+    return buffer_.ClaimBatch(max_n, lease_ms);
+}
+
+size_t DataSourceInternal::Release(const std::vector<int64_t>& ids) { return buffer_.Release(ids); }
+
+uint64_t DataSourceInternal::GetExpiredLeaseCount() const { return buffer_.GetExpiredLeaseCount(); }
+
+bool DataSourceInternal::WaitForNewData(int64_t after_id, uint32_t timeout_ms) {
+    return buffer_.WaitForNewData(after_id, timeout_ms);
+}
+
+void DataSourceInternal::RegisterConsumerGroup(const std::string& group) { buffer_.RegisterConsumerGroup(group); }
+
+void DataSourceInternal::UnregisterConsumerGroup(const std::string& group) { buffer_.UnregisterConsumerGroup(group); }
+
+std::vector<BufferEntry> DataSourceInternal::ReadGroup(const std::string& group, size_t max_n) {
+    return buffer_.ReadGroup(group, max_n);
+}
+
+size_t DataSourceInternal::AcknowledgeGroup(const std::string& group, const std::vector<int64_t>& ids) {
+    return buffer_.AcknowledgeGroup(group, ids);
+}
+
+std::shared_ptr<const ReferenceData> DataSourceInternal::GetReference(const std::string& ref) const {
     boost::shared_lock<boost::shared_mutex> lock(ref_mapping_mutex_);
 
     auto&& view = ref_mapping_.get<multi_index_tag::ref>();
@@ -183,11 +326,105 @@ int8_t DataSourceInternal::GetCounterMode() const { return buffer_.GetCounterMod
 size_t DataSourceInternal::GetDeletionInformationSize() const { return kDeletionInformationSize_; } 
 size_t DataSourceInternal::GetResetInformationSize() const { return kResetInformationSize_; }
 bool DataSourceInternal::GetEnableMemoryInfoLogging() const { return enable_memory_info_logging_; }
+size_t DataSourceInternal::GetStagingQueueSize() const { return staging_publisher_ ? staging_publisher_->GetQueueSize() : 0; }
+size_t DataSourceInternal::GetShardCount() const { return 1; }
+uint32_t DataSourceInternal::GetMaxAgeMs() const { return retention_reaper_ ? retention_reaper_->GetMaxAgeMs() : 0; }
+
+EvictionPolicy DataSourceInternal::GetEvictionPolicy() const { return buffer_.GetEvictionPolicy(); }
+
+size_t DataSourceInternal::GetMaxBytes() const { return buffer_.GetMaxBytes(); }
+
+bool DataSourceInternal::GetCompactDataSets() const { return buffer_.GetCompactDataSets(); }
+
+size_t DataSourceInternal::GetMemoryUsage() const { return buffer_.GetMemoryUsage(); }
+
+RingBuffer& DataSourceInternal::GetRingBuffer() { return buffer_; }
 
 /**
  * private methods
  */
 
+int DataSourceInternal::Store(int64_t id, std::shared_ptr<std::vector<Measurement>> measurement) {
+    ProcessRefMapping(id, *measurement);
+    int deletion_count = 0;
+
+    if (staging_publisher_) {
+        // stored by the publisher thread, see Publish()
+        staging_publisher_->Stage(id, measurement);
+        return deletion_count;
+    }
+
+    try {
+        deletion_count = buffer_.Push(id, measurement);
+        if (deletion_count < 0) {
+            DeleteRefMapping(id, false);
+        }
+    } catch (...) {
+        DeleteRefMapping(id, false);
+        throw;
+    }
+    if(enable_memory_info_logging_) {
+        print_heap_stats();
+    }
+    return deletion_count;
+}
+
+std::shared_ptr<std::vector<Measurement>> DataSourceInternal::Parse(boost::json::string_view json, const std::string& scope) {
+    const auto& scratch = GetScratch();
+    parsing::ParsingState state(scratch);
+
+    auto jsonTuple = parser_pool_.Parse(json, &state);
+    bool ok = std::get<0>(jsonTuple);
+    std::string error_msg = std::get<1>(jsonTuple);
+
+    if (!ok) {
+        throw ParsingException(error_msg, scope);
+    }
+    return TakeScratch(*scratch);
+}
+
+const std::shared_ptr<std::vector<Measurement>>& DataSourceInternal::GetScratch() {
+    static thread_local std::shared_ptr<std::vector<Measurement>> scratch = std::make_shared<std::vector<Measurement>>();
+    scratch->clear();
+    return scratch;
+}
+
+std::shared_ptr<std::vector<Measurement>> DataSourceInternal::TakeScratch(std::vector<Measurement>& scratch) {
+    // the scratch vector keeps its capacity for the next data set, the entry gets a vector of the exact size: a single
+    // allocation for the measurements instead of one per growth step, and no unused capacity kept in the buffer
+    auto data = std::make_shared<std::vector<Measurement>>(std::make_move_iterator(scratch.begin()),
+                                                           std::make_move_iterator(scratch.end()));
+    scratch.clear();
+    return data;
+}
+
+void DataSourceInternal::ParseBatchPart(const DataSetBatch& data_sets, size_t first, size_t step,
+                                        std::vector<std::shared_ptr<std::vector<Measurement>>>& data, std::vector<AddResult>& results) {
+    // every thread writes distinct positions of 'data' and 'results'
+    for (size_t i = first; i < data_sets.size(); i += step) {
+        try {
+            data[i] = Parse(data_sets[i].second, "DataSourceInternal::AddBatch");
+        } catch (const std::exception& e) {
+            results[i] = AddResult{-1, e.what(), std::current_exception()};
+        }
+    }
+}
+
+void DataSourceInternal::Publish(const std::vector<StagedEntry>& entries) {
+    auto push_results = buffer_.PushBatch(entries);
+
+    for (size_t k = 0; k < push_results.size(); k++) {
+        if (push_results[k].deletion_count_ < 0) {
+            // not stored (e.g. bad ID or buffer full); the producer has already returned, only clean up the references
+            DeleteRefMapping(entries[k].first, false);
+        }
+    }
+
+    if(enable_memory_info_logging_) {
+        print_heap_stats();
+    }
+}
+
 void DataSourceInternal::OnDeleteCallback(const BufferEntry* entry, bool clear, uint64_t timestamp_ms) {
     int64_t id = 0;
     if (entry) {
@@ -207,6 +444,31 @@ void DataSourceInternal::OnDeleteCallback(const BufferEntry* entry, bool clear,
     DeleteRefMapping(id, clear);
 }
 
+void DataSourceInternal::OnDeleteBatchCallback(const std::vector<const BufferEntry*>& entries, uint64_t timestamp_ms) {
+    // same as OnDeleteCallback for every entry, but each mutex is locked only once
+    {
+        boost::unique_lock<boost::shared_mutex> lock(deletion_information_list_mutex_);
+
+        auto& list = deletion_information_list_.list_;
+        for (const BufferEntry* entry : entries) {
+            list.emplace_back(DeletionInformation{timestamp_ms, entry->timestamp_ms_});
+        }
+        while (list.size() > kDeletionInformationSize_) {
+            // list has overflown, delete oldest information
+            list.pop_front();
+            deletion_information_list_.exceeded_max_entries_ = true;
+        }
+    }
+
+    boost::unique_lock<boost::shared_mutex> lock(ref_mapping_mutex_);
+
+    auto&& id_view = ref_mapping_.get<multi_index_tag::id>();
+    for (const BufferEntry* entry : entries) {
+        auto range = id_view.equal_range(entry->id_);
+        id_view.erase(range.first, range.second);
+    }
+}
+
 void DataSourceInternal::ProcessRefMapping(int64_t id, std::vector<Measurement>& data) {
     for (auto& d : data) {
         if (d.type_ == MeasurementType::kRef) {
@@ -216,6 +478,12 @@ void DataSourceInternal::ProcessRefMapping(int64_t id, std::vector<Measurement>&
             const std::string& value = boost::get<std::string>(d.value_);
 
             auto it = view.find(value);
+            std::shared_ptr<ReferenceData> resolved;
+            if (it == view.end() && reference_resolver_ && reference_resolver_(value, resolved)) {
+                SetReferenceId(resolved, id);
+                ref_mapping_.emplace(std::move(resolved));  // @suppress("Symbol is not resolved")
+                return;
+            }
             if (it == view.end()) {
 #ifdef _MSC_VER
                 FILE* file;
@@ -230,8 +498,8 @@ void DataSourceInternal::ProcessRefMapping(int64_t id, std::vector<Measurement>&
                 }
             } else {
                 // A valid reference exists, update id and return
-                if (it->id_ == 0) {
-                    view.modify(it, [id](ReferenceData& data) { data.id_ = id; });
+                if ((*it)->id_ == 0) {
+                    view.modify(it, [id](std::shared_ptr<ReferenceData>& data) { SetReferenceId(data, id); });
                 } else {
                     throw RefException("The reference '" + value + "' is already in use", "DataSourceInternal::ProcessRefMapping");
                 }
@@ -239,7 +507,7 @@ void DataSourceInternal::ProcessRefMapping(int64_t id, std::vector<Measurement>&
             }
 
             // file exists, we will replace it with our own ref-id
-            std::string ref = "ref-" + std::to_string(ref_counter_++);
+            std::string ref = kRefPrefix_ + std::to_string(ref_counter_++);
 
             std::string format = "unknown";
             auto file_extension_position = value.find_last_of(".");
@@ -276,7 +544,7 @@ void DataSourceInternal::ProcessRefMapping(int64_t id, std::vector<Measurement>&
             }
 
             // ref_mapping_.emplace(ReferenceData{id, ref, format, buffer}); // @suppress("Symbol is not resolved")
-            ref_mapping_.emplace(ReferenceData{id, ref, format, buffer});  // @suppress("Symbol is not resolved")
+            ref_mapping_.emplace(std::make_shared<ReferenceData>(ReferenceData{id, ref, format, std::move(buffer)}));  // @suppress("Symbol is not resolved")
 
             // replace original ref value
             d.value_ = ref;
@@ -284,6 +552,24 @@ void DataSourceInternal::ProcessRefMapping(int64_t id, std::vector<Measurement>&
     }
 }
 
+size_t DataSourceInternal::GetEntrySize(int64_t id, const std::vector<Measurement>& data) const {
+    size_t size = Measurement::ByteSize(data);
+
+    bool has_ref = std::any_of(data.begin(), data.end(), [](const Measurement& d) { return d.type_ == MeasurementType::kRef; });
+    if (!has_ref) return size;
+
+    // called by the buffer when pushing, after ProcessRefMapping
+    boost::shared_lock<boost::shared_mutex> lock(ref_mapping_mutex_);
+
+    auto&& id_view = ref_mapping_.get<multi_index_tag::id>();
+    auto range = id_view.equal_range(id);
+    for (auto it = range.first; it != range.second; ++it) {
+        size += sizeof(ReferenceData) + Measurement::StringHeapSize((*it)->ref_) + Measurement::StringHeapSize((*it)->format_) +
+                Measurement::StringHeapSize((*it)->content_);
+    }
+    return size;
+}
+
 void DataSourceInternal::DeleteRefMapping(int64_t id, bool clear) {
     boost::unique_lock<boost::shared_mutex> lock(ref_mapping_mutex_);
 
@@ -295,5 +581,13 @@ void DataSourceInternal::DeleteRefMapping(int64_t id, bool clear) {
         id_view.erase(range.first, range.second);
     }
 }
+
+void DataSourceInternal::SetReferenceId(std::shared_ptr<ReferenceData>& data, int64_t id) {
+    // other owners only come from GetReference() under the reference lock, which the caller holds exclusively
+    if (data.use_count() > 1) {
+        data = std::make_shared<ReferenceData>(*data);
+    }
+    data->id_ = id;
+}
 }  // namespace core
 }  // namespace qds_buffer
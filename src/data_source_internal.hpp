@@ -11,8 +11,11 @@
 #include <boost/thread.hpp>
 #include <i_data_source_in_out.hpp>
 
-#include "parsing/json_parser.hpp"
+#include "parsing/json_parser_pool.hpp"
+#include "retention_reaper.hpp"
 #include "ring_buffer.hpp"
+#include "staging_publisher.hpp"
+#include "worker_pool.hpp"
 
 namespace qds_buffer {
 
@@ -23,30 +26,58 @@ struct id {};
 struct ref {};
 }  // namespace multi_index_tag
 
+// the references are shared with the callers of GetReference(), see DataSourceInternal::SetReferenceId()
 using ReferenceContainer = boost::multi_index_container<
-    ReferenceData, boost::multi_index::indexed_by<
+    std::shared_ptr<ReferenceData>, boost::multi_index::indexed_by<
                        boost::multi_index::hashed_non_unique<boost::multi_index::tag<multi_index_tag::id>,
                                                              boost::multi_index::member<ReferenceData, int64_t, &ReferenceData::id_> >,
                        boost::multi_index::hashed_unique<boost::multi_index::tag<multi_index_tag::ref>,
                                                          boost::multi_index::member<ReferenceData, std::string, &ReferenceData::ref_> > > >;
 
+/*
+ * Looks up a reference (REF) that is unknown to the data source; returns false if there is none. A reference handed out is
+ * moved into the data source.
+ */
+using ReferenceResolverType = std::function<bool(const std::string& ref, std::shared_ptr<ReferenceData>& data)>;
+
 /**
  * Thread-Safe
  */
 class DataSourceInternal : public IDataSourceInOut {
    public:
+    /*
+     * ref_prefix: prefix of the reference names generated for REF files
+     * reference_resolver: consulted for references that were not set on this data source (see ShardedDataSource)
+     * max_age_ms: maximum age of the entries (0 = unlimited); older unlocked entries are deleted by a background thread
+     * eviction_policy: entries discarded first on an overflow, see RingBuffer; the size of an entry includes the contents of
+     *                  its references
+     * max_bytes: maximum memory used by the entries including their references (0 = unlimited); exceeding it overflows the
+     *            buffer like exceeding buffer_size
+     * compact_data_sets: build the compact form of every data set when it is added, see RingBuffer
+     * notifier: signaled on new data, see RingBuffer
+     */
     DataSourceInternal(size_t buffer_size = 100, int8_t counter_mode = 0, bool allow_overflow = true, size_t reset_information_size = 100,
-                       size_t deletion_information_size = 100,bool enable_memory_info_logging = false);
+                       size_t deletion_information_size = 100,bool enable_memory_info_logging = false, size_t staging_queue_size = 0,
+                       uint32_t max_age_ms = 0, EvictionPolicy eviction_policy = EvictionPolicy::OLDEST, size_t max_bytes = 0,
+                       bool compact_data_sets = false, const std::string& ref_prefix = "ref-", ReferenceResolverType reference_resolver = nullptr,
+                       std::shared_ptr<DataNotifier> notifier = nullptr);
     virtual ~DataSourceInternal();
 
     // IDataSourceIn methods
     virtual int Add(int64_t id, boost::json::string_view json) override;
+    virtual int Add(int64_t id, std::vector<Measurement>&& measurements) override;
+    virtual int AddBinary(int64_t id, const std::vector<std::uint8_t>& bytes) override;
+    virtual std::vector<AddResult> AddBatch(const DataSetBatch& data_sets) override;
+    virtual void Flush() override;
     virtual void SetReference(const std::string& ref, const std::string& data, const std::string& data_format) override;
+    virtual bool SetPriority(int64_t id, int32_t priority) override;
     virtual void Reset(ResetReason reason) override;
     // /IDataSourceIn methods
 
     // IDataSourceOut methods
     virtual void Delete(int64_t id) override;
+    virtual size_t Delete(const std::vector<int64_t>& ids) override;
+    virtual size_t DeleteUpTo(int64_t id) override;
     virtual bool IsReset() const override;
     virtual ResetInformationList AcknowledgeReset() override;
 
@@ -56,8 +87,24 @@ class DataSourceInternal : public IDataSourceInOut {
     virtual boost::shared_mutex& GetBufferSharedMutex() const override;
     virtual BufferQueueType::iterator begin() override;
     virtual BufferQueueType::iterator end() override;
-
-    virtual const ReferenceData& GetReference(const std::string& ref) const override;
+    virtual BufferQueueType::iterator Find(int64_t id) override;
+    virtual BufferSharedMutex& GetMergedSharedMutex() const override;
+    virtual BufferIterator MergedBegin() override;
+    virtual BufferIterator MergedEnd() override;
+    virtual BufferIterator MergedFind(int64_t id) override;
+    virtual BufferSnapshot GetSnapshot() override;
+    virtual std::vector<DataSetHandle> ReadSince(int64_t last_id, size_t max_n) override;
+    virtual std::vector<DataSetHandle> ReadTimeRange(uint64_t from_ms, uint64_t to_ms, size_t max_n) override;
+    virtual std::vector<BufferEntry> ClaimBatch(size_t max_n, uint32_t lease_ms = 0) override;
+    virtual size_t Release(const std::vector<int64_t>& ids) override;
+    virtual uint64_t GetExpiredLeaseCount() const override;
+    virtual bool WaitForNewData(int64_t after_id, uint32_t timeout_ms) override;
+    virtual void RegisterConsumerGroup(const std::string& group) override;
+    virtual void UnregisterConsumerGroup(const std::string& group) override;
+    virtual std::vector<BufferEntry> ReadGroup(const std::string& group, size_t max_n) override;
+    virtual size_t AcknowledgeGroup(const std::string& group, const std::vector<int64_t>& ids) override;
+
+    virtual std::shared_ptr<const ReferenceData> GetReference(const std::string& ref) const override;
     // /IDataSourceOut methods
 
     // shared methods
@@ -68,18 +115,58 @@ class DataSourceInternal : public IDataSourceInOut {
     virtual size_t GetDeletionInformationSize() const override;
     virtual size_t GetResetInformationSize() const override;
     virtual bool GetEnableMemoryInfoLogging() const override;
+    virtual size_t GetStagingQueueSize() const override;
+    virtual size_t GetShardCount() const override;
+    virtual uint32_t GetMaxAgeMs() const override;
+    virtual EvictionPolicy GetEvictionPolicy() const override;
+    virtual size_t GetMaxBytes() const override;
+    virtual bool GetCompactDataSets() const override;
+    virtual size_t GetMemoryUsage() const override;
     // /shared methods
 
+    // underlying buffer, for data sources composed of several DataSourceInternal objects
+    RingBuffer& GetRingBuffer();
+    /*
+     * Steps of AddBatch(), for data sources composed of several DataSourceInternal objects. ParseBatch() sets data[i] to the
+     * parsed data set i or leaves it null and sets results[i] if the data set is invalid; StoreBatch() stores all non-null
+     * data sets under a single buffer lock. data and results have the size of data_sets.
+     */
+    void ParseBatch(const DataSetBatch& data_sets, std::vector<std::shared_ptr<std::vector<Measurement>>>& data,
+                    std::vector<AddResult>& results);
+    void StoreBatch(const DataSetBatch& data_sets, const std::vector<std::shared_ptr<std::vector<Measurement>>>& data,
+                    std::vector<AddResult>& results);
+
    private:
+    int Store(int64_t id, std::shared_ptr<std::vector<Measurement>> measurement);
+    std::shared_ptr<std::vector<Measurement>> Parse(boost::json::string_view json, const std::string& scope);
+    // per-thread vector to parse into, cleared
+    static const std::shared_ptr<std::vector<Measurement>>& GetScratch();
+    // moves the parsed measurements into a new vector of the exact size; entries own their measurements through the public
+    // std::shared_ptr<std::vector<Measurement>> with the default allocator, so there is no arena shared by the memory of an
+    // entry: string values longer than the small string buffer keep their own allocation
+    static std::shared_ptr<std::vector<Measurement>> TakeScratch(std::vector<Measurement>& scratch);
+    // parses every step-th data set, beginning at first
+    void ParseBatchPart(const DataSetBatch& data_sets, size_t first, size_t step, std::vector<std::shared_ptr<std::vector<Measurement>>>& data,
+                        std::vector<AddResult>& results);
+    void Publish(const std::vector<StagedEntry>& entries);
     void OnDeleteCallback(const BufferEntry* entry, bool clear, uint64_t timestamp_ms);
+    void OnDeleteBatchCallback(const std::vector<const BufferEntry*>& entries, uint64_t timestamp_ms);
     void ProcessRefMapping(int64_t id, std::vector<Measurement>& data);
     void DeleteRefMapping(int64_t id, bool clear);
+    // sets the id of a reference; copies the reference first if GetReference() handed it out, which keeps its id
+    static void SetReferenceId(std::shared_ptr<ReferenceData>& data, int64_t id);
+    // memory used by the measurements and the references of an entry in bytes
+    size_t GetEntrySize(int64_t id, const std::vector<Measurement>& data) const;
 
-    parsing::JsonParser parser_;
+    parsing::JsonParserPool parser_pool_;
+    WorkerPool parse_workers_;   // parses large batches, started on the first one
     RingBuffer buffer_;
+    mutable BufferSharedMutex buffer_mutex_;
     mutable boost::shared_mutex ref_mapping_mutex_;
     ReferenceContainer ref_mapping_;
     uint64_t ref_counter_;
+    const std::string kRefPrefix_;
+    ReferenceResolverType reference_resolver_;
 
     const size_t kResetInformationSize_;
     ResetInformationList reset_information_list_;
@@ -89,6 +176,10 @@ class DataSourceInternal : public IDataSourceInOut {
     DeletionInformationList deletion_information_list_;
     mutable boost::shared_mutex deletion_information_list_mutex_;
     bool enable_memory_info_logging_ = false;
+
+    // declared last: the threads modify the members above and have to stop first
+    std::unique_ptr<StagingPublisher> staging_publisher_;   // null if staging is disabled
+    std::unique_ptr<RetentionReaper> retention_reaper_;     // null if the age is unlimited
 };
 }  // namespace core
 }  // namespace qds_buffer
@@ -4,8 +4,14 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <chrono>
 #include <fstream>
+#include <limits>
+#include <thread>
 
+#include <boost/thread.hpp>
+#include <binary_encoder.hpp>
 #include <exception.hpp>
 
 #include "data_source_internal.hpp"
@@ -41,6 +47,62 @@ TEST(DataSourceInternalTest, Add) {
     EXPECT_NE("DataSourceInternalTest.data", it->measurements_->data()->ValueToString());
 }
 
+TEST(DataSourceInternalTest, AddMeasurements) {
+    DataSourceInternal ds;
+
+    auto make = [](const std::string& name, MeasurementType type, boost::variant<boost::blank, std::string, std::int64_t, double, bool> value) {
+        Measurement measurement;
+        measurement.name_ = name;
+        measurement.type_ = type;
+        measurement.value_ = value;
+        return measurement;
+    };
+
+    std::vector<Measurement> measurements = {make("a", MeasurementType::kLong, std::int64_t(42)),
+                                             make("t", MeasurementType::kTimestamp, std::string("2019-02-18T13:29:43Z"))};
+    EXPECT_EQ(0, ds.Add(0, std::move(measurements)));
+    EXPECT_THROW(ds.Add(1, {make("a", MeasurementType::kInteger, std::string("42"))}), ParsingException); // VALUE of 'a' does not match its TYPE
+    EXPECT_THROW(ds.Add(1, {make("a", MeasurementType::kRef, std::string("ref-123"))}), RefException); // neither an existing file,
+                                                                                                     // nor an existing reference
+    EXPECT_THROW(ds.Add(0, {make("a", MeasurementType::kString, std::string(""))}), RingBufferException); // Bad Id
+    EXPECT_EQ(1, ds.GetSize());
+
+    ds.SetReference("ref-123", "testdata", "abc");
+    EXPECT_NO_THROW(ds.Add(1, {make("a", MeasurementType::kRef, std::string("ref-123"))}));
+    EXPECT_EQ(2, ds.GetSize());
+
+    // identical to the data stored via JSON
+    ds.Add(2, "[{\"NAME\":\"a\",\"TYPE\":\"LONG\",\"VALUE\":42},{\"NAME\":\"t\",\"TYPE\":\"TIMESTAMP\",\"VALUE\":\"2019-02-18T13:29:43Z\"}]");
+    auto typed = ds.begin()->measurements_;
+    auto parsed = (ds.begin()+2)->measurements_;
+    ASSERT_EQ(parsed->size(), typed->size());
+    for (size_t i = 0; i < parsed->size(); i++) {
+        EXPECT_EQ((*parsed)[i].name_, (*typed)[i].name_);
+        EXPECT_EQ((*parsed)[i].type_, (*typed)[i].type_);
+        EXPECT_EQ((*parsed)[i].ValueToString(), (*typed)[i].ValueToString());
+    }
+}
+
+TEST(DataSourceInternalTest, AddBinary) {
+    DataSourceInternal ds;
+
+    BinaryEncoder encoder;
+    encoder.Add("a", MeasurementType::kLong, 42);
+    encoder.Add("t", MeasurementType::kTimestamp, "2019-02-18T13:29:43Z");
+    EXPECT_EQ(0, ds.AddBinary(0, encoder.Finish()));
+
+    encoder.Add("a", MeasurementType::kInteger, std::int64_t(std::numeric_limits<std::int32_t>::max()) + 1);
+    EXPECT_THROW(ds.AddBinary(1, encoder.Finish()), ParsingException); // Invalid INTEGER value
+    EXPECT_THROW(ds.AddBinary(1, {0xff}), ParsingException); // Unsupported binary format version
+    encoder.Add("a", MeasurementType::kRef, "ref-123");
+    EXPECT_THROW(ds.AddBinary(1, encoder.Finish()), RefException); // neither an existing file, nor an existing reference
+    EXPECT_EQ(1, ds.GetSize());
+
+    // identical to the data stored via JSON
+    ds.Add(1, "[{\"NAME\":\"a\",\"TYPE\":\"LONG\",\"VALUE\":42},{\"NAME\":\"t\",\"TYPE\":\"TIMESTAMP\",\"VALUE\":\"2019-02-18T13:29:43Z\"}]");
+    EXPECT_EQ(BinaryEncoder::Encode(*ds.begin()->measurements_), BinaryEncoder::Encode(*(ds.begin()+1)->measurements_));
+}
+
 TEST(DataSourceInternalTest, Delete) {
     DataSourceInternal ds;
 
@@ -49,6 +111,33 @@ TEST(DataSourceInternalTest, Delete) {
     EXPECT_NO_THROW(ds.Delete(123));
 }
 
+TEST(DataSourceInternalTest, Find) {
+    DataSourceInternal ds{2, 1};
+
+    ds.Add(1, DUMMY_JSON); ds.Add(2, DUMMY_JSON);
+
+    boost::shared_lock<boost::shared_mutex> lock(ds.GetBufferSharedMutex());
+    EXPECT_EQ(1, ds.Find(1)->id_);
+    EXPECT_EQ(2, ds.Find(2)->id_);
+    EXPECT_EQ(ds.end(), ds.Find(3));
+    EXPECT_EQ(ds.Find(2), ds.end() - 1);
+}
+
+TEST(DataSourceInternalTest, MergedIteration) {
+    DataSourceInternal ds{3};
+
+    ds.Add(1, DUMMY_JSON); ds.Add(2, DUMMY_JSON); ds.Add(3, DUMMY_JSON);
+
+    // a data source without shards iterates its single buffer
+    boost::shared_lock<BufferSharedMutex> lock(ds.GetMergedSharedMutex());
+    auto it = ds.MergedFind(2);
+    ASSERT_NE(ds.MergedEnd(), it);
+    EXPECT_EQ(3, (++it)->id_);
+    EXPECT_EQ(ds.MergedEnd(), ++it);
+    EXPECT_EQ(1, ds.MergedBegin()->id_);
+    EXPECT_EQ(ds.MergedEnd(), ds.MergedFind(4));
+}
+
 TEST(DataSourceInternalTest, Reset) {
     DataSourceInternal ds;
 
@@ -226,7 +315,9 @@ TEST(DataSourceInternalTest, GetReference) {
     EXPECT_NO_THROW(ds.GetReference("ref-123"));
 
     auto ref = ds.GetReference("ref-123");
-    EXPECT_EQ(0, ref.id_);
+    EXPECT_EQ(0, ref->id_);
+    // shared, not copied
+    EXPECT_EQ(ref, ds.GetReference("ref-123"));
 
     // file content
     std::ofstream file;
@@ -240,9 +331,18 @@ TEST(DataSourceInternalTest, GetReference) {
 
     EXPECT_NO_THROW(ds.GetReference("ref-0"));
     ref = ds.GetReference("ref-0");
-    EXPECT_EQ(123, ref.id_);
-    EXPECT_EQ("data", ref.format_);
-    EXPECT_EQ("testdata", ref.content_);
+    EXPECT_EQ(123, ref->id_);
+    EXPECT_EQ("data", ref->format_);
+    EXPECT_EQ("testdata", ref->content_);
+
+    // a reference handed out keeps its id and its content when a data set refers to it or when it is deleted
+    auto pending = ds.GetReference("ref-123");
+    EXPECT_NO_THROW(ds.Add(124, "{\"NAME\":\"a\",\"TYPE\":\"REF\",\"VALUE\":\"ref-123\"}"));
+    EXPECT_EQ(0, pending->id_);
+    EXPECT_EQ(124, ds.GetReference("ref-123")->id_);
+    ds.Delete(124);
+    EXPECT_THROW(ds.GetReference("ref-123"), RefException);
+    EXPECT_EQ("testdata", pending->content_);
 }
 
 TEST(DataSourceInternalTest, DeleteRefMapping) {
@@ -281,6 +381,35 @@ TEST(DataSourceInternalTest, DeleteRefMapping) {
     EXPECT_NO_THROW(ds.GetReference("ref-555"));
 }
 
+TEST(DataSourceInternalTest, DeleteBatch) {
+    DataSourceInternal ds{5};
+
+    ds.SetReference("ref-111", "testdata", "abc");
+    ds.SetReference("ref-222", "testdata", "abc");
+    ds.SetReference("ref-333", "testdata", "abc");
+    ds.Add(1, "{\"NAME\":\"a\",\"TYPE\":\"REF\",\"VALUE\":\"ref-111\"}");
+    ds.Add(2, "{\"NAME\":\"a\",\"TYPE\":\"REF\",\"VALUE\":\"ref-222\"}");
+    ds.Add(3, "{\"NAME\":\"a\",\"TYPE\":\"REF\",\"VALUE\":\"ref-333\"}");
+    ds.Add(4, DUMMY_JSON);
+    ds.Add(5, DUMMY_JSON);
+
+    EXPECT_EQ(2, ds.Delete(std::vector<int64_t>{3, 1, 3, 42}));
+    EXPECT_EQ(3, ds.GetSize());
+    EXPECT_THROW(ds.GetReference("ref-111"), RefException);
+    EXPECT_NO_THROW(ds.GetReference("ref-222"));
+    EXPECT_THROW(ds.GetReference("ref-333"), RefException);
+    EXPECT_EQ(2, ds.AcknowledgeOverflow().list_.size());   // same as Delete(id)
+
+    EXPECT_EQ(2, ds.DeleteUpTo(4));
+    EXPECT_EQ(1, ds.GetSize());
+    EXPECT_EQ(5, ds.begin()->id_);
+    EXPECT_THROW(ds.GetReference("ref-222"), RefException);
+    EXPECT_EQ(0, ds.DeleteUpTo(4));
+
+    DataSourceInternal ds_counter_mode_1{5, 1};
+    EXPECT_THROW(ds_counter_mode_1.DeleteUpTo(4), RingBufferException);
+}
+
 // NEW COMPREHENSIVE OVERFLOW REFERENCE DELETION TESTS
 
 TEST(DataSourceInternalTest, OverflowRefDeletionBasic) {
@@ -606,4 +735,331 @@ TEST(DataSourceInternalTest, ValueStringEscapeMultipleCharacter) {
 
     ++it;
     EXPECT_EQ(it, ds.end());
-}
\ No newline at end of file
+}
+
+TEST(DataSourceInternalTest, ConcurrentAdd) {
+    // counter mode 1, so concurrent producers don't need globally increasing ids
+    DataSourceInternal ds{1000, 1};
+    const int producer_count = 4;
+    const int datasets_per_producer = 200;
+
+    boost::thread_group producers;
+    for (int p = 0; p < producer_count; p++) {
+        producers.create_thread([&ds, p]() {
+            for (int i = 0; i < datasets_per_producer; i++) {
+                int64_t id = p * datasets_per_producer + i + 1;
+                std::string name = "p" + std::to_string(p) + "-" + std::to_string(i);
+                ds.Add(id, "[{\"NAME\":\"" + name + "\",\"TYPE\":\"INT\",\"VALUE\":" + std::to_string(id) + "},"
+                           "{\"NAME\":\"invalid\",\"TYPE\":\"STRING\",\"VALUE\":\"x\"}]");
+                EXPECT_THROW(ds.Add(id, "[{\"NAME\":\"a\",\"TYPE\":\"INT\",\"VALUE\":\"not-an-int\"}]"), ParsingException);
+            }
+        });
+    }
+    producers.join_all();
+
+    EXPECT_EQ(producer_count * datasets_per_producer, ds.GetSize());
+
+    // every entry must contain exactly its own measurements (no state shared between parsers)
+    boost::shared_lock<boost::shared_mutex> lock(ds.GetBufferSharedMutex());
+    for (auto& entry : ds) {
+        ASSERT_EQ(2, entry.measurements_->size());
+        EXPECT_EQ(entry.id_, boost::get<std::int64_t>(entry.measurements_->front().value_));
+    }
+}
+
+TEST(DataSourceInternalTest, AddBatch) {
+    DataSourceInternal ds{3};
+    ds.SetReference("ref-123", "testdata", "abc");
+
+    auto results = ds.AddBatch({
+        {1, DUMMY_JSON},
+        {2, "{\"NAME\":a\",\"TYPE\":\"STRING\",\"VALUE\":\"\"}"},        // Parsing error: syntax error
+        {3, "{\"NAME\":\"a\",\"TYPE\":\"REF\",\"VALUE\":\"ref-999\"}"},  // neither an existing file, nor an existing reference
+        {4, "{\"NAME\":\"a\",\"TYPE\":\"REF\",\"VALUE\":\"ref-123\"}"},
+        {4, DUMMY_JSON},                                                 // Bad Id
+        {5, DUMMY_JSON},
+        {6, DUMMY_JSON},                                                 // overflow, deletes 1
+    });
+
+    ASSERT_EQ(7, results.size());
+    EXPECT_EQ(0, results[0].deletion_count_);
+    EXPECT_TRUE(results[0].error_.empty());
+    EXPECT_EQ(nullptr, results[0].exception_);
+
+    EXPECT_EQ(-1, results[1].deletion_count_);
+    EXPECT_FALSE(results[1].error_.empty());
+    EXPECT_THROW(std::rethrow_exception(results[1].exception_), ParsingException);
+
+    EXPECT_EQ(-1, results[2].deletion_count_);
+    EXPECT_THROW(std::rethrow_exception(results[2].exception_), RefException);
+
+    EXPECT_EQ(0, results[3].deletion_count_);
+    EXPECT_TRUE(results[3].error_.empty());
+
+    EXPECT_EQ(-1, results[4].deletion_count_);
+    EXPECT_THROW(std::rethrow_exception(results[4].exception_), RingBufferException);
+
+    EXPECT_EQ(0, results[5].deletion_count_);
+    EXPECT_EQ(1, results[6].deletion_count_);
+
+    EXPECT_EQ(3, ds.GetSize());
+    EXPECT_EQ(6, ds.GetLastId());
+    EXPECT_TRUE(ds.IsOverflown());
+
+    boost::shared_lock<boost::shared_mutex> lock(ds.GetBufferSharedMutex());
+    auto it = ds.begin();
+    EXPECT_EQ(4, it->id_);
+    EXPECT_EQ("ref-123", it->measurements_->front().ValueToString());
+    EXPECT_EQ(5, (++it)->id_);
+    EXPECT_EQ(6, (++it)->id_);
+}
+
+TEST(DataSourceInternalTest, AddBatchLarge) {
+    DataSourceInternal ds{1000};
+
+    std::vector<std::string> json;
+    for (int i = 0; i < 500; i++) {
+        if (i % 50 == 49) {
+            json.push_back("{\"NAME\":\"n\",\"TYPE\":\"INT\",\"VALUE\":\"invalid\"}");
+        } else {
+            json.push_back("{\"NAME\":\"n\",\"TYPE\":\"INT\",\"VALUE\":" + std::to_string(i) + "}");
+        }
+    }
+    DataSetBatch batch;
+    for (int i = 0; i < 500; i++) {
+        batch.emplace_back(i + 1, json[i]);
+    }
+
+    auto results = ds.AddBatch(batch);
+
+    ASSERT_EQ(500, results.size());
+    for (int i = 0; i < 500; i++) {
+        if (i % 50 == 49) {
+            EXPECT_THROW(std::rethrow_exception(results[i].exception_), ParsingException);
+        } else {
+            EXPECT_EQ(0, results[i].deletion_count_);
+        }
+    }
+    EXPECT_EQ(490, ds.GetSize());
+
+    boost::shared_lock<boost::shared_mutex> lock(ds.GetBufferSharedMutex());
+    for (auto& entry : ds) {
+        EXPECT_EQ(entry.id_ - 1, boost::get<std::int64_t>(entry.measurements_->front().value_));
+    }
+}
+
+TEST(DataSourceInternalTest, ParseWorkers) {
+    WorkerPool workers{4};
+    EXPECT_EQ(4, workers.GetThreadCount());
+
+    // the workers are reused by consecutive tasks
+    for (int task = 0; task < 20; task++) {
+        std::vector<int> runs(task, 0);
+        workers.Run(runs.size(), [&](size_t part) { runs[part]++; });
+        EXPECT_EQ(std::vector<int>(task, 1), runs);
+    }
+
+    // concurrent tasks
+    std::atomic<int> total_runs{0};
+    boost::thread_group threads;
+    for (int t = 0; t < 4; t++) {
+        threads.create_thread([&]() {
+            for (int task = 0; task < 50; task++) {
+                workers.Run(8, [&](size_t) { total_runs++; });
+            }
+        });
+    }
+    threads.join_all();
+    EXPECT_EQ(4 * 50 * 8, total_runs);
+}
+
+TEST(DataSourceInternalTest, StagingQueue) {
+    DataSourceInternal ds{3, 0, true, 100, 100, false, 16};
+    EXPECT_EQ(16, ds.GetStagingQueueSize());
+    ds.SetReference("ref-123", "testdata", "abc");
+
+    EXPECT_THROW(ds.Add(1, "{\"NAME\":a\",\"TYPE\":\"STRING\",\"VALUE\":\"\"}"), ParsingException); // Parsing errors are
+                                                                                                    // still reported
+    EXPECT_EQ(0, ds.Add(1, DUMMY_JSON));
+    EXPECT_EQ(0, ds.Add(2, "{\"NAME\":\"a\",\"TYPE\":\"REF\",\"VALUE\":\"ref-123\"}"));
+    EXPECT_EQ(0, ds.Add(1, DUMMY_JSON)); // Bad Id, dropped by the publisher
+    ds.Flush();
+
+    EXPECT_EQ(2, ds.GetSize());
+    EXPECT_EQ(2, ds.GetLastId());
+    EXPECT_EQ(2, ds.GetReference("ref-123")->id_);
+
+    for (int64_t id = 3; id <= 100; id++) {
+        ds.Add(id, DUMMY_JSON);
+    }
+    ds.Flush();
+    EXPECT_EQ(3, ds.GetSize());
+    EXPECT_EQ(100, ds.GetLastId());
+    EXPECT_THROW(ds.GetReference("ref-123"), RefException); // deleted together with data set 2
+
+    // staged data sets are stored before a reset
+    ds.Add(101, DUMMY_JSON);
+    ds.Reset(ResetReason::USER);
+    EXPECT_EQ(0, ds.GetSize());
+    EXPECT_EQ(3, ds.AcknowledgeReset().list_.front().deleted_datasets_count_);
+}
+
+TEST(DataSourceInternalTest, StagingQueueConcurrentAdd) {
+    const int producer_count = 4;
+    const int datasets_per_producer = 500;
+    DataSourceInternal ds{producer_count * datasets_per_producer, 1, true, 100, 100, false, 64};
+
+    boost::thread_group producers;
+    for (int p = 0; p < producer_count; p++) {
+        producers.create_thread([&ds, p]() {
+            for (int i = 0; i < datasets_per_producer; i++) {
+                int64_t id = p * datasets_per_producer + i + 1;
+                ds.Add(id, "{\"NAME\":\"id\",\"TYPE\":\"LONG\",\"VALUE\":" + std::to_string(id) + "}");
+            }
+        });
+    }
+
+    // consumer iterates concurrently
+    for (int i = 0; i < 50; i++) {
+        boost::shared_lock<boost::shared_mutex> lock(ds.GetBufferSharedMutex());
+        for (auto& entry : ds) {
+            EXPECT_EQ(entry.id_, boost::get<std::int64_t>(entry.measurements_->front().value_));
+        }
+    }
+    producers.join_all();
+    ds.Flush();
+
+    EXPECT_EQ(producer_count * datasets_per_producer, ds.GetSize());
+}
+
+TEST(DataSourceInternalTest, GetSnapshot) {
+    DataSourceInternal ds{3};
+
+    ds.Add(1, DUMMY_JSON);
+    ds.Add(2, DUMMY_JSON);
+    auto snapshot = ds.GetSnapshot();
+
+    // no lock needed while iterating, writers don't wait
+    ds.Add(3, DUMMY_JSON);
+    ds.Add(4, DUMMY_JSON);
+    ds.Delete(2);
+
+    std::vector<int64_t> ids;
+    for (const BufferEntry& entry : *snapshot) {
+        ids.push_back(entry.id_);
+        EXPECT_EQ("a", entry.measurements_->front().name_);
+    }
+    EXPECT_EQ((std::vector<int64_t>{1, 2}), ids);
+
+    ids.clear();
+    for (const BufferEntry& entry : *ds.GetSnapshot()) {
+        ids.push_back(entry.id_);
+    }
+    EXPECT_EQ((std::vector<int64_t>{3, 4}), ids);
+}
+
+TEST(DataSourceInternalTest, ClaimBatch) {
+    DataSourceInternal ds{3};
+
+    for (int64_t id = 1; id <= 3; id++) {
+        ds.Add(id, DUMMY_JSON);
+    }
+    auto claimed = ds.ClaimBatch(2);
+    ASSERT_EQ(2, claimed.size());
+    EXPECT_EQ(1, claimed[0].id_);
+    EXPECT_EQ("a", claimed[0].measurements_->front().name_);
+    EXPECT_EQ(2, claimed[1].id_);
+
+    EXPECT_EQ(1, ds.Add(4, DUMMY_JSON)); // evicts 3, the claimed ones are kept
+    EXPECT_EQ(1, ds.Release({1}));
+    EXPECT_EQ(1, ds.ClaimBatch(5).front().id_);
+}
+
+TEST(DataSourceInternalTest, MaxAge) {
+    DataSourceInternal ds{10, 0, true, 100, 100, false, 0, 200};
+    EXPECT_EQ(200, ds.GetMaxAgeMs());
+    EXPECT_EQ(0, DataSourceInternal{}.GetMaxAgeMs());
+
+    ds.Add(1, DUMMY_JSON);
+    ds.Add(2, DUMMY_JSON);
+    ASSERT_EQ(1, ds.ClaimBatch(1).size());
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    ds.Add(3, DUMMY_JSON);
+
+    // reaped in the background, claimed and new entries are kept
+    for (int i = 0; i < 100 && ds.GetSize() > 2; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_EQ(2, ds.GetSize());
+    EXPECT_EQ(1, ds.begin()->id_);
+    EXPECT_TRUE(ds.IsOverflown());
+    auto deletion_information = ds.AcknowledgeOverflow();
+    ASSERT_EQ(1, deletion_information.list_.size());
+    EXPECT_NE(0, deletion_information.list_.front().deletion_time_ms_);
+}
+
+TEST(DataSourceInternalTest, EvictionPolicy) {
+    DataSourceInternal ds{2, 0, true, 100, 100, false, 0, 0, EvictionPolicy::LARGEST};
+    EXPECT_EQ(EvictionPolicy::LARGEST, ds.GetEvictionPolicy());
+
+    // the contents of the references count for the size
+    ds.SetReference("image", std::string(10000, 'x'), "bmp");
+    ds.Add(1, DUMMY_JSON);
+    ds.Add(2, "{\"NAME\":\"a\",\"TYPE\":\"REF\",\"VALUE\":\"image\"}");
+    EXPECT_EQ(1, ds.Add(3, DUMMY_JSON));
+
+    EXPECT_EQ(ds.end(), ds.Find(2));
+    EXPECT_NE(ds.end(), ds.Find(1));
+    EXPECT_THROW(ds.GetReference("image"), RefException);
+}
+
+TEST(DataSourceInternalTest, MaxBytes) {
+    DataSourceInternal ds{100, 0, true, 100, 100, false, 0, 0, EvictionPolicy::OLDEST, 50000};
+    EXPECT_EQ(50000, ds.GetMaxBytes());
+
+    ds.Add(1, DUMMY_JSON);
+    size_t small_bytes = ds.GetMemoryUsage();
+    EXPECT_LT(0, small_bytes);
+
+    // the contents of the references count for the memory usage
+    ds.SetReference("image", std::string(30000, 'x'), "bmp");
+    ds.Add(2, "{\"NAME\":\"a\",\"TYPE\":\"REF\",\"VALUE\":\"image\"}");
+    EXPECT_LT(small_bytes + 30000, ds.GetMemoryUsage());
+
+    ds.SetReference("image2", std::string(30000, 'x'), "bmp");
+    EXPECT_EQ(2, ds.Add(3, "{\"NAME\":\"a\",\"TYPE\":\"REF\",\"VALUE\":\"image2\"}"));
+    EXPECT_EQ(1, ds.GetSize());
+    EXPECT_THROW(ds.GetReference("image"), RefException);
+    EXPECT_GE(50000, ds.GetMemoryUsage());
+}
+
+TEST(DataSourceInternalTest, CompactDataSets) {
+    DataSourceInternal plain;
+    EXPECT_FALSE(plain.GetCompactDataSets());
+    plain.Add(1, "{\"NAME\":\"a\",\"TYPE\":\"FLOAT\",\"VALUE\":1.5}");
+    EXPECT_EQ(nullptr, plain.ReadSince(0, 10).front().compact_);
+
+    DataSourceInternal ds{100, 0, true, 100, 100, false, 0, 0, EvictionPolicy::OLDEST, 0, true};
+    EXPECT_TRUE(ds.GetCompactDataSets());
+    ds.Add(1, "[{\"NAME\":\"a\",\"TYPE\":\"FLOAT\",\"VALUE\":1.5},{\"NAME\":\"b\",\"TYPE\":\"STRING\",\"VALUE\":\"x\"}]");
+    ds.AddBatch({{2, "{\"NAME\":\"a\",\"TYPE\":\"FLOAT\",\"VALUE\":2.5}"}});
+
+    // built once when adding: every read hands out the same compact set
+    auto handles = ds.ReadSince(0, 10);
+    ASSERT_EQ(2, handles.size());
+    ASSERT_NE(nullptr, handles[0].compact_);
+    EXPECT_EQ(handles[0].compact_, ds.ReadSince(0, 1).front().compact_);
+    EXPECT_EQ(handles[0].compact_, ds.ReadTimeRange(0, std::numeric_limits<uint64_t>::max(), 1).front().compact_);
+    EXPECT_EQ(handles[0].compact_, ds.GetSnapshot()->front().compact_);
+    EXPECT_EQ(handles[0].compact_, ds.Find(1)->compact_);
+
+    EXPECT_EQ(Measurement::ToJson(*handles[0].measurements_), Measurement::ToJson(handles[0].compact_->ToMeasurements()));
+    EXPECT_EQ(1.5, handles[0].compact_->GetValue(0).GetDouble());
+    EXPECT_EQ("x", handles[0].compact_->GetValue(1).ToString());
+    EXPECT_EQ(2.5, handles[1].compact_->GetValue(0).GetDouble());
+
+    // the compact set counts for the memory usage and outlives the entry
+    EXPECT_LT(plain.GetMemoryUsage() + handles[1].compact_->ByteSize(), ds.GetMemoryUsage());
+    ds.Reset(ResetReason::UNKNOWN);
+    EXPECT_EQ(2.5, handles[1].compact_->GetValue(0).GetDouble());
+}
@@ -0,0 +1,16 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#include <interned_string.hpp>
+
+namespace qds_buffer {
+
+    namespace core {
+
+        StringInternTable& StringInternTable::Instance() {
+            static StringInternTable table;
+            return table;
+        }
+    } // namespace core
+} // namespace qds_buffer
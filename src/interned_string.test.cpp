@@ -0,0 +1,98 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include <boost/thread.hpp>
+#include <interned_string.hpp>
+#include <measurement.hpp>
+
+using namespace qds_buffer::core;
+
+TEST(InternedStringTest, Intern) {
+    auto& table = StringInternTable::Instance();
+    std::string name = "InternedStringTest.LaserPowerSetpoint";
+
+    const std::string* first = table.Intern(name.data(), name.size());
+    ASSERT_NE(nullptr, first);
+    EXPECT_EQ(name, *first);
+    EXPECT_EQ(first, table.Intern(name.data(), name.size()));
+    EXPECT_NE(first, table.Intern(name.data(), name.size() - 1));
+
+    // concurrent producers get the same string
+    std::vector<const std::string*> results(4);
+    boost::thread_group threads;
+    for (size_t t = 0; t < results.size(); t++) {
+        threads.create_thread([&, t]() {
+            for (int i = 0; i < 1000; i++) {
+                std::string value = "InternedStringTest.Concurrent" + std::to_string(i);
+                const std::string* interned = table.Intern(value.data(), value.size());
+                if (i == 999) results[t] = interned;
+            }
+        });
+    }
+    threads.join_all();
+    for (auto result : results) {
+        EXPECT_EQ(results.front(), result);
+    }
+
+    // the table is limited by bytes, not by strings: a long string doesn't fit
+    size_t bytes = table.GetBytes();
+    std::string long_name(StringInternTable::kMaxBytes_, 'x');
+    EXPECT_EQ(nullptr, table.Intern(long_name.data(), long_name.size()));
+    EXPECT_EQ(bytes, table.GetBytes());
+    InternedString handle(long_name);
+    EXPECT_FALSE(handle.IsInterned());
+    EXPECT_EQ(long_name, handle);
+}
+
+TEST(InternedStringTest, Handle) {
+    InternedString empty;
+    EXPECT_TRUE(empty.empty());
+    EXPECT_EQ("", empty);
+
+    InternedString a = "InternedStringTest.Temperature";
+    InternedString b(std::string("InternedStringTest.Temperature"));
+    EXPECT_TRUE(a.IsInterned());
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(&a.str(), &b.str());
+    EXPECT_EQ("InternedStringTest.Temperature", a);
+    EXPECT_EQ(std::string("InternedStringTest.Temperature"), a);
+    EXPECT_NE(a, InternedString("InternedStringTest.Pressure"));
+    EXPECT_EQ(30u, a.size());
+
+    InternedString copy = a;
+    EXPECT_EQ(&a.str(), &copy.str());
+    InternedString moved = std::move(copy);
+    EXPECT_EQ(a, moved);
+    EXPECT_TRUE(copy.empty());
+
+    std::string as_string = a;
+    EXPECT_EQ("'" + a + "'", "'" + as_string + "'");
+
+    moved.assign("mm", 2);
+    EXPECT_EQ("mm", moved);
+}
+
+TEST(InternedStringTest, Measurement) {
+    std::vector<Measurement> list(2);
+    list[0].name_ = "InternedStringTest.Power";
+    list[0].type_ = MeasurementType::kDouble;
+    list[0].unit_ = "kW";
+    list[0].value_ = 2.5;
+    list[1].name_ = "InternedStringTest.Program";
+    list[1].type_ = MeasurementType::kString;
+    list[1].value_ = std::string("test");
+
+    // serialized like before
+    EXPECT_EQ("[{\"NAME\":\"InternedStringTest.Power\",\"TYPE\":\"DOUBLE\",\"UNIT\":\"kW\",\"VALUE\":\"2.500000\"},"
+              "{\"NAME\":\"InternedStringTest.Program\",\"TYPE\":\"STRING\",\"VALUE\":\"test\"}]",
+              Measurement::ToJson(list));
+
+    // names and units are shared, not counted per measurement
+    EXPECT_EQ(sizeof(list) + list.capacity() * sizeof(Measurement), Measurement::ByteSize(list));
+}
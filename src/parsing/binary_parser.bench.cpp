@@ -0,0 +1,48 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#include <binary_encoder.hpp>
+
+#include "../benchmark.hpp"
+#include "binary_parser.hpp"
+#include "data_validator.hpp"
+
+using namespace qds_buffer::core;
+using namespace qds_buffer::core::parsing;
+using namespace qds_buffer::core::benchmark;
+
+QDS_BENCHMARK(BinaryParser, ParseDataSet) {
+    JsonParser parser(&DataValidator::ParserCallback);
+
+    for (size_t measurement_count : {20, 200}) {
+        const std::string json = MakeDataSetJson(measurement_count);
+        const int iterations = 200000 / static_cast<int>(measurement_count);
+
+        ParsingState json_state;
+        parser.Parse(json, &json_state);
+        const std::vector<std::uint8_t> bytes = BinaryEncoder::Encode(*json_state.data_);
+
+        const std::string benchmark = "BinaryParser/" + std::to_string(measurement_count);
+        Report(benchmark, "bytes JSON", static_cast<double>(json.size()), "bytes");
+        Report(benchmark, "bytes binary", static_cast<double>(bytes.size()), "bytes");
+
+        {
+            Stopwatch stopwatch;
+            for (int i = 0; i < iterations; i++) {
+                ParsingState state;
+                parser.Parse(json, &state);
+            }
+            Report(benchmark, "JsonParser + DataValidator", stopwatch.ElapsedNs() / (iterations * measurement_count), "ns/measurement");
+        }
+        {
+            Stopwatch stopwatch;
+            for (int i = 0; i < iterations; i++) {
+                std::vector<Measurement> measurements;
+                BinaryParser::Parse(bytes.data(), bytes.size(), measurements);
+                DataValidator::Validate(measurements);
+            }
+            Report(benchmark, "BinaryParser + DataValidator", stopwatch.ElapsedNs() / (iterations * measurement_count), "ns/measurement");
+        }
+    }
+}
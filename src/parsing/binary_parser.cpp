@@ -0,0 +1,148 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#include "binary_parser.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include <binary_encoder.hpp>
+#include <exception.hpp>
+
+namespace qds_buffer {
+
+    namespace core {
+
+        namespace parsing {
+
+            namespace {
+
+                /*
+                * Bounds-checked reader over the encoded bytes
+                */
+                class Reader {
+                public:
+                    Reader(const std::uint8_t* data, size_t size) : position_(data), end_(data + size) {}
+
+                    bool AtEnd() const {
+                        return position_ == end_;
+                    }
+
+                    std::uint8_t ReadByte() {
+                        Require(1);
+                        return *position_++;
+                    }
+
+                    std::uint64_t ReadVarint() {
+                        std::uint64_t value = 0;
+                        for (int shift = 0; shift < 64; shift += 7) {
+                            std::uint8_t byte = ReadByte();
+                            value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+                            if ((byte & 0x80) == 0) {
+                                return value;
+                            }
+                        }
+                        throw ParsingException("Invalid varint", "BinaryParser::Parse");
+                    }
+
+                    void ReadString(std::string& value) {
+                        std::uint64_t len = ReadVarint();
+                        Require(len);
+                        value.assign(reinterpret_cast<const char*>(position_), static_cast<size_t>(len));
+                        position_ += len;
+                    }
+
+                    void ReadString(InternedString& value) {
+                        std::uint64_t len = ReadVarint();
+                        Require(len);
+                        value.assign(reinterpret_cast<const char*>(position_), static_cast<size_t>(len));
+                        position_ += len;
+                    }
+
+                    std::uint64_t ReadFixed(int byte_count) {
+                        Require(static_cast<std::uint64_t>(byte_count));
+                        std::uint64_t value = 0;
+                        for (int i = 0; i < byte_count; i++) {
+                            value |= static_cast<std::uint64_t>(position_[i]) << (8 * i);
+                        }
+                        position_ += byte_count;
+                        return value;
+                    }
+
+                private:
+                    void Require(std::uint64_t len) const {
+                        if (len > static_cast<std::uint64_t>(end_ - position_)) {
+                            throw ParsingException("Unexpected end of data", "BinaryParser::Parse");
+                        }
+                    }
+
+                    const std::uint8_t* position_;
+                    const std::uint8_t* end_;
+                };
+            } // namespace
+
+            void BinaryParser::Parse(const std::uint8_t* data, size_t size, std::vector<Measurement>& measurements) {
+                Reader reader(data, size);
+
+                if (reader.ReadByte() != kBinaryFormatVersion) {
+                    throw ParsingException("Unsupported binary format version", "BinaryParser::Parse");
+                }
+                std::uint64_t count = reader.ReadFixed(4);
+
+                // every measurement takes at least 4 bytes, do not trust the count for reserving beyond the data size
+                measurements.reserve(measurements.size() + static_cast<size_t>(std::min<std::uint64_t>(count, size / 4)));
+
+                for (std::uint64_t i = 0; i < count; i++) {
+                    measurements.emplace_back();
+                    Measurement& measurement = measurements.back();
+
+                    std::uint8_t tag = reader.ReadByte();
+                    if (tag == static_cast<std::uint8_t>(MeasurementType::kNotSet) ||
+                        tag > static_cast<std::uint8_t>(MeasurementType::kForeignKey)) {
+                        throw ParsingException("Invalid TYPE tag '" + std::to_string(tag) + "'", "BinaryParser::Parse");
+                    }
+                    measurement.type_ = static_cast<MeasurementType>(tag);
+
+                    reader.ReadString(measurement.name_);
+                    reader.ReadString(measurement.unit_);
+
+                    switch (measurement.type_) {
+                        case MeasurementType::kInteger:
+                        case MeasurementType::kLong: {
+                            std::uint64_t zigzag = reader.ReadVarint();
+                            measurement.value_ = static_cast<std::int64_t>((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+                            break;
+                        }
+                        case MeasurementType::kFloat:
+                        case MeasurementType::kDouble: {
+                            std::uint64_t bits = reader.ReadFixed(8);
+                            double value;
+                            memcpy(&value, &bits, sizeof(value));
+                            measurement.value_ = value;
+                            break;
+                        }
+                        case MeasurementType::kBool: {
+                            std::uint8_t value = reader.ReadByte();
+                            if (value > 1) {
+                                throw ParsingException("Invalid BOOL value '" + std::to_string(value) + "'", "BinaryParser::Parse");
+                            }
+                            measurement.value_ = value == 1;
+                            break;
+                        }
+                        default: {
+                            std::string value;
+                            reader.ReadString(value);
+                            measurement.value_ = std::move(value);
+                        }
+                    }
+                }
+
+                if (!reader.AtEnd()) {
+                    throw ParsingException("Unexpected data after last measurement", "BinaryParser::Parse");
+                }
+            }
+        } // namespace parsing
+    } // namespace core
+} // namespace qds_buffer
@@ -0,0 +1,40 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <measurement.hpp>
+
+namespace qds_buffer {
+
+    namespace core {
+
+        namespace parsing {
+
+            /**
+             * Thread-Safe (stateless)
+             *
+             * Decodes the binary data set format written by BinaryEncoder (see binary_encoder.hpp). The result contains
+             * the measurements in their encoded order; validation is left to DataValidator::Validate.
+             */
+            class BinaryParser {
+            public:
+                /*
+                * Appends the decoded measurements to 'measurements'
+                *
+                * @throws ParsingException if the data is truncated, has trailing bytes or an unknown version/TYPE tag
+                */
+                static void Parse(const std::uint8_t* data, size_t size, std::vector<Measurement>& measurements);
+
+            private:
+                BinaryParser();
+                ~BinaryParser();
+            };
+        } // namespace parsing
+    } // namespace core
+} // namespace qds_buffer
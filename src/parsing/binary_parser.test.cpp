@@ -0,0 +1,117 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#include <gtest/gtest.h>
+
+#include <limits>
+
+#include <binary_encoder.hpp>
+#include <exception.hpp>
+
+#include "binary_parser.hpp"
+
+using namespace qds_buffer::core;
+using namespace qds_buffer::core::parsing;
+
+namespace {
+
+std::vector<Measurement> Decode(const std::vector<std::uint8_t>& bytes) {
+    std::vector<Measurement> measurements;
+    BinaryParser::Parse(bytes.data(), bytes.size(), measurements);
+    return measurements;
+}
+
+}  // namespace
+
+TEST(BinaryParserTest, RoundTrip) {
+    BinaryEncoder encoder;
+    encoder.Add("string", MeasurementType::kString, "text with \"quotes\" and \\ backslash");
+    encoder.Add("word", MeasurementType::kWord, "A5E9");
+    encoder.Add("timestamp", MeasurementType::kTimestamp, "2019-02-18T13:29:43Z");
+    encoder.Add("ref", MeasurementType::kRef, "ref-123");
+    encoder.Add("foreign-key", MeasurementType::kForeignKey, "key");
+    encoder.Add("integer", MeasurementType::kInteger, -42, "mm");
+    encoder.Add("long-min", MeasurementType::kLong, std::numeric_limits<std::int64_t>::min());
+    encoder.Add("long-max", MeasurementType::kLong, std::numeric_limits<std::int64_t>::max());
+    encoder.Add("float", MeasurementType::kFloat, 0.25, "kW");
+    encoder.Add("double", MeasurementType::kDouble, -1e300);
+    encoder.Add("bool", MeasurementType::kBool, true);
+
+    auto measurements = Decode(encoder.Finish());
+
+    ASSERT_EQ(11, measurements.size());
+    EXPECT_EQ("string", measurements[0].name_);
+    EXPECT_EQ(MeasurementType::kString, measurements[0].type_);
+    EXPECT_EQ("text with \"quotes\" and \\ backslash", boost::get<std::string>(measurements[0].value_));
+    EXPECT_EQ(MeasurementType::kWord, measurements[1].type_);
+    EXPECT_EQ(MeasurementType::kTimestamp, measurements[2].type_);
+    EXPECT_EQ(MeasurementType::kRef, measurements[3].type_);
+    EXPECT_EQ(MeasurementType::kForeignKey, measurements[4].type_);
+    EXPECT_EQ(-42, boost::get<std::int64_t>(measurements[5].value_));
+    EXPECT_EQ("mm", measurements[5].unit_);
+    EXPECT_TRUE(measurements[6].unit_.empty());
+    EXPECT_EQ(std::numeric_limits<std::int64_t>::min(), boost::get<std::int64_t>(measurements[6].value_));
+    EXPECT_EQ(std::numeric_limits<std::int64_t>::max(), boost::get<std::int64_t>(measurements[7].value_));
+    EXPECT_EQ(0.25, boost::get<double>(measurements[8].value_));
+    EXPECT_EQ("kW", measurements[8].unit_);
+    EXPECT_EQ(-1e300, boost::get<double>(measurements[9].value_));
+    EXPECT_EQ(true, boost::get<bool>(measurements[10].value_));
+
+    // re-encoding yields the same bytes
+    EXPECT_EQ(BinaryEncoder::Encode(measurements), BinaryEncoder::Encode(Decode(BinaryEncoder::Encode(measurements))));
+}
+
+TEST(BinaryParserTest, Empty) {
+    EXPECT_TRUE(Decode(BinaryEncoder().Finish()).empty());
+}
+
+TEST(BinaryParserTest, EncoderTypeMismatch) {
+    BinaryEncoder encoder;
+    EXPECT_THROW(encoder.Add("a", MeasurementType::kString, 1), ParsingException); // VALUE of 'a' does not match its TYPE
+    EXPECT_THROW(encoder.Add("a", MeasurementType::kInteger, "1"), ParsingException);
+    EXPECT_THROW(encoder.Add("a", MeasurementType::kBool, 1.0), ParsingException);
+    EXPECT_THROW(encoder.Add("a", MeasurementType::kDouble, true), ParsingException);
+    EXPECT_THROW(encoder.Add(Measurement{}), ParsingException); // Measurement missing VALUE
+}
+
+TEST(BinaryParserTest, Invalid) {
+    std::vector<std::uint8_t> bytes = BinaryEncoder::Encode({});
+    bytes[0] = kBinaryFormatVersion + 1;
+    EXPECT_THROW(Decode(bytes), ParsingException); // Unsupported binary format version
+    EXPECT_THROW(Decode({}), ParsingException); // Unexpected end of data
+
+    BinaryEncoder encoder;
+    encoder.Add("name", MeasurementType::kString, "value", "unit");
+    encoder.Add("bool", MeasurementType::kBool, false);
+    const std::vector<std::uint8_t> valid = encoder.Finish();
+    EXPECT_NO_THROW(Decode(valid));
+
+    // every truncation fails
+    for (size_t size = 0; size < valid.size(); size++) {
+        std::vector<Measurement> measurements;
+        EXPECT_THROW(BinaryParser::Parse(valid.data(), size, measurements), ParsingException) << "Size: " << size;
+    }
+
+    bytes = valid;
+    bytes.push_back(0);
+    EXPECT_THROW(Decode(bytes), ParsingException); // Unexpected data after last measurement
+
+    bytes = valid;
+    bytes[kBinaryHeaderSize] = 0;
+    EXPECT_THROW(Decode(bytes), ParsingException); // Invalid TYPE tag '0'
+    bytes[kBinaryHeaderSize] = static_cast<std::uint8_t>(MeasurementType::kForeignKey) + 1;
+    EXPECT_THROW(Decode(bytes), ParsingException); // Invalid TYPE tag '11'
+
+    bytes = valid;
+    bytes.back() = 2;
+    EXPECT_THROW(Decode(bytes), ParsingException); // Invalid BOOL value '2'
+
+    bytes = valid;
+    bytes[1] = 0xff; bytes[2] = 0xff; bytes[3] = 0xff; bytes[4] = 0xff;
+    EXPECT_THROW(Decode(bytes), ParsingException); // count exceeds data: Unexpected end of data
+
+    bytes = {kBinaryFormatVersion, 1, 0, 0, 0, static_cast<std::uint8_t>(MeasurementType::kLong), 0, 0,
+             0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+    EXPECT_THROW(Decode(bytes), ParsingException); // Invalid varint
+}
@@ -0,0 +1,133 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#include <cstring>
+#include <functional>
+#include <map>
+#include <regex>
+
+#include "../benchmark.hpp"
+#include "data_validator.hpp"
+#include "format_validation.hpp"
+
+using namespace qds_buffer::core;
+using namespace qds_buffer::core::parsing;
+using namespace qds_buffer::core::benchmark;
+
+namespace {
+
+const char* const kKeys[] = {"NAME", "TYPE", "UNIT", "VALUE", "DECIMALS"};
+const char* const kTypes[] = {"STRING", "INTEGER", "INT", "FLOAT", "LONG", "DOUBLE", "BOOL", "WORD", "TIMESTAMP", "REF", "FOREIGN_KEY"};
+const int kIterations = 2000000;
+
+volatile size_t sink;
+
+}  // namespace
+
+QDS_BENCHMARK(DataValidator, KeyDispatch) {
+    {
+        // reference: former lookup, linear search with strncmp over std::function entries
+        using LegacyFunction = std::function<void(ParserEvent, Measurement&, const char*, size_t, const void*)>;
+        std::vector<std::pair<std::string, LegacyFunction>> validation;
+        for (auto key : kKeys) {
+            validation.emplace_back(key, [](ParserEvent, Measurement&, const char*, size_t, const void*) {});
+        }
+
+        Stopwatch stopwatch;
+        for (int i = 0; i < kIterations; i++) {
+            const char* key = kKeys[i % 5];
+            size_t len = strlen(key);
+            for (auto& entry : validation) {
+                if (strncmp(entry.first.c_str(), key, len) == 0) {
+                    sink = sink + entry.first.size();
+                    break;
+                }
+            }
+        }
+        Report("KeyDispatch", "linear strncmp (former)", stopwatch.ElapsedNs() / kIterations, "ns/key");
+    }
+    {
+        ParsingState state;
+        DataValidator::ParserCallback(&state, ParserEvent::kOnObjectBegin, "", 0, nullptr);
+
+        Stopwatch stopwatch;
+        for (int i = 0; i < kIterations; i++) {
+            const char* key = kKeys[i % 5];
+            DataValidator::ParserCallback(&state, ParserEvent::kOnKey, key, strlen(key), nullptr);
+        }
+        Report("KeyDispatch", "switch dispatch (OnKey)", stopwatch.ElapsedNs() / kIterations, "ns/key");
+    }
+}
+
+QDS_BENCHMARK(DataValidator, TypeDispatch) {
+    {
+        // reference: former lookup, temporary std::string and std::map
+        static const std::map<std::string, MeasurementType> types_map = {
+            {"STRING", MeasurementType::kString}, {"INTEGER", MeasurementType::kInteger}, {"INT", MeasurementType::kInteger},
+            {"FLOAT", MeasurementType::kFloat}, {"LONG", MeasurementType::kLong}, {"DOUBLE", MeasurementType::kDouble},
+            {"BOOL", MeasurementType::kBool}, {"WORD", MeasurementType::kWord}, {"TIMESTAMP", MeasurementType::kTimestamp},
+            {"REF", MeasurementType::kRef}, {"FOREIGN_KEY", MeasurementType::kForeignKey}};
+
+        Stopwatch stopwatch;
+        for (int i = 0; i < kIterations; i++) {
+            const char* type = kTypes[i % 11];
+            auto it = types_map.find(std::string(type, strlen(type)));
+            sink = sink + static_cast<size_t>(it->second);
+        }
+        Report("TypeDispatch", "std::map (former)", stopwatch.ElapsedNs() / kIterations, "ns/type");
+    }
+    {
+        Stopwatch stopwatch;
+        for (int i = 0; i < kIterations; i++) {
+            const char* type = kTypes[i % 11];
+            sink = sink + static_cast<size_t>(Measurement::TypeFromString(type, strlen(type)));
+        }
+        Report("TypeDispatch", "switch dispatch", stopwatch.ElapsedNs() / kIterations, "ns/type");
+    }
+}
+
+QDS_BENCHMARK(DataValidator, TimestampValidation) {
+    const std::vector<std::string> timestamps = {"2019-02-18T13:29:43.123456+02:00", "20190218T132943Z", "2020-366T13:29Z",
+                                                 "2019-02-30T13:29:43+02:00"};
+    const int iterations = 200000;
+    {
+        // reference: former validation with std::regex
+        static const std::regex iso_8601_regex(
+                "^(?:[1-9]\\d{3}(-?)(?:(?:0[1-9]|1[0-2])\\1(?:0[1-9]|1\\d|2[0-8])|(?:0[13-9]|1[0-2])\\1(?:29|30)"
+                "|(?:0[13578]|1[02])(?:\\1)31|00[1-9]|0[1-9]\\d|[12]\\d{2}|3(?:[0-5]\\d|6[0-5]))|(?:[1-9]\\d(?:0"
+                "[48]|[2468][048]|[13579][26])|(?:[2468][048]|[13579][26])00)(?:(-?)02(?:\\2)29|-?366))T(?:[01]"
+                "\\d|2[0-3])(:?)[0-5]\\d(?:\\3[0-5]\\d)?(\\.?\\d{1,6})?(?:Z|[+-][01]\\d(?:\\3[0-5]\\d)?)$");
+
+        Stopwatch stopwatch;
+        for (int i = 0; i < iterations; i++) {
+            sink = sink + std::regex_match(timestamps[i % timestamps.size()], iso_8601_regex);
+        }
+        Report("TimestampValidation", "std::regex (former)", stopwatch.ElapsedNs() / iterations, "ns/timestamp");
+    }
+    {
+        Stopwatch stopwatch;
+        for (int i = 0; i < iterations; i++) {
+            const std::string& ts = timestamps[i % timestamps.size()];
+            sink = sink + IsIso8601Timestamp(ts.data(), ts.size());
+        }
+        Report("TimestampValidation", "IsIso8601Timestamp", stopwatch.ElapsedNs() / iterations, "ns/timestamp");
+    }
+}
+
+QDS_BENCHMARK(DataValidator, ParseDataSet) {
+    JsonParser parser(&DataValidator::ParserCallback);
+
+    for (size_t measurement_count : {20, 200}) {
+        const std::string json = MakeDataSetJson(measurement_count);
+        const int iterations = 200000 / static_cast<int>(measurement_count);
+
+        Stopwatch stopwatch;
+        for (int i = 0; i < iterations; i++) {
+            ParsingState state;
+            parser.Parse(json, &state);
+        }
+        Report("ParseDataSet/" + std::to_string(measurement_count), "JsonParser + DataValidator",
+               stopwatch.ElapsedNs() / (iterations * measurement_count), "ns/measurement");
+    }
+}
@@ -4,10 +4,13 @@
 
 #include "data_validator.hpp"
 
-#include <regex>
+#include <algorithm>
+#include <cstring>
 
 #include <exception.hpp>
 
+#include "format_validation.hpp"
+
 namespace qds_buffer {
     
     namespace core {
@@ -42,20 +45,34 @@ namespace qds_buffer {
                 state.current_element_completed_ = false;
             }
 
-            void DataValidator::OnObjectEnd(ParsingState& state) {
-                if (state.data_->empty() || state.current_element_completed_) {
-                    throw ParsingException("Invalid JSON", "DataValidator::OnObjectEnd");
+            void DataValidator::Validate(std::vector<Measurement>& data) {
+                size_t timestamp_count = 0;
+                for (auto& measurement : data) {
+                    ValidateMeasurement(measurement);
+                    if (measurement.type_ == MeasurementType::kTimestamp) {
+                        timestamp_count++;
+                    }
                 }
 
-                auto& data = state.data_->back();
+                if (timestamp_count > 0) {
+                    // same order as moving every timestamp to the front while parsing (see OnObjectEnd):
+                    // timestamps in reverse order, followed by all other measurements in their original order
+                    std::stable_partition(data.begin(), data.end(), [](const Measurement& measurement) {
+                        return measurement.type_ == MeasurementType::kTimestamp;
+                    });
+                    std::reverse(data.begin(), data.begin() + timestamp_count);
+                }
+            }
+
+            void DataValidator::ValidateMeasurement(const Measurement& data) {
                 if (data.name_.empty()) {
-                    throw ParsingException("Measurement missing NAME", "DataValidator::OnObjectEnd");
+                    throw ParsingException("Measurement missing NAME", "DataValidator::ValidateMeasurement");
                 }
                 if (data.type_ == MeasurementType::kNotSet) {
-                    throw ParsingException("Measurement missing TYPE", "DataValidator::OnObjectEnd");
+                    throw ParsingException("Measurement missing TYPE", "DataValidator::ValidateMeasurement");
                 }
                 if (typeid(boost::blank) == data.value_.type()) {
-                    throw ParsingException("Measurement missing VALUE", "DataValidator::OnObjectEnd");
+                    throw ParsingException("Measurement missing VALUE", "DataValidator::ValidateMeasurement");
                 }
 
                 try {
@@ -67,7 +84,7 @@ namespace qds_buffer {
                         case MeasurementType::kInteger: {
                             std::int64_t value = boost::get<std::int64_t>(data.value_);
                             if (value > std::numeric_limits<std::int32_t>::max()) {
-                                throw ParsingException("Invalid INTEGER value '" + std::to_string(value) + "'", "DataValidator::OnObjectEnd");
+                                throw ParsingException("Invalid INTEGER value '" + std::to_string(value) + "'", "DataValidator::ValidateMeasurement");
                             }
                             break;
                         }
@@ -78,7 +95,7 @@ namespace qds_buffer {
                         case MeasurementType::kFloat: {
                             double value = boost::get<double>(data.value_);
                             if (value > std::numeric_limits<float>::max()) {
-                                throw ParsingException("Invalid FLOAT value '" + std::to_string(value) + "'", "DataValidator::OnObjectEnd");
+                                throw ParsingException("Invalid FLOAT value '" + std::to_string(value) + "'", "DataValidator::ValidateMeasurement");
                             }
                             break;
                         }
@@ -91,31 +108,17 @@ namespace qds_buffer {
                             break;
                         }
                         case MeasurementType::kWord: {
-                            std::string value = boost::get<std::string>(data.value_);
-                            if (value.size() != 4 || value.find_first_not_of("0123456789abcdefABCDEF") != std::string::npos) {
-                                throw ParsingException("Invalid WORD value '" + value + "'", "DataValidator::OnObjectEnd");
+                            const std::string& value = boost::get<std::string>(data.value_);
+                            if (!IsWord(value.data(), value.size())) {
+                                throw ParsingException("Invalid WORD value '" + value + "'", "DataValidator::ValidateMeasurement");
                             }
                             break;
                         }
                         case MeasurementType::kTimestamp: {
-                            std::string value = boost::get<std::string>(data.value_);
-
-                            // see https://stackoverflow.com/a/28022901
-                            static const std::regex iso_8601_regex(
-                                    "^(?:[1-9]\\d{3}(-?)(?:(?:0[1-9]|1[0-2])\\1(?:0[1-9]|1\\d|2[0-8])|(?:0[13-9]|1[0-2])\\1(?:29|30)"
-                                    "|(?:0[13578]|1[02])(?:\\1)31|00[1-9]|0[1-9]\\d|[12]\\d{2}|3(?:[0-5]\\d|6[0-5]))|(?:[1-9]\\d(?:0"
-                                    "[48]|[2468][048]|[13579][26])|(?:[2468][048]|[13579][26])00)(?:(-?)02(?:\\2)29|-?366))T(?:[01]"
-                                    "\\d|2[0-3])(:?)[0-5]\\d(?:\\3[0-5]\\d)?(\\.?\\d{1,6})?(?:Z|[+-][01]\\d(?:\\3[0-5]\\d)?)$");
-
-                            if (!std::regex_match(value, iso_8601_regex)) {
-                                throw ParsingException("Invalid TIMESTAMP value '" + value + "'", "DataValidator::OnObjectEnd");
+                            const std::string& value = boost::get<std::string>(data.value_);
+                            if (!IsIso8601Timestamp(value.data(), value.size())) {
+                                throw ParsingException("Invalid TIMESTAMP value '" + value + "'", "DataValidator::ValidateMeasurement");
                             }
-
-                            // follow API recommendation of moving timestamp entry to the front of the list;
-                            // note that 'data' will not be pointing to the correct entry anymore after this operation,
-                            // however, 'data' will not be accessed anymore, so it's not critical to update
-                            std::rotate(state.data_->begin(), state.data_->end()-1, state.data_->end());
-
                             break;
                         }
                         case MeasurementType::kRef: {
@@ -127,32 +130,41 @@ namespace qds_buffer {
                             break;
                         }
                         default: {
-                            throw ParsingException("Measurement has bad TYPE", "DataValidator::OnObjectEnd");
+                            throw ParsingException("Measurement has bad TYPE", "DataValidator::ValidateMeasurement");
                         }
                     }
                 } catch (const boost::bad_get&) {
-                    throw ParsingException("VALUE of '" + data.name_ + "' does not match its TYPE", "DataValidator::OnObjectEnd");
+                    throw ParsingException("VALUE of '" + data.name_ + "' does not match its TYPE", "DataValidator::ValidateMeasurement");
+                }
+            }
+
+            void DataValidator::OnObjectEnd(ParsingState& state) {
+                if (state.data_->empty() || state.current_element_completed_) {
+                    throw ParsingException("Invalid JSON", "DataValidator::OnObjectEnd");
+                }
+
+                ValidateMeasurement(state.data_->back());
+
+                if (state.data_->back().type_ == MeasurementType::kTimestamp) {
+                    // follow API recommendation of moving timestamp entry to the front of the list
+                    std::rotate(state.data_->begin(), state.data_->end()-1, state.data_->end());
                 }
 
                 state.current_element_completed_ = true;
             }
 
             void DataValidator::OnKey(ParsingState& state, const char* value, size_t len) {
-                static const ValidationStructure validation = BuildParseValidation();
-
                 if (state.data_->empty() || state.current_element_completed_) {
                     throw ParsingException("Entry '" + std::string(value, len) + "' is not an object", "DataValidator::OnKey");
                 }
 
-                for (auto& entry : validation) {
-                    if (strncmp(entry.first.c_str(), value, len) == 0) {
-                        state.has_key_ = true;
-                        state.validator_ = entry.second;
-                        return;
-                    }
+                ValidationFunction validator = FindValidator(value, len);
+                if (validator == nullptr) {
+                    throw ParsingException("Invalid key '" + std::string(value, len) + "'", "DataValidator::OnKey");
                 }
 
-                throw ParsingException("Invalid key '" + std::string(value, len) + "'", "DataValidator::OnKey");
+                state.has_key_ = true;
+                state.validator_ = validator;
             }
 
             void DataValidator::OnValue(ParsingState& state, ParserEvent event,
@@ -175,80 +187,98 @@ namespace qds_buffer {
                 state.validator_ = nullptr;
             }
 
-            ValidationStructure DataValidator::BuildParseValidation() {
-                return {
-                    ////////////////////////// NAME /////////////////////////////////
-                    {"NAME", [](ParserEvent event, Measurement& data, const char* value_as_string, size_t len, const void*) {
-                        if (event != ParserEvent::kOnString) {
-                            ThrowWrongTypeError("NAME", value_as_string, len, event, ParserEvent::kOnString);
-                        }
-                        if (!data.name_.empty()) {
-                            throw ParsingException("Duplicate NAME key", "DataValidator::BuildParseValidation");
-                        }
-                        data.name_ = std::string(value_as_string, len);
-                        return true;
-                    }},
-                    ////////////////////////// TYPE /////////////////////////////////
-                    {"TYPE", [](ParserEvent event, Measurement& data, const char* value_as_string, size_t len, const void*) {
-                        if (event != ParserEvent::kOnString) {
-                            ThrowWrongTypeError("TYPE", value_as_string, len, event, ParserEvent::kOnString);
-                        }
-                        if (data.type_ != MeasurementType::kNotSet) {
-                            throw ParsingException("Duplicate TYPE key", "DataValidator::BuildParseValidation");
-                        }
+            ValidationFunction DataValidator::FindValidator(const char* key, size_t len) {
+                switch (len) {
+                    case 4: {
+                        if (memcmp(key, "NAME", 4) == 0) return &ValidateName;
+                        if (memcmp(key, "TYPE", 4) == 0) return &ValidateType;
+                        if (memcmp(key, "UNIT", 4) == 0) return &ValidateUnit;
+                        break;
+                    }
+                    case 5: {
+                        if (memcmp(key, "VALUE", 5) == 0) return &ValidateValue;
+                        break;
+                    }
+                    case 8: {
+                        if (memcmp(key, "DECIMALS", 8) == 0) return &ValidateDecimals;
+                        break;
+                    }
+                    default: {}
+                }
+                return nullptr;
+            }
 
-                        data.SetTypeFromString(std::string(value_as_string, len));
-                        if (data.type_ == MeasurementType::kNotSet) {
-                            throw ParsingException("Invalid TYPE value '" + std::string(value_as_string, len) + "'",
-                                                "DataValidator::BuildParseValidation");
-                        }
-                    }},
-                    ////////////////////////// UNIT /////////////////////////////////
-                    {"UNIT", [](ParserEvent event, Measurement& data, const char* value_as_string, size_t len, const void*) {
-                        if (event != ParserEvent::kOnString) {
-                            ThrowWrongTypeError("UNIT", value_as_string, len, event, ParserEvent::kOnString);
-                        }
-                        if (!data.unit_.empty()) {
-                            throw ParsingException("Duplicate UNIT key", "DataValidator::BuildParseValidation");
-                        }
-                        data.unit_ = std::string(value_as_string, len);
-                    }},
-                    ////////////////////////// VALUE /////////////////////////////////
-                    {"VALUE", [](ParserEvent event, Measurement& data, const char*, size_t len, const void* value) {
-                        if (value == nullptr) {
-                            throw ParsingException("value is null", "DataValidator::BuildParseValidation");
-                        }
-                        if (typeid(boost::blank) != data.value_.type()) {
-                            throw ParsingException("Duplicate VALUE key", "DataValidator::BuildParseValidation");
-                        }
+            ////////////////////////// NAME /////////////////////////////////
+            void DataValidator::ValidateName(ParserEvent event, Measurement& data, const char* value_as_string, size_t len, const void*) {
+                if (event != ParserEvent::kOnString) {
+                    ThrowWrongTypeError("NAME", value_as_string, len, event, ParserEvent::kOnString);
+                }
+                if (!data.name_.empty()) {
+                    throw ParsingException("Duplicate NAME key", "DataValidator::ValidateName");
+                }
+                data.name_.assign(value_as_string, len);
+            }
 
-                        switch (event) {
-                            case ParserEvent::kOnString: {
-                                data.value_ = std::string(static_cast<const char*>(value), len);
-                                break;
-                            }
-                            case ParserEvent::kOnInt64:
-                            case ParserEvent::kOnUint64: {
-                                data.value_ = *static_cast<const std::int64_t*>(value); // note: currently no unsigned values are supported
-                                break;
-                            }
-                            case ParserEvent::kOnDouble: {
-                                data.value_ = *static_cast<const double*>(value);
-                                break;
-                            }
-                            case ParserEvent::kOnBool: {
-                                data.value_ = *static_cast<const bool*>(value);
-                                break;
-                            }
-                            default: {}
-                        }
-                    }},
-                    ////////////////////////// DECIMALS /////////////////////////////////
-                    {"DECIMALS", [](ParserEvent, Measurement&, const char*, size_t, const void*) {
-                        // legacy key set by VisionLine, ignore
-                        return true;
-                    }}
-                };
+            ////////////////////////// TYPE /////////////////////////////////
+            void DataValidator::ValidateType(ParserEvent event, Measurement& data, const char* value_as_string, size_t len, const void*) {
+                if (event != ParserEvent::kOnString) {
+                    ThrowWrongTypeError("TYPE", value_as_string, len, event, ParserEvent::kOnString);
+                }
+                if (data.type_ != MeasurementType::kNotSet) {
+                    throw ParsingException("Duplicate TYPE key", "DataValidator::ValidateType");
+                }
+
+                data.type_ = Measurement::TypeFromString(value_as_string, len);
+                if (data.type_ == MeasurementType::kNotSet) {
+                    throw ParsingException("Invalid TYPE value '" + std::string(value_as_string, len) + "'", "DataValidator::ValidateType");
+                }
+            }
+
+            ////////////////////////// UNIT /////////////////////////////////
+            void DataValidator::ValidateUnit(ParserEvent event, Measurement& data, const char* value_as_string, size_t len, const void*) {
+                if (event != ParserEvent::kOnString) {
+                    ThrowWrongTypeError("UNIT", value_as_string, len, event, ParserEvent::kOnString);
+                }
+                if (!data.unit_.empty()) {
+                    throw ParsingException("Duplicate UNIT key", "DataValidator::ValidateUnit");
+                }
+                data.unit_.assign(value_as_string, len);
+            }
+
+            ////////////////////////// VALUE /////////////////////////////////
+            void DataValidator::ValidateValue(ParserEvent event, Measurement& data, const char*, size_t len, const void* value) {
+                if (value == nullptr) {
+                    throw ParsingException("value is null", "DataValidator::ValidateValue");
+                }
+                if (typeid(boost::blank) != data.value_.type()) {
+                    throw ParsingException("Duplicate VALUE key", "DataValidator::ValidateValue");
+                }
+
+                switch (event) {
+                    case ParserEvent::kOnString: {
+                        data.value_ = std::string(static_cast<const char*>(value), len);
+                        break;
+                    }
+                    case ParserEvent::kOnInt64:
+                    case ParserEvent::kOnUint64: {
+                        data.value_ = *static_cast<const std::int64_t*>(value); // note: currently no unsigned values are supported
+                        break;
+                    }
+                    case ParserEvent::kOnDouble: {
+                        data.value_ = *static_cast<const double*>(value);
+                        break;
+                    }
+                    case ParserEvent::kOnBool: {
+                        data.value_ = *static_cast<const bool*>(value);
+                        break;
+                    }
+                    default: {}
+                }
+            }
+
+            ////////////////////////// DECIMALS /////////////////////////////////
+            void DataValidator::ValidateDecimals(ParserEvent, Measurement&, const char*, size_t, const void*) {
+                // legacy key set by VisionLine, ignore
             }
 
             void DataValidator::ThrowWrongTypeError(const std::string& key_name, const char* value, size_t len,
@@ -14,8 +14,7 @@ namespace qds_buffer {
       
       namespace parsing {
 
-         using ValidationFunction = std::function<void(ParserEvent, Measurement&, const char*, size_t, const void*)>;
-         using ValidationStructure = std::vector<std::pair<std::string, ValidationFunction>>;
+         using ValidationFunction = void (*)(ParserEvent, Measurement&, const char*, size_t, const void*);
 
          struct ParsingState {
             std::shared_ptr<std::vector<Measurement>> data_;
@@ -24,13 +23,31 @@ namespace qds_buffer {
             bool has_key_;
             bool current_element_completed_;
 
-            ParsingState() : data_(std::make_shared<std::vector<Measurement>>()), has_key_(false), current_element_completed_(false) {}
+            ParsingState() : data_(std::make_shared<std::vector<Measurement>>()), validator_(nullptr), has_key_(false), current_element_completed_(false) {}
+            // parses into the given (empty) vector, e.g. one that is reused
+            explicit ParsingState(std::shared_ptr<std::vector<Measurement>> data)
+                : data_(std::move(data)), validator_(nullptr), has_key_(false), current_element_completed_(false) {}
          };
 
          class DataValidator {
          public:
             static void ParserCallback(void* state, ParserEvent event, const char* value_as_string, size_t len, const void* value);
 
+            /*
+            * Validates a set of measurements that did not go through the parser, applying the same rules as for JSON
+            * input (required keys, TYPE/VALUE match, value ranges and formats), and moves TIMESTAMP measurements to the front
+            *
+            * @throws ParsingException
+            */
+            static void Validate(std::vector<Measurement>& data);
+
+            /*
+            * Validates a single, complete measurement
+            *
+            * @throws ParsingException
+            */
+            static void ValidateMeasurement(const Measurement& data);
+
          private:
             DataValidator();
             ~DataValidator();
@@ -40,7 +57,17 @@ namespace qds_buffer {
             static void OnKey(ParsingState& state, const char* value, size_t len);
             static void OnValue(ParsingState& state, ParserEvent event, const char* value_as_string, size_t len, const void* value);
 
-            static ValidationStructure BuildParseValidation();
+            /*
+            * Returns the validation function of a key or nullptr if the key is unknown;
+            * keys have to match exactly, the lookup is a switch over the key length and does not allocate
+            */
+            static ValidationFunction FindValidator(const char* key, size_t len);
+
+            static void ValidateName(ParserEvent event, Measurement& data, const char* value_as_string, size_t len, const void* value);
+            static void ValidateType(ParserEvent event, Measurement& data, const char* value_as_string, size_t len, const void* value);
+            static void ValidateUnit(ParserEvent event, Measurement& data, const char* value_as_string, size_t len, const void* value);
+            static void ValidateValue(ParserEvent event, Measurement& data, const char* value_as_string, size_t len, const void* value);
+            static void ValidateDecimals(ParserEvent event, Measurement& data, const char* value_as_string, size_t len, const void* value);
 
             static void ThrowWrongTypeError(const std::string& key_name, const char* value, size_t len,
                                              ParserEvent event_actual, ParserEvent event_expected);
@@ -203,6 +203,52 @@ TEST(DataValidatorTest, OnKey) {
     EXPECT_NE(nullptr, state.validator_);
 }
 
+TEST(DataValidatorTest, OnKeyExactMatch) {
+    ParsingState state;
+    DataValidator::ParserCallback(&state, ParserEvent::kOnObjectBegin, "", 0, nullptr);
+
+    // prefixes and extensions of valid keys are rejected
+    EXPECT_THROW(DataValidator::ParserCallback(&state, ParserEvent::kOnKey, TEST_STRING("NA"), nullptr), ParsingException); // Invalid key 'NA'
+    EXPECT_THROW(DataValidator::ParserCallback(&state, ParserEvent::kOnKey, TEST_STRING(""), nullptr), ParsingException); // Invalid key ''
+    EXPECT_THROW(DataValidator::ParserCallback(&state, ParserEvent::kOnKey, TEST_STRING("NAMES"), nullptr), ParsingException); // Invalid key 'NAMES'
+    EXPECT_THROW(DataValidator::ParserCallback(&state, ParserEvent::kOnKey, TEST_STRING("VALU"), nullptr), ParsingException); // Invalid key 'VALU'
+    EXPECT_THROW(DataValidator::ParserCallback(&state, ParserEvent::kOnKey, TEST_STRING("name"), nullptr), ParsingException); // Invalid key 'name'
+    EXPECT_FALSE(state.has_key_);
+
+    EXPECT_NO_THROW(DataValidator::ParserCallback(&state, ParserEvent::kOnKey, TEST_STRING("DECIMALS"), nullptr));
+    EXPECT_TRUE(state.has_key_);
+    EXPECT_NE(nullptr, state.validator_);
+}
+
+TEST(DataValidatorTest, TypeFromString) {
+    EXPECT_EQ(MeasurementType::kString, Measurement::TypeFromString(TEST_STRING("STRING")));
+    EXPECT_EQ(MeasurementType::kInteger, Measurement::TypeFromString(TEST_STRING("INTEGER")));
+    EXPECT_EQ(MeasurementType::kInteger, Measurement::TypeFromString(TEST_STRING("INT")));
+    EXPECT_EQ(MeasurementType::kFloat, Measurement::TypeFromString(TEST_STRING("FLOAT")));
+    EXPECT_EQ(MeasurementType::kLong, Measurement::TypeFromString(TEST_STRING("LONG")));
+    EXPECT_EQ(MeasurementType::kDouble, Measurement::TypeFromString(TEST_STRING("DOUBLE")));
+    EXPECT_EQ(MeasurementType::kBool, Measurement::TypeFromString(TEST_STRING("BOOL")));
+    EXPECT_EQ(MeasurementType::kWord, Measurement::TypeFromString(TEST_STRING("WORD")));
+    EXPECT_EQ(MeasurementType::kTimestamp, Measurement::TypeFromString(TEST_STRING("TIMESTAMP")));
+    EXPECT_EQ(MeasurementType::kRef, Measurement::TypeFromString(TEST_STRING("REF")));
+    EXPECT_EQ(MeasurementType::kForeignKey, Measurement::TypeFromString(TEST_STRING("FOREIGN_KEY")));
+
+    EXPECT_EQ(MeasurementType::kNotSet, Measurement::TypeFromString(TEST_STRING("")));
+    EXPECT_EQ(MeasurementType::kNotSet, Measurement::TypeFromString(TEST_STRING("IN")));
+    EXPECT_EQ(MeasurementType::kNotSet, Measurement::TypeFromString(TEST_STRING("INTEGERS")));
+    EXPECT_EQ(MeasurementType::kNotSet, Measurement::TypeFromString(TEST_STRING("RAF")));
+    EXPECT_EQ(MeasurementType::kNotSet, Measurement::TypeFromString(TEST_STRING("BOOK")));
+    EXPECT_EQ(MeasurementType::kNotSet, Measurement::TypeFromString(TEST_STRING("SOUBLE")));
+    EXPECT_EQ(MeasurementType::kNotSet, Measurement::TypeFromString(TEST_STRING("string")));
+
+    // round trip
+    Measurement data;
+    for (const char* type : {"STRING", "INTEGER", "FLOAT", "LONG", "DOUBLE", "BOOL", "WORD", "TIMESTAMP", "REF", "FOREIGN_KEY"}) {
+        data.SetTypeFromString(type);
+        EXPECT_EQ(type, data.TypeToString());
+    }
+}
+
 TEST(DataValidatorTest, OnValueInvalid) {
     ParsingState state;
     EXPECT_THROW(DataValidator::ParserCallback(&state, ParserEvent::kOnString, TEST_STRING("abcd"), nullptr), ParsingException); // Entry 'abcd' is not an object
@@ -398,3 +444,48 @@ TEST(DataValidatorTest, OnValueValue) {
     EXPECT_NO_THROW(DataValidator::ParserCallback(&state, ParserEvent::kOnBool, TEST_STRING("abcd"), &test_bool));
     EXPECT_EQ(test_bool, boost::get<bool>(state.data_->back().value_));
 }
+
+TEST(DataValidatorTest, Validate) {
+    auto make = [](const std::string& name, MeasurementType type, boost::variant<boost::blank, std::string, std::int64_t, double, bool> value) {
+        Measurement measurement;
+        measurement.name_ = name;
+        measurement.type_ = type;
+        measurement.value_ = value;
+        return measurement;
+    };
+
+    std::vector<Measurement> data = {
+        make("a", MeasurementType::kString, std::string("x")),
+        make("ts1", MeasurementType::kTimestamp, std::string("2019-02-18T13:29:43Z")),
+        make("b", MeasurementType::kInteger, std::int64_t(1)),
+        make("ts2", MeasurementType::kTimestamp, std::string("2019-02-18T13:29:44Z")),
+        make("c", MeasurementType::kBool, true),
+    };
+    EXPECT_NO_THROW(DataValidator::Validate(data));
+
+    // same order as produced by the parser
+    ASSERT_EQ(5, data.size());
+    EXPECT_EQ("ts2", data[0].name_);
+    EXPECT_EQ("ts1", data[1].name_);
+    EXPECT_EQ("a", data[2].name_);
+    EXPECT_EQ("b", data[3].name_);
+    EXPECT_EQ("c", data[4].name_);
+
+    std::vector<Measurement> invalid;
+    invalid = {make("", MeasurementType::kString, std::string("x"))};
+    EXPECT_THROW(DataValidator::Validate(invalid), ParsingException); // Measurement missing NAME
+    invalid = {make("a", MeasurementType::kNotSet, std::string("x"))};
+    EXPECT_THROW(DataValidator::Validate(invalid), ParsingException); // Measurement missing TYPE
+    invalid = {make("a", MeasurementType::kString, boost::blank())};
+    EXPECT_THROW(DataValidator::Validate(invalid), ParsingException); // Measurement missing VALUE
+    invalid = {make("a", MeasurementType::kString, std::int64_t(1))};
+    EXPECT_THROW(DataValidator::Validate(invalid), ParsingException); // VALUE of 'a' does not match its TYPE
+    invalid = {make("a", MeasurementType::kInteger, std::int64_t(std::numeric_limits<std::int32_t>::max()) + 1)};
+    EXPECT_THROW(DataValidator::Validate(invalid), ParsingException); // Invalid INTEGER value
+    invalid = {make("a", MeasurementType::kFloat, std::numeric_limits<double>::max())};
+    EXPECT_THROW(DataValidator::Validate(invalid), ParsingException); // Invalid FLOAT value
+    invalid = {make("a", MeasurementType::kWord, std::string("A5G9"))};
+    EXPECT_THROW(DataValidator::Validate(invalid), ParsingException); // Invalid WORD value
+    invalid = {make("a", MeasurementType::kTimestamp, std::string("2019-02-30T13:29:43Z"))};
+    EXPECT_THROW(DataValidator::Validate(invalid), ParsingException); // Invalid TIMESTAMP value
+}
@@ -0,0 +1,168 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#include "format_validation.hpp"
+
+#include <cstring>
+
+namespace qds_buffer {
+
+    namespace core {
+
+        namespace parsing {
+
+            namespace {
+
+                /*
+                * Lookup table with 1 for every hexadecimal digit and 0 for all other characters
+                */
+                struct HexTable {
+                    unsigned char is_hex_[256];
+
+                    HexTable() {
+                        memset(is_hex_, 0, sizeof(is_hex_));
+                        for (const char* c = "0123456789abcdefABCDEF"; *c; ++c) {
+                            is_hex_[static_cast<unsigned char>(*c)] = 1;
+                        }
+                    }
+                };
+
+                const HexTable kHexTable;
+
+                inline bool IsDigit(char c) {
+                    return c >= '0' && c <= '9';
+                }
+
+                /*
+                * Returns the value of two decimal digits or -1 if one of the characters is not a digit
+                */
+                inline int TwoDigits(const char* p) {
+                    return IsDigit(p[0]) && IsDigit(p[1]) ? (p[0] - '0') * 10 + (p[1] - '0') : -1;
+                }
+
+                inline bool IsLeapYear(int year) {
+                    return year % 4 == 0 && (year % 100 != 0 || year % 400 == 0);
+                }
+
+                bool IsValidMonthDay(int month, int day, bool leap_year) {
+                    static const int kDaysPerMonth[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+                    if (month < 1 || month > 12 || day < 1) return false;
+
+                    int max_day = kDaysPerMonth[month - 1] + (month == 2 && leap_year ? 1 : 0);
+                    return day <= max_day;
+                }
+
+                bool IsValidOrdinalDay(const char* p, bool leap_year) {
+                    if (!IsDigit(p[0]) || !IsDigit(p[1]) || !IsDigit(p[2])) return false;
+
+                    int day = (p[0] - '0') * 100 + (p[1] - '0') * 10 + (p[2] - '0');
+                    return day >= 1 && day <= (leap_year ? 366 : 365);
+                }
+
+                /*
+                * Date part (everything before 'T'): YYYY-MM-DD, YYYYMMDD, YYYY-DDD or YYYYDDD
+                */
+                bool IsValidDate(const char* p, size_t len) {
+                    if (len < 7) return false;
+                    if (p[0] < '1' || p[0] > '9' || !IsDigit(p[1]) || !IsDigit(p[2]) || !IsDigit(p[3])) return false;
+
+                    bool leap_year = IsLeapYear((p[0] - '0') * 1000 + (p[1] - '0') * 100 + (p[2] - '0') * 10 + (p[3] - '0'));
+
+                    switch (len) {
+                        case 10: {
+                            return p[4] == '-' && p[7] == '-' && IsValidMonthDay(TwoDigits(p + 5), TwoDigits(p + 8), leap_year);
+                        }
+                        case 8: {
+                            if (p[4] == '-') return IsValidOrdinalDay(p + 5, leap_year);
+                            return IsValidMonthDay(TwoDigits(p + 4), TwoDigits(p + 6), leap_year);
+                        }
+                        case 7: {
+                            return IsValidOrdinalDay(p + 4, leap_year);
+                        }
+                        default: {
+                            return false;
+                        }
+                    }
+                }
+
+                /*
+                * Optional fraction (1-6 digits, optional leading '.') followed by the zone, up to the end of the value
+                */
+                bool IsValidFractionAndZone(const char* p, const char* end, bool time_separator) {
+                    bool has_dot = p < end && *p == '.';
+                    if (has_dot) ++p;
+
+                    const char* digits = p;
+                    while (p < end && IsDigit(*p)) ++p;
+
+                    size_t digit_count = static_cast<size_t>(p - digits);
+                    if (digit_count > 6 || (has_dot && digit_count == 0)) return false;
+
+                    // zone
+                    if (p == end) return false;
+                    if (*p == 'Z') return p + 1 == end;
+                    if (*p != '+' && *p != '-') return false;
+                    ++p;
+
+                    if (end - p < 2 || (p[0] != '0' && p[0] != '1') || !IsDigit(p[1])) return false;
+                    p += 2;
+                    if (p == end) return true;
+
+                    if (time_separator) {
+                        if (*p != ':') return false;
+                        ++p;
+                    }
+                    int minutes = end - p == 2 ? TwoDigits(p) : -1;
+                    return minutes >= 0 && minutes <= 59;
+                }
+
+                /*
+                * Time part (everything after 'T'): hh[:]mm[[:]ss][fraction]zone
+                */
+                bool IsValidTime(const char* p, const char* end) {
+                    if (end - p < 4) return false;
+
+                    int hours = TwoDigits(p);
+                    if (hours < 0 || hours > 23) return false;
+                    p += 2;
+
+                    bool time_separator = *p == ':';
+                    if (time_separator) ++p;
+
+                    if (end - p < 2) return false;
+                    int minutes = TwoDigits(p);
+                    if (minutes < 0 || minutes > 59) return false;
+                    p += 2;
+
+                    // seconds are optional and the fraction does not require a '.', so both readings of the following
+                    // digits are valid candidates (e.g. "1230" + "45" as seconds or as fraction)
+                    const char* seconds = time_separator ? p + 1 : p;
+                    if (end - seconds >= 2 && (!time_separator || *p == ':')) {
+                        int value = TwoDigits(seconds);
+                        if (value >= 0 && value <= 59 && IsValidFractionAndZone(seconds + 2, end, time_separator)) {
+                            return true;
+                        }
+                    }
+                    return IsValidFractionAndZone(p, end, time_separator);
+                }
+            } // namespace
+
+            bool IsIso8601Timestamp(const char* value, size_t len) {
+                const char* time = static_cast<const char*>(memchr(value, 'T', len));
+                if (time == nullptr) return false;
+
+                return IsValidDate(value, static_cast<size_t>(time - value)) && IsValidTime(time + 1, value + len);
+            }
+
+            bool IsWord(const char* value, size_t len) {
+                if (len != 4) return false;
+
+                const unsigned char* v = reinterpret_cast<const unsigned char*>(value);
+                const unsigned char* table = kHexTable.is_hex_;
+                return (table[v[0]] & table[v[1]] & table[v[2]] & table[v[3]]) != 0;
+            }
+        } // namespace parsing
+    } // namespace core
+} // namespace qds_buffer
@@ -0,0 +1,34 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#pragma once
+
+#include <cstddef>
+
+namespace qds_buffer {
+
+    namespace core {
+
+        namespace parsing {
+
+            /*
+            * Checks whether the value is a valid ISO 8601 timestamp as accepted by QDS (TIMESTAMP data type).
+            *
+            * Single pass, no allocation; accepts exactly the language of the former regular expression
+            * (see https://stackoverflow.com/a/28022901):
+            * - date: YYYY-MM-DD, YYYYMMDD, YYYY-DDD or YYYYDDD (ordinal day), year 1000-9999, days checked per month,
+            *         February 29th and ordinal day 366 only in leap years
+            * - time: hh:mm[:ss] or hhmm[ss], followed by an optional fraction of 1-6 digits with an optional '.'
+            * - zone: Z, +hh, -hh, +hh:mm or +hhmm (zone separator has to match the time separator)
+            */
+            bool IsIso8601Timestamp(const char* value, size_t len);
+
+            /*
+            * Checks whether the value is a valid WORD (exactly 4 hexadecimal digits); branch-free table lookup
+            */
+            bool IsWord(const char* value, size_t len);
+
+        } // namespace parsing
+    } // namespace core
+} // namespace qds_buffer
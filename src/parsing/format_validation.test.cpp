@@ -0,0 +1,164 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <regex>
+
+#include "format_validation.hpp"
+
+using namespace qds_buffer::core::parsing;
+
+namespace {
+
+// former TIMESTAMP validation, kept as reference for the differential tests (see https://stackoverflow.com/a/28022901)
+bool IsIso8601TimestampRegex(const std::string& value) {
+    static const std::regex iso_8601_regex(
+            "^(?:[1-9]\\d{3}(-?)(?:(?:0[1-9]|1[0-2])\\1(?:0[1-9]|1\\d|2[0-8])|(?:0[13-9]|1[0-2])\\1(?:29|30)"
+            "|(?:0[13578]|1[02])(?:\\1)31|00[1-9]|0[1-9]\\d|[12]\\d{2}|3(?:[0-5]\\d|6[0-5]))|(?:[1-9]\\d(?:0"
+            "[48]|[2468][048]|[13579][26])|(?:[2468][048]|[13579][26])00)(?:(-?)02(?:\\2)29|-?366))T(?:[01]"
+            "\\d|2[0-3])(:?)[0-5]\\d(?:\\3[0-5]\\d)?(\\.?\\d{1,6})?(?:Z|[+-][01]\\d(?:\\3[0-5]\\d)?)$");
+
+    return std::regex_match(value, iso_8601_regex);
+}
+
+// former WORD validation
+bool IsWordReference(const std::string& value) {
+    return value.size() == 4 && value.find_first_not_of("0123456789abcdefABCDEF") == std::string::npos;
+}
+
+void ExpectSameTimestampResult(const std::string& value) {
+    EXPECT_EQ(IsIso8601TimestampRegex(value), IsIso8601Timestamp(value.data(), value.size())) << "Timestamp: '" << value << "'";
+}
+
+/*
+* Systematically combines date, time, fraction and zone variants (valid and invalid)
+*/
+std::vector<std::string> GenerateTimestampCorpus() {
+    const std::vector<std::string> years = {"0999", "1000", "1600", "1900", "1999", "2000", "2019", "2020", "2100", "2400", "9996", "9999"};
+    const std::vector<std::string> month_days = {"0101", "0100", "0001", "0228", "0229", "0230", "0331", "0431", "0430", "0631",
+                                                 "0731", "0831", "0931", "1031", "1130", "1131", "1231", "1232", "1301", "0132"};
+    const std::vector<std::string> ordinal_days = {"000", "001", "099", "100", "299", "300", "359", "360", "365", "366", "367", "400"};
+    const std::vector<std::string> times = {"1329", "132943", "0000", "2359", "235959", "2400", "1960", "196059", "132960", "1329430",
+                                            "13294", "132", ""};
+    const std::vector<std::string> fractions = {"", ".1", ".123456", ".1234567", "1", "123456", "1234567", ".", ".a"};
+    const std::vector<std::string> zones = {"Z", "+02", "-02", "+0200", "+02:00", "+1959", "+2000", "+0260", "+02:0", "+2", "ZZ", "", "z"};
+
+    std::vector<std::string> dates;
+    for (auto& year : years) {
+        for (auto& month_day : month_days) {
+            dates.push_back(year + month_day);
+            dates.push_back(year + "-" + month_day.substr(0, 2) + "-" + month_day.substr(2));
+            dates.push_back(year + "-" + month_day);
+            dates.push_back(year + month_day.substr(0, 2) + "-" + month_day.substr(2));
+        }
+        for (auto& ordinal_day : ordinal_days) {
+            dates.push_back(year + ordinal_day);
+            dates.push_back(year + "-" + ordinal_day);
+        }
+    }
+
+    std::vector<std::string> corpus;
+    for (auto& date : dates) {
+        for (auto& time : {"1329", "132943", "13:29", "13:29:43"}) {
+            corpus.push_back(date + "T" + time + "Z");
+        }
+    }
+    for (auto& time : times) {
+        std::vector<std::string> time_variants = {time};
+        if (time.size() >= 4) {
+            std::string with_separator = time.substr(0, 2) + ":" + time.substr(2, 2);
+            time_variants.push_back(with_separator + time.substr(4));
+            if (time.size() >= 6) time_variants.push_back(with_separator + ":" + time.substr(4));
+        }
+        for (auto& time_variant : time_variants) {
+            for (auto& fraction : fractions) {
+                for (auto& zone : zones) {
+                    corpus.push_back("2019-02-18T" + time_variant + fraction + zone);
+                    corpus.push_back("2020-366T" + time_variant + fraction + zone);
+                }
+            }
+        }
+    }
+    return corpus;
+}
+
+}  // namespace
+
+TEST(FormatValidationTest, TimestampTestVectors) {
+    // same test vectors as DataValidatorTest.OnObjectEndTimestamp
+    const std::vector<std::string> invalid_timestamps = {
+        "2019-02-18T13:29:43",       "800-02-18T13:29:43+02:00",  "2019-02-18T13:29:43Z+02:00", "2019-02-18T13:29:43+20:00",
+        "2019-02-18Z13:29:43+02:00", "2019-02-18-13:29:43+02:00", "2019-2-18T13:29:43+02:00",   "2019-02-18T24:29:43+02:00",
+        "2019-13-18T13:29:43+02:00", "2019-02-30T13:29:43+02:00", "2019-02-18T13:60:43+02:00",  "2019-02-18T13:29:60+02:00",
+        "2019-02-18T13:29:43+02:60", "2019-02-18T13-29-43+02:00", "2019:02:18T13:29:43+02:00",  "",
+        "T",                         "2019-02-18T",
+    };
+    const std::vector<std::string> valid_timestamps = {
+        "2019-02-18T13:29:43+02:00", "2019-02-18T13:29:43-02:00", "2019-02-18T13:29:43.123456+02:00", "2019-02-18T13:29:43.123+02:00",
+        "2019-02-18T13:29:43Z",      "20190218T132943-0200",      "20190218T132943Z",                 "2020-02-29T00:00Z",
+        "2020-366T00:00Z",           "2019-001T1329Z",            "2019-02-18T13:3045Z",              "2019-02-18T132975Z",
+    };
+
+    for (auto& ts : invalid_timestamps) {
+        EXPECT_FALSE(IsIso8601Timestamp(ts.data(), ts.size())) << "Timestamp: " << ts;
+        ExpectSameTimestampResult(ts);
+    }
+    for (auto& ts : valid_timestamps) {
+        EXPECT_TRUE(IsIso8601Timestamp(ts.data(), ts.size())) << "Timestamp: " << ts;
+        ExpectSameTimestampResult(ts);
+    }
+}
+
+TEST(FormatValidationTest, TimestampGeneratedCorpus) {
+    for (auto& ts : GenerateTimestampCorpus()) {
+        ExpectSameTimestampResult(ts);
+    }
+}
+
+TEST(FormatValidationTest, TimestampMutations) {
+    // random single and double character mutations of valid timestamps
+    const std::vector<std::string> seeds = {"2019-02-18T13:29:43.123456+02:00", "20190218T132943-0200", "2020-366T13:29Z", "2000-02-29T23:59:59Z"};
+    const std::string alphabet("0123456789-:.TZ+z \0", 19);
+
+    std::mt19937 random(4711);
+    for (int i = 0; i < 20000; i++) {
+        std::string ts = seeds[random() % seeds.size()];
+        for (int mutation = 0; mutation < 1 + static_cast<int>(random() % 2); mutation++) {
+            size_t position = random() % (ts.size() + 1);
+            char c = alphabet[random() % alphabet.size()];
+            switch (random() % 3) {
+                case 0: if (position < ts.size()) ts[position] = c; break;
+                case 1: ts.insert(ts.begin() + position, c); break;
+                default: if (position < ts.size()) ts.erase(position, 1); break;
+            }
+        }
+        ExpectSameTimestampResult(ts);
+    }
+}
+
+TEST(FormatValidationTest, Word) {
+    EXPECT_TRUE(IsWord("A5E9", 4));
+    EXPECT_TRUE(IsWord("0000", 4));
+    EXPECT_TRUE(IsWord("ffFF", 4));
+    EXPECT_FALSE(IsWord("A5E91", 5));
+    EXPECT_FALSE(IsWord("A5G9", 4));
+    EXPECT_FALSE(IsWord("A5E", 3));
+    EXPECT_FALSE(IsWord("", 0));
+    EXPECT_FALSE(IsWord("A5\0" "9", 4));
+
+    // differential test: every byte value at every position, and all lengths up to 6
+    for (int c = 0; c < 256; c++) {
+        for (size_t position = 0; position < 4; position++) {
+            std::string word = "0aF9";
+            word[position] = static_cast<char>(c);
+            EXPECT_EQ(IsWordReference(word), IsWord(word.data(), word.size())) << "Word: '" << word << "'";
+        }
+    }
+    for (size_t len = 0; len <= 6; len++) {
+        std::string word(len, 'a');
+        EXPECT_EQ(IsWordReference(word), IsWord(word.data(), word.size())) << "Word: '" << word << "'";
+    }
+}
@@ -11,7 +11,6 @@
 // This file must be manually included when
 // using basic_parser to implement a parser.
 #include <boost/json/basic_parser_impl.hpp>
-#include <boost/thread.hpp>
 
 
 namespace qds_buffer { 
@@ -31,8 +30,12 @@ namespace qds_buffer {
                 kOnBool
             };
 
-            using ParserCallback = std::function<void(void*, ParserEvent, const char*, size_t, const void*)>;
+            // plain function pointer, invoked for every parser event without std::function indirection
+            using ParserCallback = void (*)(void*, ParserEvent, const char*, size_t, const void*);
 
+            /**
+             * Not Thread-Safe; a parser keeps its own parsing state, use one instance per thread (see JsonParserPool)
+             */
             class JsonParser {
             public:
                 JsonParser(ParserCallback parser_callback)
@@ -43,8 +46,6 @@ namespace qds_buffer {
                 }
 
                 std::tuple<bool, std::string> Parse(boost::json::string_view string, void* state) {
-                    boost::unique_lock<boost::shared_mutex> lock(mutex_);
-
                     parser_.handler().set_state(state);
 
                     boost::json::error_code ec;
@@ -131,8 +132,8 @@ namespace qds_buffer {
                     bool on_null(boost::json::error_code&) { return false; }
 
                 private:
-                    void* state_;
-                    ParserCallback parser_callback_;
+                    void* state_ = nullptr;
+                    ParserCallback parser_callback_ = nullptr;
                 };
 
             private:
@@ -142,7 +143,6 @@ namespace qds_buffer {
                     return parse_options;
                 }
 
-                mutable boost::shared_mutex mutex_;
                 boost::json::basic_parser<handler> parser_;
                 ParserCallback parser_callback_;
             };
@@ -0,0 +1,82 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <boost/thread.hpp>
+
+#include "json_parser.hpp"
+
+namespace qds_buffer {
+
+    namespace core {
+
+        namespace parsing {
+
+            /**
+             * Thread-Safe
+             *
+             * Hands out idle JsonParser instances to concurrent callers, so that parsing is not serialized across producers.
+             * The pool mutex is only held while taking or returning a parser, never during the parse itself.
+             * New parsers are created on demand, the pool therefore grows to the maximum number of concurrent callers.
+             */
+            class JsonParserPool {
+            public:
+                JsonParserPool(ParserCallback parser_callback) : parser_callback_(parser_callback) {}
+
+                std::tuple<bool, std::string> Parse(boost::json::string_view string, void* state) {
+                    // the parser callback throws on invalid data, return the parser to the pool in any case
+                    // (JsonParser::Parse resets the parser before each use)
+                    ParserLease lease(*this);
+
+                    return lease.parser_->Parse(string, state);
+                }
+
+                size_t GetIdleCount() const {
+                    boost::lock_guard<boost::mutex> lock(mutex_);
+
+                    return idle_parsers_.size();
+                }
+
+            private:
+                struct ParserLease {
+                    ParserLease(JsonParserPool& pool) : pool_(pool), parser_(pool.Acquire()) {}
+                    ~ParserLease() { pool_.Release(std::move(parser_)); }
+
+                    JsonParserPool& pool_;
+                    std::unique_ptr<JsonParser> parser_;
+                };
+
+                std::unique_ptr<JsonParser> Acquire() {
+                    {
+                        boost::lock_guard<boost::mutex> lock(mutex_);
+
+                        if (!idle_parsers_.empty()) {
+                            std::unique_ptr<JsonParser> parser = std::move(idle_parsers_.back());
+                            idle_parsers_.pop_back();
+                            return parser;
+                        }
+                    }
+
+                    // no idle parser available, create a new one outside of the lock
+                    return std::unique_ptr<JsonParser>(new JsonParser(parser_callback_));
+                }
+
+                void Release(std::unique_ptr<JsonParser> parser) {
+                    boost::lock_guard<boost::mutex> lock(mutex_);
+
+                    idle_parsers_.push_back(std::move(parser));
+                }
+
+                ParserCallback parser_callback_;
+
+                mutable boost::mutex mutex_;
+                std::vector<std::unique_ptr<JsonParser>> idle_parsers_;
+            };
+        } // namespace parsing
+    } // namespace core
+} // namespace qds_buffer
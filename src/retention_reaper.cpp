@@ -0,0 +1,60 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#include "retention_reaper.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace qds_buffer {
+
+    namespace core {
+
+        RetentionReaper::RetentionReaper(uint32_t max_age_ms, ReapFunction reap_function)
+            : kMaxAgeMs_(max_age_ms),
+            kIntervalMs_(std::min<uint32_t>(std::max<uint32_t>(max_age_ms / 10, 10), 1000)),
+            reap_function_(reap_function),
+            stop_(false),
+            reaper_(&RetentionReaper::Run, this) {}
+
+        RetentionReaper::~RetentionReaper() {
+            {
+                boost::lock_guard<boost::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            stop_condition_.notify_one();
+            reaper_.join();
+        }
+
+        uint32_t RetentionReaper::GetMaxAgeMs() const {
+            return kMaxAgeMs_;
+        }
+
+        void RetentionReaper::Run() {
+            boost::unique_lock<boost::mutex> lock(mutex_);
+
+            while (!stop_condition_.timed_wait(lock, boost::posix_time::milliseconds(kIntervalMs_), [this]() { return stop_; })) {
+                lock.unlock();
+
+                uint64_t now_ms = GetCurrentTimeMs();
+                uint64_t cutoff_ms = now_ms > kMaxAgeMs_ ? now_ms - kMaxAgeMs_ : 0;
+                try {
+                    // a full batch means there might be more
+                    while (reap_function_(cutoff_ms, kBatchSize_) >= kBatchSize_) {
+                    }
+                } catch (...) {
+                    // try again on the next interval
+                }
+
+                lock.lock();
+            }
+        }
+
+        uint64_t RetentionReaper::GetCurrentTimeMs() {
+            // same clock as BufferEntry::timestamp_ms_
+            using namespace std::chrono;
+            return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+        }
+    } // namespace core
+} // namespace qds_buffer
@@ -0,0 +1,50 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+#include <boost/thread.hpp>
+
+namespace qds_buffer {
+
+    namespace core {
+
+        // deletes entries added before cutoff_ms (system clock), up to max_n per buffer; returns the number of deleted entries
+        using ReapFunction = std::function<size_t(uint64_t cutoff_ms, size_t max_n)>;
+
+        /**
+         * Thread-Safe
+         *
+         * Enforces a maximum age of the buffer entries: a background thread periodically calls the reap function for the
+         * entries older than the maximum age, in batches, so producers never do the work and the buffer lock is released
+         * between the batches.
+         */
+        class RetentionReaper {
+        public:
+            RetentionReaper(uint32_t max_age_ms, ReapFunction reap_function);
+            ~RetentionReaper();
+
+            uint32_t GetMaxAgeMs() const;
+
+        private:
+            void Run();
+
+            static uint64_t GetCurrentTimeMs();
+
+            const size_t kBatchSize_ = 256;
+            const uint32_t kMaxAgeMs_;
+            const uint32_t kIntervalMs_;   // entries are deleted at most this late
+
+            ReapFunction reap_function_;
+
+            bool stop_;
+            boost::mutex mutex_;
+            boost::condition_variable stop_condition_;
+            boost::thread reaper_;
+        };
+    } // namespace core
+} // namespace qds_buffer
@@ -0,0 +1,398 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#include <algorithm>
+#include <limits>
+
+#include <boost/container/deque.hpp>
+
+#include "benchmark.hpp"
+#include "ring_buffer.hpp"
+
+using namespace qds_buffer::core;
+using namespace qds_buffer::core::benchmark;
+
+namespace {
+
+const size_t kBufferSize = 100000;
+
+std::shared_ptr<std::vector<Measurement>> MakeMeasurements() {
+    return std::make_shared<std::vector<Measurement>>(1);
+}
+
+}  // namespace
+
+QDS_BENCHMARK(RingBuffer, DeleteMiddle) {
+    const int deletions = 1000;
+    {
+        // reference: former storage, erase from the middle of a deque
+        boost::container::deque<BufferEntry> buffer;
+        for (size_t i = 0; i < kBufferSize; i++) {
+            buffer.push_back(BufferEntry{static_cast<int64_t>(i), MakeMeasurements(), 0, false, 0, nullptr});
+        }
+
+        Stopwatch stopwatch;
+        for (int i = 0; i < deletions; i++) {
+            buffer.erase(buffer.begin() + static_cast<std::ptrdiff_t>(buffer.size() / 2));
+        }
+        Report("DeleteMiddle/100k", "deque erase (former)", stopwatch.ElapsedNs() / deletions / 1000, "us/delete");
+    }
+    {
+        SlotQueue<BufferEntry> buffer{kBufferSize};
+        for (size_t i = 0; i < kBufferSize; i++) {
+            buffer.push_back(BufferEntry{static_cast<int64_t>(i), MakeMeasurements(), 0, false, 0, nullptr});
+        }
+        // erase positions found up front, the lookup itself is not part of the storage cost
+        std::vector<SlotQueue<BufferEntry>::iterator> positions;
+        auto it = buffer.begin() + static_cast<std::ptrdiff_t>(kBufferSize / 2 - deletions);
+        for (int i = 0; i < deletions; i++, it += 2) {
+            positions.push_back(it);
+        }
+
+        Stopwatch stopwatch;
+        for (auto& position : positions) {
+            buffer.erase(position);
+        }
+        Report("DeleteMiddle/100k", "SlotQueue erase", stopwatch.ElapsedNs() / deletions / 1000, "us/delete");
+    }
+}
+
+QDS_BENCHMARK(RingBuffer, PushOverflow) {
+    RingBuffer buffer{kBufferSize, 0};
+    int64_t id = 0;
+    for (size_t i = 0; i < kBufferSize; i++) {
+        buffer.Push(id++, MakeMeasurements());
+    }
+
+    // every push evicts the oldest entry
+    const int iterations = 200000;
+    Stopwatch stopwatch;
+    for (int i = 0; i < iterations; i++) {
+        buffer.Push(id++, MakeMeasurements());
+    }
+    Report("PushOverflow/100k", "RingBuffer::Push", stopwatch.ElapsedNs() / iterations, "ns/push");
+}
+
+QDS_BENCHMARK(RingBuffer, DeleteById) {
+    RingBuffer buffer{kBufferSize, 0};
+    for (size_t i = 0; i < kBufferSize; i++) {
+        buffer.Push(static_cast<int64_t>(i), MakeMeasurements());
+    }
+
+    const int deletions = 10000;
+    Stopwatch stopwatch;
+    for (int i = 0; i < deletions; i++) {
+        buffer.Delete(static_cast<int64_t>(kBufferSize / 2 + i * 3));
+    }
+    Report("DeleteById/100k", "RingBuffer::Delete", stopwatch.ElapsedNs() / deletions, "ns/delete");
+}
+
+QDS_BENCHMARK(RingBuffer, CounterMode1Replace) {
+    RingBuffer buffer{kBufferSize, 1};
+    for (size_t i = 0; i < kBufferSize; i++) {
+        buffer.Push(static_cast<int64_t>(i), MakeMeasurements());
+    }
+
+    // replaces existing entries spread over the buffer
+    const int iterations = 100000;
+    Stopwatch stopwatch;
+    for (int i = 0; i < iterations; i++) {
+        buffer.Push(static_cast<int64_t>((i * 7919) % kBufferSize), MakeMeasurements());
+    }
+    Report("CounterMode1Replace/100k", "RingBuffer::Push", stopwatch.ElapsedNs() / iterations, "ns/push");
+}
+
+QDS_BENCHMARK(RingBuffer, PushOverflowLocked) {
+    // the oldest entries are locked by a slow consumer, every push has to evict an entry behind them
+    const size_t buffer_size = 10000;
+    const int iterations = 2000;
+
+    for (int locked_percent : {10, 50, 90}) {
+        const size_t locked_count = buffer_size * static_cast<size_t>(locked_percent) / 100;
+        const std::string benchmark = "PushOverflowLocked/" + std::to_string(locked_percent) + "%";
+        {
+            // reference: former eviction, scan from the front past all locked entries
+            boost::container::deque<BufferEntry> buffer;
+            int64_t id = 0;
+            for (size_t i = 0; i < buffer_size; i++) {
+                buffer.push_back(BufferEntry{id++, MakeMeasurements(), 0, i < locked_count, 0, nullptr});
+            }
+
+            Stopwatch stopwatch;
+            for (int i = 0; i < iterations; i++) {
+                auto it = buffer.begin();
+                while (it < buffer.end() && buffer.size() >= buffer_size) {
+                    if (!it->locked_) {
+                        it = buffer.erase(it);
+                    } else {
+                        ++it;
+                    }
+                }
+                buffer.push_back(BufferEntry{id++, MakeMeasurements(), 0, false, 0, nullptr});
+            }
+            Report(benchmark, "front scan (former)", stopwatch.ElapsedNs() / iterations, "ns/push");
+        }
+        {
+            RingBuffer buffer{buffer_size, 0};
+            int64_t id = 0;
+            for (size_t i = 0; i < buffer_size; i++) {
+                buffer.Push(id++, MakeMeasurements());
+            }
+            auto it = buffer.begin();
+            for (size_t i = 0; i < locked_count; i++, ++it) {
+                it->locked_ = true;
+            }
+
+            Stopwatch stopwatch;
+            for (int i = 0; i < iterations; i++) {
+                buffer.Push(id++, MakeMeasurements());
+            }
+            Report(benchmark, "RingBuffer::Push", stopwatch.ElapsedNs() / iterations, "ns/push");
+        }
+    }
+}
+
+QDS_BENCHMARK(RingBuffer, PushLatencyLocked) {
+    // half of the entries are locked, every push evicts behind them and leaves tombstones that have to be compacted
+    RingBuffer buffer{kBufferSize, 0};
+    int64_t id = 0;
+    for (size_t i = 0; i < kBufferSize; i++) {
+        buffer.Push(id++, MakeMeasurements());
+    }
+    auto it = buffer.begin();
+    for (size_t i = 0; i < kBufferSize / 2; i++, ++it) {
+        it->locked_ = true;
+    }
+
+    const int iterations = 200000;
+    std::vector<double> samples;
+    samples.reserve(iterations);
+    for (int i = 0; i < iterations; i++) {
+        Stopwatch stopwatch;
+        buffer.Push(id++, MakeMeasurements());
+        samples.push_back(stopwatch.ElapsedNs());
+    }
+    Report("PushLatencyLocked/100k 50% locked", "p50", Percentile(samples, 50), "ns");
+    Report("PushLatencyLocked/100k 50% locked", "p99.9", Percentile(samples, 99.9), "ns");
+    Report("PushLatencyLocked/100k 50% locked", "p99.99", Percentile(samples, 99.99), "ns");
+    Report("PushLatencyLocked/100k 50% locked", "max", Percentile(samples, 100), "ns");
+
+    // same pattern on the storage alone: entries moved by the compaction within a single push
+    SlotQueue<BufferEntry> queue{kBufferSize};
+    for (size_t i = 0; i < kBufferSize; i++) {
+        queue.push_back(BufferEntry{static_cast<int64_t>(i), MakeMeasurements(), 0, false, 0, nullptr});
+    }
+    size_t last_locked_slot = (queue.begin() + static_cast<std::ptrdiff_t>(kBufferSize / 2 - 1)).slot();
+    size_t max_moves = 0;
+    for (int i = 0; i < iterations; i++) {
+        queue.erase(++queue.from_slot(last_locked_slot));
+        size_t moves = 0;
+        queue.push_back(BufferEntry{id++, MakeMeasurements(), 0, false, 0, nullptr}, [&](BufferEntry&, size_t) { moves++; });
+        max_moves = std::max(max_moves, moves);
+    }
+    Report("PushLatencyLocked/100k 50% locked", "max entries moved by a push", static_cast<double>(max_moves), "entries");
+}
+
+QDS_BENCHMARK(RingBuffer, ClaimBatch) {
+    const size_t buffer_size = 10000;
+    const size_t batch_size = 100;
+    const size_t batches = buffer_size / batch_size;
+
+    for (bool use_claim_batch : {false, true}) {
+        RingBuffer buffer{buffer_size, 0};
+        for (size_t i = 0; i < buffer_size; i++) {
+            buffer.Push(static_cast<int64_t>(i), MakeMeasurements());
+        }
+
+        // claim the whole buffer batch by batch, nothing gets released in between
+        Stopwatch stopwatch;
+        for (size_t b = 0; b < batches; b++) {
+            if (use_claim_batch) {
+                buffer.ClaimBatch(batch_size);
+            } else {
+                // reference: former consumer pattern, iterate from the beginning and lock the first unlocked entries
+                boost::shared_lock<boost::shared_mutex> lock(buffer.GetSharedMutex());
+                size_t claimed = 0;
+                for (auto it = buffer.begin(); it != buffer.end() && claimed < batch_size; ++it) {
+                    if (!it->locked_) {
+                        it->locked_ = true;
+                        claimed++;
+                    }
+                }
+            }
+        }
+        Report("ClaimBatch/10k batch 100", use_claim_batch ? "ClaimBatch" : "iterate and lock (former)",
+               stopwatch.ElapsedNs() / batches / 1000, "us/batch");
+    }
+}
+
+QDS_BENCHMARK(RingBuffer, LeaseExpiry) {
+    const size_t buffer_size = 10000;
+    const int iterations = 1000;
+
+    for (bool use_wheel : {false, true}) {
+        RingBuffer buffer{buffer_size + 1, 0};
+        int64_t id = 0;
+        for (size_t i = 0; i < buffer_size; i++) {
+            buffer.Push(id++, MakeMeasurements());
+        }
+        // the whole buffer is leased (not yet expired), only a single slot is left for new data
+        buffer.ClaimBatch(buffer_size, 60000);
+        // reference: one deadline per entry, checked on every overflow
+        std::vector<uint64_t> deadlines(buffer_size, std::numeric_limits<uint64_t>::max());
+
+        Stopwatch stopwatch;
+        volatile size_t expired = 0;
+        for (int i = 0; i < iterations; i++) {
+            if (!use_wheel) {
+                size_t count = 0;
+                for (uint64_t deadline : deadlines) {
+                    count += deadline < static_cast<uint64_t>(i) ? 1 : 0;
+                }
+                expired = expired + count;
+            }
+            buffer.Push(id++, MakeMeasurements());
+        }
+        Report("LeaseExpiry/10k leased, push on overflow", use_wheel ? "timing wheel" : "scan all deadlines (reference)",
+               stopwatch.ElapsedNs() / iterations, "ns/push");
+    }
+}
+
+QDS_BENCHMARK(RingBuffer, ReadGroup) {
+    const size_t buffer_size = 10000;
+    const size_t batch_size = 100;
+    const size_t batches = buffer_size / batch_size;
+
+    for (bool use_group : {false, true}) {
+        RingBuffer buffer{buffer_size, 0};
+        for (size_t i = 0; i < buffer_size; i++) {
+            buffer.Push(static_cast<int64_t>(i), MakeMeasurements());
+        }
+        buffer.RegisterConsumerGroup("bench");
+
+        // read the whole buffer batch by batch, nothing gets deleted in between
+        Stopwatch stopwatch;
+        int64_t last_id = -1;
+        for (size_t b = 0; b < batches; b++) {
+            if (use_group) {
+                buffer.ReadGroup("bench", batch_size);
+            } else {
+                // reference: remember the last id and skip everything up to it from the beginning
+                boost::shared_lock<boost::shared_mutex> lock(buffer.GetSharedMutex());
+                std::vector<BufferEntry> entries;
+                for (auto it = buffer.begin(); it != buffer.end() && entries.size() < batch_size; ++it) {
+                    if (it->id_ > last_id) {
+                        entries.push_back(*it);
+                    }
+                }
+                last_id = entries.back().id_;
+            }
+        }
+        Report("ReadGroup/10k batch 100", use_group ? "ReadGroup" : "rescan from beginning (former)",
+               stopwatch.ElapsedNs() / batches / 1000, "us/batch");
+    }
+}
+
+QDS_BENCHMARK(RingBuffer, ReadSince) {
+    const int64_t buffer_size = 10000;
+    const size_t max_n = 100;
+    const int iterations = 1000;
+
+    for (bool use_read_since : {false, true}) {
+        RingBuffer buffer{static_cast<size_t>(buffer_size), 0};
+        for (int64_t id = 0; id < buffer_size; id++) {
+            buffer.Push(id, MakeMeasurements());
+        }
+        // the consumer's last id was deleted meanwhile, so it has to be searched
+        std::vector<int64_t> deleted;
+        for (int64_t id = 1; id < buffer_size; id += 2) deleted.push_back(id);
+        buffer.Delete(deleted);
+
+        Stopwatch stopwatch;
+        for (int i = 0; i < iterations; i++) {
+            int64_t last_id = (i * 997 % buffer_size) | 1;
+            if (use_read_since) {
+                buffer.ReadSince(last_id, max_n);
+            } else {
+                // reference: lock and iterate from the beginning
+                boost::shared_lock<boost::shared_mutex> lock(buffer.GetSharedMutex());
+                std::vector<DataSetHandle> handles;
+                for (auto it = buffer.begin(); it != buffer.end() && handles.size() < max_n; ++it) {
+                    if (it->id_ > last_id) {
+                        handles.push_back(DataSetHandle{it->id_, it->timestamp_ms_, it->measurements_, it->compact_});
+                    }
+                }
+            }
+        }
+        Report("ReadSince/5k entries max 100", use_read_since ? "ReadSince" : "iterate from beginning (former)",
+               stopwatch.ElapsedNs() / iterations / 1000, "us/read");
+    }
+}
+
+QDS_BENCHMARK(RingBuffer, ReadTimeRange) {
+    const size_t buffer_size = 10000;
+    const size_t max_n = 100;
+    const int iterations = 1000;
+
+    for (bool use_time_range : {false, true}) {
+        RingBuffer buffer{buffer_size, 0};
+        for (size_t i = 0; i < buffer_size; i++) {
+            buffer.Push(static_cast<int64_t>(i), MakeMeasurements());
+        }
+        // query the newest data sets, e.g. for a dashboard
+        uint64_t from_ms = buffer.Find(static_cast<int64_t>(buffer_size) - 1)->timestamp_ms_;
+        uint64_t to_ms = std::numeric_limits<uint64_t>::max();
+
+        Stopwatch stopwatch;
+        for (int i = 0; i < iterations; i++) {
+            if (use_time_range) {
+                buffer.ReadTimeRange(from_ms, to_ms, max_n);
+            } else {
+                // reference: locked scan over all entries
+                boost::shared_lock<boost::shared_mutex> lock(buffer.GetSharedMutex());
+                std::vector<DataSetHandle> handles;
+                for (auto it = buffer.begin(); it != buffer.end() && handles.size() < max_n; ++it) {
+                    if (it->timestamp_ms_ >= from_ms && it->timestamp_ms_ <= to_ms) {
+                        handles.push_back(DataSetHandle{it->id_, it->timestamp_ms_, it->measurements_, it->compact_});
+                    }
+                }
+            }
+        }
+        Report("ReadTimeRange/10k newest ms", use_time_range ? "ReadTimeRange" : "locked scan (former)",
+               stopwatch.ElapsedNs() / iterations / 1000, "us/query");
+    }
+}
+
+QDS_BENCHMARK(RingBuffer, EvictionPolicy) {
+    const size_t buffer_size = 10000;
+    const int64_t pushes = 200000;
+    const int64_t image_interval = 100;
+
+    // mostly small data sets, every 100th one carries an image
+    auto small = MakeMeasurements();
+    auto image = MakeMeasurements();
+    image->front().value_ = std::string(100000, 'x');
+
+    for (EvictionPolicy policy : {EvictionPolicy::OLDEST, EvictionPolicy::LARGEST, EvictionPolicy::PRIORITY}) {
+        RingBuffer buffer{buffer_size, 0, true, nullptr, nullptr, nullptr, policy};
+
+        Stopwatch stopwatch;
+        for (int64_t id = 0; id < pushes; id++) {
+            bool is_image = id % image_interval == 0;
+            buffer.Push(id, is_image ? image : small);
+            if (is_image && policy == EvictionPolicy::PRIORITY) {
+                buffer.SetPriority(id, -1);
+            }
+        }
+        double ns_per_push = stopwatch.ElapsedNs() / pushes;
+
+        size_t bytes = 0;
+        for (auto& entry : buffer) {
+            bytes += Measurement::ByteSize(*entry.measurements_);
+        }
+        const char* metric = policy == EvictionPolicy::OLDEST ? "oldest (former)" : policy == EvictionPolicy::LARGEST ? "largest" : "priority";
+        Report("EvictionPolicy/10k overflowing", std::string(metric) + " push", ns_per_push, "ns/push");
+        Report("EvictionPolicy/10k overflowing", std::string(metric) + " held", bytes / 1e6, "MB");
+    }
+}
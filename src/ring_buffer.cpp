@@ -4,7 +4,9 @@
 
 #include "ring_buffer.hpp"
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 
 #include <exception.hpp>
 
@@ -14,36 +16,164 @@ namespace qds_buffer {
     
     namespace core {
 
-        RingBuffer::RingBuffer(size_t size, int8_t counter_mode,  bool allow_overflow, OnDeleteCallbackType on_delete_callback)
+        const RingBuffer::EvictionKey RingBuffer::kFirstEvictionKey_{std::numeric_limits<int64_t>::min(), 0, 0};
+        const RingBuffer::EvictionKey RingBuffer::kLastEvictionKey_{std::numeric_limits<int64_t>::max(),
+                                                                    std::numeric_limits<uint64_t>::max(), 0};
+
+        RingBuffer::RingBuffer(size_t size, int8_t counter_mode,  bool allow_overflow, OnDeleteCallbackType on_delete_callback,
+                               std::shared_ptr<DataNotifier> notifier, OnDeleteBatchCallbackType on_delete_batch_callback,
+                               EvictionPolicy eviction_policy, EntrySizeFunctionType entry_size_function, size_t max_bytes,
+                               bool compact_data_sets)
             : kMaxSize_(size),
             kCounterMode_(counter_mode),
             kAllowOverflow_(allow_overflow),
-            on_delete_callback_(on_delete_callback) {}
+            kEvictionPolicy_(eviction_policy),
+            kMaxBytes_(max_bytes),
+            kCompactDataSets_(compact_data_sets),
+            buffer_(size),
+            bytes_(0),
+            scan_position_(ScanPosition::kEnd),
+            scan_id_(0),
+            releases_(0),
+            checked_releases_(0),
+            eviction_sequence_(0),
+            eviction_scan_key_(kFirstEvictionKey_),
+            eviction_checked_releases_(0),
+            entry_size_function_(entry_size_function),
+            lease_wheel_(GetLeaseTick(0)),
+            lease_counter_(0),
+            expired_leases_(0),
+            snapshot_builder_(std::max<size_t>(64, static_cast<size_t>(4 * std::sqrt(static_cast<double>(size))))),
+            snapshots_enabled_(false),
+            on_delete_callback_(on_delete_callback),
+            notifier_(notifier ? notifier : std::make_shared<DataNotifier>()),
+            on_delete_batch_callback_(on_delete_batch_callback) {
+
+            index_.reserve(size);
+        }
+
+        RingBuffer::WriteLock::WriteLock(RingBuffer& buffer) : buffer_(buffer), lock_(buffer.mutex_) {}
+
+        RingBuffer::WriteLock::~WriteLock() {
+            // keeps its capacity, so collecting the measurements doesn't allocate either
+            static thread_local std::vector<std::shared_ptr<std::vector<Measurement>>> released;
+            static thread_local std::vector<std::shared_ptr<const CompactDataSet>> released_compact;
+            released.swap(buffer_.released_);
+            released_compact.swap(buffer_.released_compact_);
+            // publish the new state before unlocking; the previous snapshot is released after unlocking like the measurements
+            BufferSnapshot previous;
+            if (buffer_.snapshot_builder_.IsModified()) {
+                previous = std::atomic_exchange(&buffer_.snapshot_, buffer_.snapshot_builder_.Publish());
+            }
+            lock_.unlock();
+            released.clear();
+            released_compact.clear();
+        }
 
         int RingBuffer::Push(int64_t id, std::shared_ptr<std::vector<Measurement>> measurement) {
-            boost::unique_lock<boost::shared_mutex> lock(mutex_);
+            auto compact = MakeCompact(*measurement);
+            int result;
+            {
+                WriteLock lock(*this);
+
+                result = PushLocked(id, measurement, compact);
+            }
+
+            // waiters can read the new entry right away
+            if (result >= 0) {
+                notifier_->Notify(id);
+            }
+            return result;
+        }
+
+        std::vector<PushResult> RingBuffer::PushBatch(
+                const std::vector<std::pair<int64_t, std::shared_ptr<std::vector<Measurement>>>>& entries) {
+            std::vector<PushResult> results;
+            results.reserve(entries.size());
+
+            // built before locking like in Push()
+            std::vector<std::shared_ptr<const CompactDataSet>> compacts;
+            compacts.reserve(entries.size());
+            for (auto& entry : entries) {
+                compacts.push_back(MakeCompact(*entry.second));
+            }
+
+            int64_t max_id = -1;
+            uint64_t count = 0;
+            {
+                WriteLock lock(*this);
+
+                for (size_t i = 0; i < entries.size(); i++) {
+                    auto& entry = entries[i];
+                    try {
+                        results.push_back(PushResult{PushLocked(entry.first, entry.second, compacts[i]), nullptr});
+                        if (results.back().deletion_count_ >= 0) {
+                            max_id = std::max(max_id, entry.first);
+                            count++;
+                        }
+                    } catch (...) {
+                        results.push_back(PushResult{-1, std::current_exception()});
+                    }
+                }
+            }
+
+            // a single wakeup for the whole batch
+            if (count > 0) {
+                notifier_->Notify(max_id, count);
+            }
+            return results;
+        }
+
+        std::shared_ptr<const CompactDataSet> RingBuffer::MakeCompact(const std::vector<Measurement>& measurement) const {
+            if (!kCompactDataSets_) return nullptr;
+            return std::make_shared<CompactDataSet>(measurement);
+        }
+
+        int RingBuffer::PushLocked(int64_t id, std::shared_ptr<std::vector<Measurement>> measurement,
+                                   std::shared_ptr<const CompactDataSet> compact) {
+            size_t bytes = sizeof(BufferEntry) + (entry_size_function_ ? entry_size_function_(id, *measurement)
+                                                                       : Measurement::ByteSize(*measurement));
+            if (compact) {
+                bytes += compact->ByteSize();
+            }
+            if (kMaxBytes_ > 0 && bytes > kMaxBytes_) {
+                throw RingBufferException("Entry exceeds the maximum memory usage of the buffer", "RingBuffer::Push");
+            }
+
             int deletion_counter = 0;
             // discard old unlocked data
-            if (buffer_.size() >= kMaxSize_) {
+            if (IsFull(bytes)) {
                 if (!kAllowOverflow_) {
                     throw RingBufferOverflowException();
                 }
 
-                auto it = buffer_.begin();
-                while (it < buffer_.end() && buffer_.size() >= kMaxSize_) {
-                    if (!it->locked_) {
+                // entries with an expired lease can be discarded again
+                ExpireLeases();
+
+                if (kEvictionPolicy_ != EvictionPolicy::OLDEST) {
+                    deletion_counter = EvictByIndexLocked(bytes);
+                } else {
+                    // continue behind the locked entries passed by previous evictions, each entry is passed only once
+                    auto it = GetScanStart();
+                    while (IsFull(bytes)) {
+                        while (it != buffer_.end() && it->locked_) {
+                            ++it;
+                        }
+                        if (it == buffer_.end()) {
+                            break;
+                        }
+
                         if (on_delete_callback_) {
                             on_delete_callback_(&(*it), false, GetCurrentTimeMs());
                         }
 
-                        it = buffer_.erase(it);
+                        it = EraseLocked(it);
                         deletion_counter++;
-                    } else {
-                        ++it;
                     }
+                    SetScanPosition(it);
                 }
 
-                if (buffer_.size() >= kMaxSize_) {
+                if (IsFull(bytes)) {
                     // all data is locked, can't add new data
                     
                     return -1;
@@ -57,50 +187,256 @@ namespace qds_buffer {
                 }
             } else {
                 // in CounterMode 1, check if we already have an entry
-                for (auto it = buffer_.begin(); it < buffer_.end(); ++it) {
-                    if (it->id_ == id) {
-                        // delete old entry if not yet locked
-                        if (!it->locked_) {
-                            if (on_delete_callback_) {
-                                on_delete_callback_(&*it, false, 0);
-                            }
-
-                            buffer_.erase(it);
-                            break;
-                        }
-                        // no action if entry was locked
+                auto it = Find(id);
+                if (it != buffer_.end()) {
+                    // no action if entry was locked
+                    if (it->locked_) {
                         return -1;
                     }
+
+                    // delete old entry if not yet locked
+                    if (on_delete_callback_) {
+                        on_delete_callback_(&*it, false, 0);
+                    }
+                    EraseLocked(it);
                 }
             }
 
-            buffer_.push_back(BufferEntry{id, measurement, GetCurrentTimeMs(), false});
+            // keep the timestamps ordered like the entries (for ReadTimeRange), even if the system clock is set back
+            uint64_t timestamp_ms = GetCurrentTimeMs();
+            if (!buffer_.empty() && buffer_.back().timestamp_ms_ > timestamp_ms) {
+                timestamp_ms = buffer_.back().timestamp_ms_;
+            }
+
+            auto it = buffer_.push_back(BufferEntry{id, measurement, timestamp_ms, false, bytes, compact},
+                                        [this](BufferEntry& entry, size_t slot) {
+                                            index_[entry.id_] = slot;
+                                            entry.locked_.Attach(&releases_);
+                                        });
+            it->locked_.Attach(&releases_);
+            index_[id] = it.slot();
+            if (kCounterMode_ != 0) {
+                ordered_ids_[id] = notifier_->NextSequence();
+            }
+            bytes_ += bytes;
+            if (kEvictionPolicy_ != EvictionPolicy::OLDEST) {
+                int64_t rank = kEvictionPolicy_ == EvictionPolicy::LARGEST ? -static_cast<int64_t>(bytes) : 0;
+                EvictionKey key{rank, eviction_sequence_++, id};
+                eviction_index_.insert(key);
+                eviction_keys_[id] = key;
+                LowerEvictionScanKey(key);
+            }
+            if (snapshots_enabled_.load(std::memory_order_relaxed)) {
+                snapshot_builder_.Append(*it);
+            }
+            if (scan_position_ == ScanPosition::kEnd) {
+                SetScanPosition(it);
+            }
+            for (auto& group : groups_) {
+                if (group.second.cursor_ == ScanPosition::kEnd) {
+                    group.second.cursor_ = ScanPosition::kEntry;
+                    group.second.cursor_id_ = id;
+                }
+            }
             return deletion_counter;
         }
 
         void RingBuffer::Delete(int64_t id) {
-            boost::unique_lock<boost::shared_mutex> lock(mutex_);
-
-            for (auto it = buffer_.begin(); it < buffer_.end(); ++it) {
-                if (it->id_ == id) {
-                    if (on_delete_callback_) {
-                        on_delete_callback_(&*it, false, 0);
-                    }
+            WriteLock lock(*this);
 
-                    buffer_.erase(it);
-                    return;
-                } else if (kCounterMode_ == 0 && it->id_ > id) {
-                    // in CounterMode 0, buffer entries are sorted, so we can stop iteration here
-                    break;
+            auto it = Find(id);
+            if (it != buffer_.end()) {
+                if (on_delete_callback_) {
+                    on_delete_callback_(&*it, false, 0);
                 }
+
+                EraseLocked(it);
             }
 
             // not found, but treat as success
         }
 
+        size_t RingBuffer::Delete(const std::vector<int64_t>& ids) {
+            // the same id might be given more than once
+            std::vector<int64_t> unique_ids(ids);
+            std::sort(unique_ids.begin(), unique_ids.end());
+            unique_ids.erase(std::unique(unique_ids.begin(), unique_ids.end()), unique_ids.end());
+
+            WriteLock lock(*this);
+
+            std::vector<BufferQueueType::iterator> entries;
+            entries.reserve(unique_ids.size());
+            for (int64_t id : unique_ids) {
+                auto it = Find(id);
+                if (it != buffer_.end()) {
+                    entries.push_back(it);
+                }
+            }
+
+            return EraseBatchLocked(entries, 0);
+        }
+
+        size_t RingBuffer::DeleteUpTo(int64_t id) {
+            if (kCounterMode_ != 0) {
+                throw RingBufferException("DeleteUpTo requires counter mode 0", "RingBuffer::DeleteUpTo");
+            }
+
+            WriteLock lock(*this);
+
+            // ids are increasing
+            std::vector<BufferQueueType::iterator> entries;
+            for (auto it = buffer_.begin(); it != buffer_.end() && it->id_ <= id; ++it) {
+                entries.push_back(it);
+            }
+
+            return EraseBatchLocked(entries, 0);
+        }
+
+        size_t RingBuffer::DeleteOlderThan(uint64_t cutoff_ms, size_t max_n) {
+            WriteLock lock(*this);
+
+            // timestamps never decrease in buffer order
+            std::vector<BufferQueueType::iterator> entries;
+            for (auto it = buffer_.begin(); it != buffer_.end() && it->timestamp_ms_ < cutoff_ms && entries.size() < max_n; ++it) {
+                if (!it->locked_) {
+                    entries.push_back(it);
+                }
+            }
+
+            return EraseBatchLocked(entries, GetCurrentTimeMs());
+        }
+
+        size_t RingBuffer::EraseBatchLocked(const std::vector<BufferQueueType::iterator>& entries, uint64_t deletion_time_ms) {
+            if (entries.empty()) return 0;
+
+            if (on_delete_batch_callback_) {
+                std::vector<const BufferEntry*> deleted;
+                deleted.reserve(entries.size());
+                for (auto& it : entries) {
+                    deleted.push_back(&*it);
+                }
+                on_delete_batch_callback_(deleted, deletion_time_ms);
+            } else if (on_delete_callback_) {
+                for (auto& it : entries) {
+                    on_delete_callback_(&*it, false, deletion_time_ms);
+                }
+            }
+
+            // erasing doesn't invalidate the iterators of the other entries
+            for (auto& it : entries) {
+                EraseLocked(it);
+            }
+            return entries.size();
+        }
+
+        int RingBuffer::EvictByIndexLocked(size_t bytes) {
+            int deletion_counter = 0;
+            uint64_t releases = releases_.load();
+            if (releases != eviction_checked_releases_) {
+                // entries passed as locked may have been unlocked in the meantime
+                eviction_checked_releases_ = releases;
+                eviction_scan_key_ = kFirstEvictionKey_;
+            }
+
+            // continue behind the locked entries passed by previous evictions, each entry is passed only once
+            auto key = eviction_index_.lower_bound(eviction_scan_key_);
+            while (IsFull(bytes) && key != eviction_index_.end()) {
+                auto it = Find(key->id_);
+                // erasing the entry removes its key
+                ++key;
+                if (it->locked_) {
+                    continue;
+                }
+
+                if (on_delete_callback_) {
+                    on_delete_callback_(&(*it), false, GetCurrentTimeMs());
+                }
+
+                EraseLocked(it);
+                deletion_counter++;
+            }
+            eviction_scan_key_ = key != eviction_index_.end() ? *key : kLastEvictionKey_;
+            return deletion_counter;
+        }
+
+        bool RingBuffer::IsFull(size_t bytes) const {
+            return buffer_.size() >= kMaxSize_ || (kMaxBytes_ > 0 && bytes_ + bytes > kMaxBytes_);
+        }
+
+        BufferQueueType::iterator RingBuffer::EraseLocked(BufferQueueType::iterator it) {
+            bool is_scan_position = scan_position_ == ScanPosition::kEntry && it->id_ == scan_id_;
+
+            index_.erase(it->id_);
+            if (kCounterMode_ != 0) {
+                ordered_ids_.erase(it->id_);
+            }
+            if (!leases_.empty()) {
+                leases_.erase(it->id_);
+            }
+            bytes_ -= it->bytes_;
+            released_.push_back(std::move(it->measurements_));
+            released_compact_.push_back(std::move(it->compact_));
+            if (kEvictionPolicy_ != EvictionPolicy::OLDEST) {
+                auto key = eviction_keys_.find(it->id_);
+                eviction_index_.erase(key->second);
+                eviction_keys_.erase(key);
+            }
+            int64_t id = it->id_;
+            if (snapshots_enabled_.load(std::memory_order_relaxed)) {
+                snapshot_builder_.Erase(id);
+            }
+            auto next = buffer_.erase(it);
+            if (is_scan_position) {
+                SetScanPosition(next);
+            }
+
+            for (auto& group : groups_) {
+                ConsumerGroup& consumer_group = group.second;
+                if (consumer_group.cursor_ == ScanPosition::kEntry && consumer_group.cursor_id_ == id) {
+                    consumer_group.cursor_ = next != buffer_.end() ? ScanPosition::kEntry : ScanPosition::kEnd;
+                    consumer_group.cursor_id_ = next != buffer_.end() ? next->id_ : 0;
+                }
+                if (!acknowledgements_.empty()) {
+                    consumer_group.acknowledged_.erase(id);
+                }
+            }
+            if (!acknowledgements_.empty()) {
+                acknowledgements_.erase(id);
+            }
+            return next;
+        }
+
+        void RingBuffer::LowerEvictionScanKey(const EvictionKey& key) {
+            // a new key in front of the scan key wasn't passed yet
+            if (key < eviction_scan_key_) {
+                eviction_scan_key_ = key;
+            }
+        }
+
+        BufferQueueType::iterator RingBuffer::GetScanStart() {
+            uint64_t releases = releases_.load();
+            if (releases != checked_releases_) {
+                // entries passed as locked may have been unlocked in the meantime
+                checked_releases_ = releases;
+                return buffer_.begin();
+            }
+
+            return scan_position_ == ScanPosition::kEntry ? Find(scan_id_) : buffer_.end();
+        }
+
+        void RingBuffer::SetScanPosition(BufferQueueType::iterator it) {
+            if (it == buffer_.end()) {
+                scan_position_ = ScanPosition::kEnd;
+            } else {
+                scan_position_ = ScanPosition::kEntry;
+                scan_id_ = it->id_;
+            }
+        }
+
         ResetInformation RingBuffer::Reset(ResetReason reason) {
-            std::unique_lock<boost::shared_mutex> lock(mutex_);
+            WriteLock lock(*this);
 
+            notifier_->Reset();
             if (buffer_.empty()) return {0, ResetReason::UNKNOWN, 0, 0, 0};
 
             if (on_delete_callback_) {
@@ -112,11 +448,48 @@ namespace qds_buffer {
             uint64_t newest_dataset_time_ms = buffer_.back().timestamp_ms_;
             uint32_t deleted_datasets_count = static_cast<uint32_t>(buffer_.size());
 
+            for (auto& entry : buffer_) {
+                released_.push_back(std::move(entry.measurements_));
+                released_compact_.push_back(std::move(entry.compact_));
+            }
             buffer_.clear();
+            index_.clear();
+            ordered_ids_.clear();
+            bytes_ = 0;
+            eviction_index_.clear();
+            eviction_keys_.clear();
+            eviction_scan_key_ = kFirstEvictionKey_;
+            leases_.clear();
+            lease_wheel_.Clear();
+            acknowledgements_.clear();
+            for (auto& group : groups_) {
+                group.second.cursor_ = ScanPosition::kEnd;
+                group.second.acknowledged_.clear();
+            }
+            scan_position_ = ScanPosition::kEnd;
+            if (snapshots_enabled_.load(std::memory_order_relaxed)) {
+                snapshot_builder_.Clear();
+            }
 
             return {reset_time_ms, reason, oldest_dataset_time_ms, newest_dataset_time_ms, deleted_datasets_count};
         }
 
+        bool RingBuffer::SetPriority(int64_t id, int32_t priority) {
+            boost::unique_lock<boost::shared_mutex> lock(mutex_);
+
+            if (index_.find(id) == index_.end()) {
+                return false;
+            }
+            if (kEvictionPolicy_ == EvictionPolicy::PRIORITY) {
+                EvictionKey& key = eviction_keys_[id];
+                eviction_index_.erase(key);
+                key.rank_ = priority;
+                eviction_index_.insert(key);
+                LowerEvictionScanKey(key);
+            }
+            return true;
+        }
+
         boost::shared_mutex& RingBuffer::GetSharedMutex() const {
             return mutex_;
         }
@@ -131,6 +504,307 @@ namespace qds_buffer {
             return buffer_.end();
         }
 
+        BufferQueueType::iterator RingBuffer::Find(int64_t id) {
+            // must lock mutex via GetSharedMutex() before calling Find()
+            auto it = index_.find(id);
+            return it != index_.end() ? buffer_.from_slot(it->second) : buffer_.end();
+        }
+
+        BufferSnapshot RingBuffer::GetSnapshot() const {
+            // the writers publish a new snapshot on every modification once the first one was requested
+            if (!snapshots_enabled_.load(std::memory_order_acquire)) {
+                boost::unique_lock<boost::shared_mutex> lock(mutex_);
+                if (!snapshots_enabled_.load(std::memory_order_relaxed)) {
+                    for (auto& entry : buffer_) {
+                        snapshot_builder_.Append(entry);
+                    }
+                    std::atomic_store(&snapshot_, snapshot_builder_.Publish());
+                    snapshots_enabled_.store(true, std::memory_order_release);
+                }
+            }
+            return std::atomic_load(&snapshot_);
+        }
+
+        std::vector<BufferEntry> RingBuffer::ClaimBatch(size_t max_n, uint32_t lease_ms, int64_t max_id) {
+            std::vector<BufferEntry> claimed;
+
+            boost::shared_lock<boost::shared_mutex> lock(mutex_);
+            boost::lock_guard<boost::mutex> claim_lock(claim_mutex_);
+
+            ExpireLeases();
+
+            auto it = GetScanStart();
+            auto first_unlocked = buffer_.end();
+            while (it != buffer_.end() && claimed.size() < max_n) {
+                if (it->id_ <= max_id && it->locked_.TryLock()) {
+                    claimed.push_back(*it);
+                } else if (!it->locked_ && first_unlocked == buffer_.end()) {
+                    first_unlocked = it;
+                    if (kCounterMode_ == 0 && it->id_ > max_id) {
+                        // ids are increasing
+                        break;
+                    }
+                }
+                ++it;
+            }
+            SetScanPosition(first_unlocked != buffer_.end() ? first_unlocked : it);
+
+            if (lease_ms > 0 && !claimed.empty()) {
+                // round up, a lease never expires early
+                uint64_t deadline_tick = GetLeaseTick(lease_ms + kLeaseTickMs_ - 1);
+
+                boost::lock_guard<boost::mutex> lease_lock(lease_mutex_);
+                for (auto& entry : claimed) {
+                    uint64_t lease = ++lease_counter_;
+                    leases_[entry.id_] = lease;
+                    lease_wheel_.Schedule(deadline_tick, Lease{entry.id_, lease});
+                }
+            }
+
+            return claimed;
+        }
+
+        std::vector<DataSetHandle> RingBuffer::ReadSince(int64_t last_id, size_t max_n) {
+            std::vector<DataSetHandle> handles;
+
+            boost::shared_lock<boost::shared_mutex> lock(mutex_);
+
+            if (kCounterMode_ == 0) {
+                // ids are increasing, the entry following last_id is usually the one behind it
+                auto it = Find(last_id);
+                if (it != buffer_.end()) {
+                    ++it;
+                } else {
+                    it = buffer_.partition_point([last_id](const BufferEntry& entry) { return entry.id_ <= last_id; });
+                }
+                for (; it != buffer_.end() && handles.size() < max_n; ++it) {
+                    handles.push_back(DataSetHandle{it->id_, it->timestamp_ms_, it->measurements_, it->compact_});
+                }
+            } else {
+                for (auto id = ordered_ids_.upper_bound(last_id); id != ordered_ids_.end() && handles.size() < max_n; ++id) {
+                    auto it = Find(id->first);
+                    handles.push_back(DataSetHandle{it->id_, it->timestamp_ms_, it->measurements_, it->compact_});
+                }
+            }
+            return handles;
+        }
+
+        std::vector<DataSetHandle> RingBuffer::ReadTimeRange(uint64_t from_ms, uint64_t to_ms, size_t max_n) {
+            std::vector<DataSetHandle> handles;
+
+            boost::shared_lock<boost::shared_mutex> lock(mutex_);
+
+            // timestamps never decrease in buffer order (see PushLocked)
+            auto it = buffer_.partition_point([from_ms](const BufferEntry& entry) { return entry.timestamp_ms_ < from_ms; });
+            for (; it != buffer_.end() && it->timestamp_ms_ <= to_ms && handles.size() < max_n; ++it) {
+                handles.push_back(DataSetHandle{it->id_, it->timestamp_ms_, it->measurements_, it->compact_});
+            }
+            return handles;
+        }
+
+        std::vector<int64_t> RingBuffer::PeekUnlocked(size_t max_n) {
+            std::vector<int64_t> ids;
+
+            boost::shared_lock<boost::shared_mutex> lock(mutex_);
+            boost::lock_guard<boost::mutex> claim_lock(claim_mutex_);
+
+            ExpireLeases();
+
+            auto it = GetScanStart();
+            while (it != buffer_.end() && it->locked_) {
+                ++it;
+            }
+            SetScanPosition(it);
+
+            for (; it != buffer_.end() && ids.size() < max_n; ++it) {
+                if (!it->locked_) {
+                    ids.push_back(it->id_);
+                }
+            }
+            return ids;
+        }
+
+        size_t RingBuffer::Release(const std::vector<int64_t>& ids) {
+            size_t released = 0;
+
+            boost::shared_lock<boost::shared_mutex> lock(mutex_);
+            boost::lock_guard<boost::mutex> lease_lock(lease_mutex_);
+
+            for (int64_t id : ids) {
+                auto it = Find(id);
+                if (it != buffer_.end() && it->locked_.Unlock()) {
+                    released++;
+                }
+                if (!leases_.empty()) {
+                    leases_.erase(id);
+                }
+            }
+            return released;
+        }
+
+        void RingBuffer::ExpireLeases() {
+            boost::lock_guard<boost::mutex> lease_lock(lease_mutex_);
+
+            lease_wheel_.Advance(GetLeaseTick(0), [this](const Lease& lease) {
+                auto it = leases_.find(lease.id_);
+                if (it == leases_.end() || it->second != lease.lease_) {
+                    // released, deleted or claimed again in the meantime
+                    return;
+                }
+                leases_.erase(it);
+
+                auto entry = Find(lease.id_);
+                if (entry != buffer_.end() && entry->locked_.Unlock()) {
+                    expired_leases_++;
+                }
+            });
+        }
+
+        uint64_t RingBuffer::GetExpiredLeaseCount() const {
+            return expired_leases_.load();
+        }
+
+        bool RingBuffer::WaitForNewData(int64_t after_id, uint32_t timeout_ms) {
+            if (kCounterMode_ == 0) {
+                return notifier_->Wait(after_id, timeout_ms);
+            }
+
+            // counter mode 1: the ids are not ordered, wait for an entry added after the one with after_id
+            uint64_t sequence;
+            {
+                boost::shared_lock<boost::shared_mutex> lock(mutex_);
+
+                if (!GetSequenceLocked(after_id, sequence)) {
+                    // the consumer doesn't know the current entries
+                    if (!buffer_.empty()) return true;
+                    sequence = notifier_->GetSequence();
+                }
+            }
+            return notifier_->WaitForSequence(sequence, timeout_ms);
+        }
+
+        bool RingBuffer::GetSequence(int64_t id, uint64_t& sequence) const {
+            boost::shared_lock<boost::shared_mutex> lock(mutex_);
+
+            return GetSequenceLocked(id, sequence);
+        }
+
+        bool RingBuffer::GetSequenceLocked(int64_t id, uint64_t& sequence) const {
+            auto it = ordered_ids_.find(id);
+            if (it == ordered_ids_.end()) {
+                return false;
+            }
+            sequence = it->second;
+            return true;
+        }
+
+        void RingBuffer::RegisterConsumerGroup(const std::string& group) {
+            boost::unique_lock<boost::shared_mutex> lock(mutex_);
+
+            if (groups_.count(group) == 0) {
+                ConsumerGroup& consumer_group = groups_[group];
+                consumer_group.cursor_ = buffer_.empty() ? ScanPosition::kEnd : ScanPosition::kEntry;
+                consumer_group.cursor_id_ = buffer_.empty() ? 0 : buffer_.front().id_;
+            }
+        }
+
+        void RingBuffer::UnregisterConsumerGroup(const std::string& group) {
+            WriteLock lock(*this);
+
+            auto group_it = groups_.find(group);
+            if (group_it == groups_.end()) return;
+
+            for (int64_t id : group_it->second.acknowledged_) {
+                acknowledgements_[id]--;
+            }
+            groups_.erase(group_it);
+
+            if (groups_.empty()) {
+                acknowledgements_.clear();
+                return;
+            }
+
+            // the removed group might have been the last one missing
+            std::vector<int64_t> ids;
+            for (auto& acknowledgement : acknowledgements_) {
+                if (acknowledgement.second >= groups_.size()) {
+                    ids.push_back(acknowledgement.first);
+                }
+            }
+            for (int64_t id : ids) {
+                auto it = Find(id);
+                if (it != buffer_.end()) {
+                    DeleteAcknowledged(it);
+                }
+            }
+        }
+
+        std::vector<BufferEntry> RingBuffer::ReadGroup(const std::string& group, size_t max_n, int64_t max_id) {
+            std::vector<BufferEntry> entries;
+
+            boost::shared_lock<boost::shared_mutex> lock(mutex_);
+            boost::lock_guard<boost::mutex> groups_lock(groups_mutex_);
+
+            ConsumerGroup& consumer_group = GetConsumerGroup(group, "RingBuffer::ReadGroup");
+            auto it = consumer_group.cursor_ == ScanPosition::kEntry ? Find(consumer_group.cursor_id_) : buffer_.end();
+            for (; it != buffer_.end() && entries.size() < max_n && it->id_ <= max_id; ++it) {
+                entries.push_back(*it);
+            }
+
+            consumer_group.cursor_ = it != buffer_.end() ? ScanPosition::kEntry : ScanPosition::kEnd;
+            consumer_group.cursor_id_ = it != buffer_.end() ? it->id_ : 0;
+            return entries;
+        }
+
+        std::vector<int64_t> RingBuffer::PeekGroup(const std::string& group, size_t max_n) {
+            std::vector<int64_t> ids;
+
+            boost::shared_lock<boost::shared_mutex> lock(mutex_);
+            boost::lock_guard<boost::mutex> groups_lock(groups_mutex_);
+
+            ConsumerGroup& consumer_group = GetConsumerGroup(group, "RingBuffer::PeekGroup");
+            auto it = consumer_group.cursor_ == ScanPosition::kEntry ? Find(consumer_group.cursor_id_) : buffer_.end();
+            for (; it != buffer_.end() && ids.size() < max_n; ++it) {
+                ids.push_back(it->id_);
+            }
+            return ids;
+        }
+
+        size_t RingBuffer::AcknowledgeGroup(const std::string& group, const std::vector<int64_t>& ids) {
+            size_t acknowledged = 0;
+
+            WriteLock lock(*this);
+
+            ConsumerGroup& consumer_group = GetConsumerGroup(group, "RingBuffer::AcknowledgeGroup");
+            for (int64_t id : ids) {
+                auto it = Find(id);
+                if (it == buffer_.end() || !consumer_group.acknowledged_.insert(id).second) {
+                    continue;
+                }
+                acknowledged++;
+
+                if (++acknowledgements_[id] >= groups_.size()) {
+                    DeleteAcknowledged(it);
+                }
+            }
+            return acknowledged;
+        }
+
+        void RingBuffer::DeleteAcknowledged(BufferQueueType::iterator it) {
+            if (on_delete_callback_) {
+                on_delete_callback_(&*it, false, 0);
+            }
+            EraseLocked(it);
+        }
+
+        RingBuffer::ConsumerGroup& RingBuffer::GetConsumerGroup(const std::string& group, const std::string& scope) {
+            auto it = groups_.find(group);
+            if (it == groups_.end()) {
+                throw RingBufferException("Unknown consumer group '" + group + "'", scope);
+            }
+            return it->second;
+        }
+
         size_t RingBuffer::GetSize() const {
             boost::shared_lock<boost::shared_mutex> lock(mutex_);
 
@@ -147,6 +821,15 @@ namespace qds_buffer {
             return !buffer_.empty() ? buffer_.back().id_ : -1;
         }
 
+        int64_t RingBuffer::GetLastId(uint64_t& sequence) const {
+            boost::shared_lock<boost::shared_mutex> lock(mutex_);
+
+            sequence = 0;
+            if (buffer_.empty()) return -1;
+            GetSequenceLocked(buffer_.back().id_, sequence);
+            return buffer_.back().id_;
+        }
+
         int8_t RingBuffer::GetCounterMode() const {
             return kCounterMode_;
         }
@@ -155,8 +838,33 @@ namespace qds_buffer {
             using namespace std::chrono;
             return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
         }
+
+        uint64_t RingBuffer::GetLeaseTick(uint64_t offset_ms) {
+            // leases must not depend on adjustments of the system clock
+            using namespace std::chrono;
+            uint64_t now_ms = duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+            return (now_ms + offset_ms) / kLeaseTickMs_;
+        }
         bool RingBuffer::GetAllowOverflow() const { 
             return kAllowOverflow_; 
         }
+
+        EvictionPolicy RingBuffer::GetEvictionPolicy() const {
+            return kEvictionPolicy_;
+        }
+
+        size_t RingBuffer::GetMaxBytes() const {
+            return kMaxBytes_;
+        }
+
+        bool RingBuffer::GetCompactDataSets() const {
+            return kCompactDataSets_;
+        }
+
+        size_t RingBuffer::GetMemoryUsage() const {
+            boost::shared_lock<boost::shared_mutex> lock(mutex_);
+
+            return bytes_;
+        }
     }
 } // namespace
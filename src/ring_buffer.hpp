@@ -4,50 +4,350 @@
 
 #pragma once
 
+#include <exception>
 #include <functional>
+#include <limits>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 
+#include <buffer_snapshot.hpp>
 #include <measurement.hpp>
 #include <types.hpp>
 #include <boost/thread.hpp>
 
+#include "data_notifier.hpp"
+#include "snapshot_builder.hpp"
+#include "timing_wheel.hpp"
+
 namespace qds_buffer {
    
    namespace core {
 
       using OnDeleteCallbackType = std::function<void(const BufferEntry*, bool, uint64_t)>;
+      // entries deleted together by a single call (see RingBuffer::Delete(ids), RingBuffer::DeleteUpTo), deletion time
+      using OnDeleteBatchCallbackType = std::function<void(const std::vector<const BufferEntry*>&, uint64_t)>;
+      // id, measurements of a pushed entry -> memory used by them in bytes (see BufferEntry::bytes_)
+      using EntrySizeFunctionType = std::function<size_t(int64_t, const std::vector<Measurement>&)>;
+
+      /*
+      * Result of a single entry of RingBuffer::PushBatch
+      */
+      struct PushResult {
+         int deletion_count_;         // see RingBuffer::Push
+         std::exception_ptr error_;   // null on success, otherwise the exception Push would have thrown
+      };
 
       /**
        * Thread-Safe
        */
       class RingBuffer {
       public:
-         RingBuffer(size_t size, int8_t counter_mode, bool allow_overflow = true, OnDeleteCallbackType on_delete_callback = nullptr);
+         /*
+         * notifier: signaled on new data and resets; may be shared by several buffers (see ShardedDataSource), a buffer
+         *           without notifier creates its own
+         * on_delete_batch_callback: called instead of on_delete_callback for entries deleted together; without it,
+         *                           on_delete_callback is called for each of them
+         * eviction_policy: entries discarded first on an overflow; OLDEST scans the buffer in order, the other policies keep
+         *                  an ordered index of the entries (O(log n) per push and deletion)
+         * entry_size_function: memory used by the measurements of an entry; without it, Measurement::ByteSize is used
+         * max_bytes: maximum memory used by all entries (0 = unlimited, see GetMemoryUsage); exceeding it overflows the
+         *            buffer like exceeding the size
+         * compact_data_sets: every pushed entry also gets its measurements as CompactDataSet (see BufferEntry::compact_),
+         *                    built before taking the lock and counted in the size of the entry
+         */
+         RingBuffer(size_t size, int8_t counter_mode, bool allow_overflow = true, OnDeleteCallbackType on_delete_callback = nullptr,
+                    std::shared_ptr<DataNotifier> notifier = nullptr, OnDeleteBatchCallbackType on_delete_batch_callback = nullptr,
+                    EvictionPolicy eviction_policy = EvictionPolicy::OLDEST, EntrySizeFunctionType entry_size_function = nullptr,
+                    size_t max_bytes = 0, bool compact_data_sets = false);
 
+         /*
+         * @throws RingBufferException if the entry alone uses more than max_bytes
+         */
          int Push(int64_t id, std::shared_ptr<std::vector<Measurement>> measurement);
+         /*
+         * Pushes all entries in order under a single lock acquisition; a failing entry does not affect the others
+         */
+         std::vector<PushResult> PushBatch(const std::vector<std::pair<int64_t, std::shared_ptr<std::vector<Measurement>>>>& entries);
          void Delete(int64_t id);
+         /*
+         * Deletes all entries with the given ids under a single lock acquisition; unknown ids are ignored
+         *
+         * @returns number of deleted entries
+         */
+         size_t Delete(const std::vector<int64_t>& ids);
+         /*
+         * Deletes all entries with an id <= the given id under a single lock acquisition; counter mode 0 only
+         *
+         * @returns number of deleted entries
+         *
+         * @throws RingBufferException in counter mode 1
+         */
+         size_t DeleteUpTo(int64_t id);
+         /*
+         * Deletes up to max_n of the oldest unlocked entries added before cutoff_ms (see BufferEntry::timestamp_ms_); the
+         * deletion callbacks get the current time as deletion time, like on an overflow
+         *
+         * @returns number of deleted entries
+         */
+         size_t DeleteOlderThan(uint64_t cutoff_ms, size_t max_n);
+         /*
+         * Sets the priority of an entry (default 0); with EvictionPolicy::PRIORITY, entries with a lower priority are
+         * discarded first on an overflow. No effect with the other policies.
+         *
+         * @returns false if there is no entry with the given id
+         */
+         bool SetPriority(int64_t id, int32_t priority);
          ResetInformation Reset(ResetReason reason);
 
          boost::shared_mutex& GetSharedMutex() const;
          BufferQueueType::iterator begin();
          BufferQueueType::iterator end();
+         /*
+         * @returns iterator to the entry with the given id or end(); O(1)
+         */
+         BufferQueueType::iterator Find(int64_t id);
+         /*
+         * @returns the entries at the time of the call without locking; the first call copies the buffer under the exclusive
+         *          lock, from then on every modification publishes a new snapshot (see SnapshotBuilder). The lock state of
+         *          an entry is the one when it was added or copied.
+         */
+         BufferSnapshot GetSnapshot() const;
+
+         /*
+         * Locks (claims) up to max_n of the oldest unlocked entries with an id <= max_id; concurrent callers never claim
+         * the same entry. Continues behind the entries that were locked on the previous call, so the locked front of the
+         * buffer isn't iterated again. With a lease_ms > 0, the entries are unlocked again automatically if they are still
+         * locked lease_ms after the claim (e.g. because the consumer died).
+         *
+         * @returns copies of the claimed entries in buffer order
+         */
+         std::vector<BufferEntry> ClaimBatch(size_t max_n, uint32_t lease_ms = 0,
+                                             int64_t max_id = std::numeric_limits<int64_t>::max());
+         /*
+         * @returns up to max_n entries with an id > last_id, ordered by id; O(log n) to find the first entry
+         */
+         std::vector<DataSetHandle> ReadSince(int64_t last_id, size_t max_n);
+         /*
+         * @returns up to max_n entries with from_ms <= timestamp_ms_ <= to_ms in buffer order; O(log n) to find the first
+         *          entry, since the timestamps never decrease in buffer order
+         */
+         std::vector<DataSetHandle> ReadTimeRange(uint64_t from_ms, uint64_t to_ms,
+                                                  size_t max_n = std::numeric_limits<size_t>::max());
+         /*
+         * @returns ids of up to max_n of the oldest unlocked entries, without locking them
+         */
+         std::vector<int64_t> PeekUnlocked(size_t max_n);
+         /*
+         * Unlocks the entries with the given ids; unknown or unlocked ids are ignored
+         *
+         * @returns number of unlocked entries
+         */
+         size_t Release(const std::vector<int64_t>& ids);
+         /*
+         * @returns number of entries that were unlocked because their lease expired
+         */
+         uint64_t GetExpiredLeaseCount() const;
+         /*
+         * Blocks until an entry with an id greater than after_id was pushed (counter mode 0) or an entry was pushed after the
+         * one with after_id (counter mode 1; immediately if there is no such entry, but the buffer isn't empty), the buffer
+         * was reset or the timeout elapsed
+         *
+         * @returns false on timeout
+         */
+         bool WaitForNewData(int64_t after_id, uint32_t timeout_ms);
+
+         /*
+         * Adds a consumer group that reads all entries independently of the other groups, starting at the oldest entry;
+         * no effect if the group exists
+         */
+         void RegisterConsumerGroup(const std::string& group);
+         /*
+         * Removes a consumer group; entries acknowledged by all remaining groups are deleted
+         */
+         void UnregisterConsumerGroup(const std::string& group);
+         /*
+         * Reads up to max_n entries behind the cursor of the group (stops at the first id > max_id) and moves the cursor
+         * behind them; O(1) to find the cursor position
+         *
+         * @returns copies of the entries in buffer order
+         *
+         * @throws RingBufferException if the group is unknown
+         */
+         std::vector<BufferEntry> ReadGroup(const std::string& group, size_t max_n,
+                                            int64_t max_id = std::numeric_limits<int64_t>::max());
+         /*
+         * @returns ids of up to max_n entries behind the cursor of the group, without moving the cursor
+         *
+         * @throws RingBufferException if the group is unknown
+         */
+         std::vector<int64_t> PeekGroup(const std::string& group, size_t max_n);
+         /*
+         * Acknowledges entries for the group; entries acknowledged by all groups are deleted. Unknown ids and ids the group
+         * already acknowledged are ignored.
+         *
+         * @returns number of acknowledged entries
+         *
+         * @throws RingBufferException if the group is unknown
+         */
+         size_t AcknowledgeGroup(const std::string& group, const std::vector<int64_t>& ids);
 
          size_t GetSize() const;
          size_t GetMaxSize() const;
          int64_t GetLastId() const;
+         /*
+         * Like GetLastId(), also returns the sequence number of the entry in counter mode 1 (see DataNotifier::NextSequence(),
+         * 0 = none), e.g. to find the entry added last across several buffers
+         */
+         int64_t GetLastId(uint64_t& sequence) const;
+         /*
+         * Counter mode 1: sets the sequence number of the entry with the given id (see DataNotifier::NextSequence())
+         *
+         * @returns false if there is no entry with the given id
+         */
+         bool GetSequence(int64_t id, uint64_t& sequence) const;
          int8_t GetCounterMode() const;
          bool GetAllowOverflow() const;
+         EvictionPolicy GetEvictionPolicy() const;
+         size_t GetMaxBytes() const;
+         bool GetCompactDataSets() const;
+         /*
+         * @returns memory used by all entries in bytes, the sum of BufferEntry::bytes_
+         */
+         size_t GetMemoryUsage() const;
 
       private:
+         /*
+         * Exclusive lock of mutex_ that frees the data of the entries erased while locked only after unlocking,
+         * so a large eviction or a reset doesn't block readers and producers with freeing memory; publishes the snapshot
+         * of the modified buffer before unlocking
+         */
+         class WriteLock {
+         public:
+            explicit WriteLock(RingBuffer& buffer);
+            ~WriteLock();
+
+         private:
+            RingBuffer& buffer_;
+            boost::unique_lock<boost::shared_mutex> lock_;
+         };
+
+         // mutex_ must be locked exclusively
+         int PushLocked(int64_t id, std::shared_ptr<std::vector<Measurement>> measurement,
+                        std::shared_ptr<const CompactDataSet> compact);
+         // compact form of the measurements of an entry to push; null without compact_data_sets
+         std::shared_ptr<const CompactDataSet> MakeCompact(const std::vector<Measurement>& measurement) const;
+         // mutex_ must be locked exclusively; discards unlocked entries in the order of eviction_index_ until there is room
+         int EvictByIndexLocked(size_t bytes);
+         // mutex_ must be locked; true if there is no room for an entry of the given size
+         bool IsFull(size_t bytes) const;
+         // mutex_ must be locked exclusively
+         BufferQueueType::iterator EraseLocked(BufferQueueType::iterator it);
+         // mutex_ must be locked exclusively, or shared together with claim_mutex_
+         BufferQueueType::iterator GetScanStart();
+         void SetScanPosition(BufferQueueType::iterator it);
+         // mutex_ must be locked exclusively
+         void DeleteAcknowledged(BufferQueueType::iterator it);
+         // mutex_ must be locked exclusively; calls the deletion callback(s) once, then erases the entries
+         size_t EraseBatchLocked(const std::vector<BufferQueueType::iterator>& entries, uint64_t deletion_time_ms);
+         // mutex_ must be locked exclusively, or shared together with claim_mutex_
+         void ExpireLeases();
+         // mutex_ must be locked
+         bool GetSequenceLocked(int64_t id, uint64_t& sequence) const;
+
          static uint64_t GetCurrentTimeMs();
+         static uint64_t GetLeaseTick(uint64_t offset_ms);
 
          const size_t kMaxSize_;
          const int8_t kCounterMode_;
          const bool kAllowOverflow_;
+         const EvictionPolicy kEvictionPolicy_;
+         const size_t kMaxBytes_;
+         const bool kCompactDataSets_;
 
          mutable boost::shared_mutex mutex_;
          BufferQueueType buffer_;
+         std::unordered_map<int64_t, size_t> index_;   // id -> slot of the entry in buffer_
+         // counter mode 1 only (in counter mode 0, buffer_ is ordered by id): id -> sequence number of the entry, see
+         // DataNotifier::NextSequence()
+         std::map<int64_t, uint64_t> ordered_ids_;
+         std::vector<std::shared_ptr<std::vector<Measurement>>> released_;   // measurements of erased entries, see WriteLock
+         std::vector<std::shared_ptr<const CompactDataSet>> released_compact_;   // their compact forms, see WriteLock
+         size_t bytes_;                                 // sum of BufferEntry::bytes_
+
+         // overflow eviction and claims: all entries in front of the scan position were locked when an eviction or a claim
+         // passed them, so the next one continues at the scan position; unlocking an entry (release) restarts the scan at
+         // the beginning. Claims run under the shared lock and claim_mutex_, evictions under the exclusive lock.
+         enum class ScanPosition { kEntry, kEnd };
+         ScanPosition scan_position_;
+         int64_t scan_id_;                              // first entry not yet passed by the eviction (kEntry)
+         std::atomic<uint64_t> releases_;               // incremented by LockFlag whenever an entry gets unlocked
+         uint64_t checked_releases_;
+         boost::mutex claim_mutex_;
+
+         // overflow eviction with EvictionPolicy::LARGEST/PRIORITY: the entries ordered by the policy, the first unlocked one
+         // is discarded first. The rank is the negated size (LARGEST) or the priority (PRIORITY), the push sequence keeps
+         // equally ranked entries in push order. Empty with EvictionPolicy::OLDEST.
+         struct EvictionKey {
+            int64_t rank_;
+            uint64_t sequence_;
+            int64_t id_;
+
+            bool operator<(const EvictionKey& other) const {
+               return rank_ != other.rank_ ? rank_ < other.rank_ : sequence_ < other.sequence_;
+            }
+         };
+         static const EvictionKey kFirstEvictionKey_;   // in front of all keys
+         static const EvictionKey kLastEvictionKey_;    // behind all keys
+         // mutex_ must be locked exclusively; called for a key added to eviction_index_
+         void LowerEvictionScanKey(const EvictionKey& key);
+         std::set<EvictionKey> eviction_index_;
+         std::unordered_map<int64_t, EvictionKey> eviction_keys_;   // id -> key of the entry in eviction_index_
+         uint64_t eviction_sequence_;
+         // like the scan position: all keys in front of it were locked when an eviction passed them, the next eviction
+         // continues there; unlocking an entry restarts at the first key
+         EvictionKey eviction_scan_key_;
+         uint64_t eviction_checked_releases_;
+         EntrySizeFunctionType entry_size_function_;
+
+         // consumer groups: the cursor is the next entry to read (kEntry) and moves on like the scan position if that entry
+         // gets erased. Cursors are moved under the shared lock together with groups_mutex_ (ReadGroup), everything else
+         // under the exclusive lock.
+         struct ConsumerGroup {
+            ScanPosition cursor_;
+            int64_t cursor_id_;
+            std::unordered_set<int64_t> acknowledged_;
+         };
+         ConsumerGroup& GetConsumerGroup(const std::string& group, const std::string& scope);
+         std::unordered_map<std::string, ConsumerGroup> groups_;
+         std::unordered_map<int64_t, size_t> acknowledgements_;   // id -> number of groups that acknowledged the entry
+         boost::mutex groups_mutex_;
+
+         // leases of claimed entries; a lease is only valid while leases_ maps the id to its lease number, so releasing or
+         // deleting an entry doesn't have to search the wheel. Modified under the exclusive lock, or under the shared lock
+         // together with lease_mutex_ (ClaimBatch, Release).
+         struct Lease {
+            int64_t id_;
+            uint64_t lease_;
+         };
+         static const uint64_t kLeaseTickMs_ = 10;
+         TimingWheel<Lease> lease_wheel_;
+         std::unordered_map<int64_t, uint64_t> leases_;   // id -> lease number
+         uint64_t lease_counter_;
+         std::atomic<uint64_t> expired_leases_;
+         boost::mutex lease_mutex_;
+
+         // snapshots: once enabled by the first GetSnapshot(), the builder mirrors buffer_ and WriteLock publishes its state to
+         // snapshot_ (std::atomic_load/std::atomic_exchange) before unlocking
+         mutable SnapshotBuilder snapshot_builder_;
+         mutable std::atomic<bool> snapshots_enabled_;
+         mutable BufferSnapshot snapshot_;
 
          OnDeleteCallbackType on_delete_callback_;
+         std::shared_ptr<DataNotifier> notifier_;
+         OnDeleteBatchCallbackType on_delete_batch_callback_;
       };
 
    } // namespace
@@ -4,6 +4,12 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <deque>
+#include <limits>
+#include <random>
+#include <thread>
+
 #include "ring_buffer.hpp"
 #include <exception.hpp>
 
@@ -308,3 +314,676 @@ TEST(RingBufferTest, CounterMode) {
         EXPECT_EQ("CounterMode 04b", it->measurements_->front().name_);
     }
 }
+
+TEST(RingBufferTest, PushBatch) {
+    RingBuffer buffer{3, 0};
+
+    auto results = buffer.PushBatch({{1, DUMMY}, {2, DUMMY}, {2, DUMMY}, {3, DUMMY}, {4, DUMMY}});
+    ASSERT_EQ(5, results.size());
+    EXPECT_EQ(0, results[0].deletion_count_);
+    EXPECT_EQ(0, results[1].deletion_count_);
+    EXPECT_EQ(-1, results[2].deletion_count_);
+    EXPECT_THROW(std::rethrow_exception(results[2].error_), RingBufferException); // Bad Id
+    EXPECT_EQ(0, results[3].deletion_count_);
+    EXPECT_EQ(1, results[4].deletion_count_);
+    EXPECT_EQ(nullptr, results[4].error_);
+
+    EXPECT_EQ(3, buffer.GetSize());
+    EXPECT_EQ(4, buffer.GetLastId());
+    EXPECT_EQ(2, buffer.begin()->id_);
+}
+
+TEST(RingBufferTest, PushBatchOverflowNotAllowed) {
+    RingBuffer buffer{2, 0, false};
+
+    auto results = buffer.PushBatch({{1, DUMMY}, {2, DUMMY}, {3, DUMMY}});
+    ASSERT_EQ(3, results.size());
+    EXPECT_EQ(nullptr, results[0].error_);
+    EXPECT_EQ(nullptr, results[1].error_);
+    EXPECT_THROW(std::rethrow_exception(results[2].error_), RingBufferOverflowException);
+    EXPECT_EQ(2, buffer.GetSize());
+}
+
+TEST(RingBufferTest, Find) {
+    RingBuffer buffer{3, 0};
+
+    buffer.Push(1, DUMMY); buffer.Push(10, DUMMY); buffer.Push(50, DUMMY);
+    EXPECT_EQ(10, buffer.Find(10)->id_);
+    EXPECT_EQ(buffer.end(), buffer.Find(11));
+
+    buffer.Find(10)->locked_ = true;
+    buffer.Push(100, DUMMY); // evicts 1
+    buffer.Push(500, DUMMY); // evicts 50, skips locked 10
+    EXPECT_EQ(buffer.end(), buffer.Find(1));
+    EXPECT_EQ(buffer.end(), buffer.Find(50));
+    EXPECT_EQ(10, buffer.Find(10)->id_);
+    EXPECT_EQ(100, buffer.Find(100)->id_);
+    EXPECT_EQ(500, buffer.Find(500)->id_);
+
+    buffer.Delete(100);
+    EXPECT_EQ(buffer.end(), buffer.Find(100));
+    EXPECT_EQ(500, buffer.Find(500)->id_);
+
+    buffer.Reset(ResetReason::UNKNOWN);
+    EXPECT_EQ(buffer.end(), buffer.Find(10));
+    EXPECT_EQ(buffer.end(), buffer.Find(500));
+}
+
+TEST(RingBufferTest, FindConsistency) {
+    // locked entries, deletions in the middle (slot compaction) and counter mode 1 replacements
+    for (int8_t counter_mode : {0, 1}) {
+        RingBuffer buffer{20, counter_mode};
+
+        int64_t id = 0;
+        for (int i = 0; i < 2000; i++) {
+            if (counter_mode == 1 && i % 7 == 0) {
+                buffer.Push(id - 3, DUMMY);
+            } else {
+                buffer.Push(++id, DUMMY);
+            }
+            if (i % 5 == 0) buffer.Delete(id - 2);
+            if (i % 11 == 0 && buffer.Find(id) != buffer.end()) buffer.Find(id)->locked_ = true;
+            if (i % 13 == 0) {
+                for (auto& entry : buffer) entry.locked_ = false;
+            }
+
+            size_t count = 0;
+            for (auto it = buffer.begin(); it != buffer.end(); ++it, ++count) {
+                ASSERT_EQ(it, buffer.Find(it->id_)) << "Id: " << it->id_;
+            }
+            ASSERT_EQ(buffer.GetSize(), count);
+        }
+    }
+}
+
+TEST(RingBufferTest, Unlock) {
+    RingBuffer buffer{3, 0};
+
+    buffer.Push(1, DUMMY); buffer.Push(2, DUMMY); buffer.Push(3, DUMMY);
+    buffer.Find(1)->locked_ = true;
+    buffer.Find(2)->locked_ = true;
+
+    EXPECT_EQ(1, buffer.Push(4, DUMMY)); // evicts 3, passes locked 1 and 2
+    buffer.Find(1)->locked_ = false;
+
+    EXPECT_EQ(1, buffer.Push(5, DUMMY)); // the oldest unlocked entry is 1 again
+    auto it = buffer.begin();
+    EXPECT_EQ(2, it->id_);
+    EXPECT_EQ(4, (++it)->id_);
+    EXPECT_EQ(5, (++it)->id_);
+}
+
+TEST(RingBufferTest, OverflowMatchesLinearScan) {
+    // reference: oldest unlocked entry is evicted, found by scanning from the front
+    struct Entry { int64_t id_; bool locked_; };
+    const size_t size = 30;
+
+    for (int8_t counter_mode : {0, 1}) {
+        RingBuffer buffer{size, counter_mode};
+        std::deque<Entry> expected;
+        std::mt19937 random(4711);
+
+        int64_t id = 0;
+        for (int i = 0; i < 5000; i++) {
+            unsigned operation = random() % 20;
+            if (operation < 3 && !expected.empty()) {
+                // lock or unlock a random entry
+                auto& entry = expected[random() % expected.size()];
+                entry.locked_ = operation != 0;
+                buffer.Find(entry.id_)->locked_ = entry.locked_;
+            } else if (operation == 3 && !expected.empty()) {
+                int64_t delete_id = expected[random() % expected.size()].id_;
+                buffer.Delete(delete_id);
+                for (auto it = expected.begin(); it != expected.end(); ++it) {
+                    if (it->id_ == delete_id) { expected.erase(it); break; }
+                }
+            } else {
+                int64_t push_id = ++id;
+                if (counter_mode == 1 && operation == 4 && !expected.empty()) {
+                    push_id = expected[random() % expected.size()].id_;
+                }
+
+                int expected_result = 0;
+                if (expected.size() >= size) {
+                    for (auto it = expected.begin(); it != expected.end() && expected.size() >= size;) {
+                        if (!it->locked_) { it = expected.erase(it); expected_result++; } else { ++it; }
+                    }
+                    if (expected.size() >= size) expected_result = -1;
+                }
+                if (expected_result >= 0) {
+                    for (auto it = expected.begin(); it != expected.end(); ++it) {
+                        if (it->id_ == push_id) {
+                            if (it->locked_) expected_result = -1; else expected.erase(it);
+                            break;
+                        }
+                    }
+                }
+                if (expected_result >= 0) expected.push_back(Entry{push_id, false});
+
+                ASSERT_EQ(expected_result, buffer.Push(push_id, DUMMY)) << "Step: " << i;
+            }
+
+            ASSERT_EQ(expected.size(), buffer.GetSize()) << "Step: " << i;
+            auto it = buffer.begin();
+            for (auto& entry : expected) {
+                ASSERT_EQ(entry.id_, it->id_) << "Step: " << i;
+                ASSERT_EQ(entry.locked_, static_cast<bool>(it->locked_)) << "Step: " << i;
+                ++it;
+            }
+        }
+    }
+}
+
+TEST(RingBufferTest, Snapshot) {
+    RingBuffer buffer{3, 0};
+
+    auto empty = buffer.GetSnapshot();
+    EXPECT_TRUE(empty->empty());
+
+    buffer.Push(1, DUMMY); buffer.Push(2, DUMMY);
+    auto snapshot = buffer.GetSnapshot();
+    ASSERT_EQ(2, snapshot->size());
+    EXPECT_EQ(1, (*snapshot)[0].id_);
+    EXPECT_EQ(2, (*snapshot)[1].id_);
+    EXPECT_EQ(snapshot, buffer.GetSnapshot()); // unchanged buffer, shared copy
+
+    // modifications don't affect an existing snapshot
+    buffer.Push(3, DUMMY); buffer.Push(4, DUMMY); buffer.Delete(3);
+    ASSERT_EQ(2, snapshot->size());
+    EXPECT_EQ(1, (*snapshot)[0].id_);
+    EXPECT_NE(nullptr, (*snapshot)[0].measurements_);
+
+    auto current = buffer.GetSnapshot();
+    EXPECT_NE(snapshot, current);
+    ASSERT_EQ(2, current->size());
+    EXPECT_EQ(2, (*current)[0].id_);
+    EXPECT_EQ(4, (*current)[1].id_);
+
+    buffer.Reset(ResetReason::UNKNOWN);
+    EXPECT_TRUE(buffer.GetSnapshot()->empty());
+    EXPECT_EQ(2, current->size());
+}
+
+TEST(RingBufferTest, SnapshotConcurrentPush) {
+    RingBuffer buffer{100, 0};
+
+    boost::thread producer([&buffer]() {
+        for (int64_t id = 1; id <= 20000; id++) {
+            buffer.Push(id, DUMMY);
+        }
+    });
+
+    // every snapshot is a consistent, ordered state of the buffer
+    for (int i = 0; i < 2000; i++) {
+        auto snapshot = buffer.GetSnapshot();
+        EXPECT_LE(snapshot->size(), 100);
+        for (size_t k = 1; k < snapshot->size(); k++) {
+            ASSERT_EQ((*snapshot)[k - 1].id_ + 1, (*snapshot)[k].id_);
+        }
+    }
+    producer.join();
+
+    EXPECT_EQ(20000, buffer.GetSnapshot()->back().id_);
+}
+
+TEST(RingBufferTest, SnapshotFollowsModifications) {
+    for (int8_t counter_mode : {0, 1}) {
+        RingBuffer buffer{50, counter_mode};
+        std::mt19937 random(4711);
+        buffer.GetSnapshot();
+
+        for (int64_t i = 1; i <= 3000; i++) {
+            unsigned operation = random() % 10;
+            if (operation == 0 && buffer.GetSize() > 0) {
+                auto it = buffer.Find(buffer.GetSnapshot()->front().id_ + random() % 5);
+                if (it != buffer.end()) it->locked_ = true;
+            } else if (operation == 1 && buffer.GetSize() > 0) {
+                auto snapshot = buffer.GetSnapshot();
+                buffer.Delete((*snapshot)[random() % snapshot->size()].id_);
+            } else {
+                buffer.Push(counter_mode == 1 && operation == 2 ? random() % i + 1 : i, DUMMY);
+            }
+
+            // the published snapshot is the current buffer
+            auto snapshot = buffer.GetSnapshot();
+            ASSERT_EQ(buffer.GetSize(), snapshot->size()) << "Step: " << i;
+            auto it = buffer.begin();
+            for (const BufferEntry& entry : *snapshot) {
+                ASSERT_EQ(it->id_, entry.id_) << "Step: " << i;
+                ++it;
+            }
+        }
+    }
+}
+
+TEST(RingBufferTest, ClaimBatch) {
+    RingBuffer buffer{5, 0};
+
+    EXPECT_TRUE(buffer.ClaimBatch(3).empty());
+    for (int64_t id = 1; id <= 5; id++) {
+        buffer.Push(id, DUMMY);
+    }
+    buffer.Find(2)->locked_ = true;
+
+    auto claimed = buffer.ClaimBatch(2);
+    ASSERT_EQ(2, claimed.size());
+    EXPECT_EQ(1, claimed[0].id_);
+    EXPECT_EQ(3, claimed[1].id_);
+    EXPECT_TRUE(buffer.Find(1)->locked_);
+    EXPECT_TRUE(buffer.Find(3)->locked_);
+
+    EXPECT_EQ((std::vector<int64_t>{4, 5}), buffer.PeekUnlocked(10));
+    claimed = buffer.ClaimBatch(10);
+    ASSERT_EQ(2, claimed.size());
+    EXPECT_EQ(4, claimed[0].id_);
+    EXPECT_TRUE(buffer.ClaimBatch(10).empty());
+
+    // claimed entries are not evicted
+    EXPECT_EQ(-1, buffer.Push(6, DUMMY));
+
+    EXPECT_EQ(2, buffer.Release({3, 5, 5, 42}));
+    EXPECT_FALSE(buffer.Find(3)->locked_);
+    EXPECT_EQ(1, buffer.Push(6, DUMMY)); // evicts 3
+
+    // released entries are claimed again, new entries are claimed behind the locked ones
+    claimed = buffer.ClaimBatch(10);
+    ASSERT_EQ(2, claimed.size());
+    EXPECT_EQ(5, claimed[0].id_);
+    EXPECT_EQ(6, claimed[1].id_);
+    buffer.Release({4});
+    EXPECT_EQ(4, buffer.ClaimBatch(10).at(0).id_);
+
+    // limited by id
+    buffer.Release({1, 2, 4, 6});
+    claimed = buffer.ClaimBatch(10, 0, 2);
+    ASSERT_EQ(2, claimed.size());
+    EXPECT_EQ(2, claimed[1].id_);
+}
+
+TEST(RingBufferTest, ClaimBatchConcurrent) {
+    const int64_t entry_count = 10000;
+    RingBuffer buffer{static_cast<size_t>(entry_count), 0};
+    for (int64_t id = 1; id <= entry_count; id++) {
+        buffer.Push(id, DUMMY);
+    }
+
+    // every entry is claimed by exactly one consumer
+    std::vector<std::vector<int64_t>> claimed_ids(4);
+    boost::thread_group consumers;
+    for (size_t c = 0; c < claimed_ids.size(); c++) {
+        consumers.create_thread([&buffer, &claimed_ids, c]() {
+            for (;;) {
+                auto claimed = buffer.ClaimBatch(7);
+                if (claimed.empty()) break;
+                for (auto& entry : claimed) claimed_ids[c].push_back(entry.id_);
+            }
+        });
+    }
+    consumers.join_all();
+
+    std::vector<int64_t> all;
+    for (auto& ids : claimed_ids) all.insert(all.end(), ids.begin(), ids.end());
+    std::sort(all.begin(), all.end());
+    ASSERT_EQ(entry_count, all.size());
+    for (int64_t i = 0; i < entry_count; i++) {
+        ASSERT_EQ(i + 1, all[i]);
+    }
+}
+
+TEST(RingBufferTest, ClaimBatchLease) {
+    RingBuffer buffer{3, 0};
+    for (int64_t id = 1; id <= 3; id++) {
+        buffer.Push(id, DUMMY);
+    }
+
+    EXPECT_EQ(2, buffer.ClaimBatch(2, 20).size());
+    EXPECT_EQ(1, buffer.ClaimBatch(1).size());   // no lease
+    EXPECT_EQ(-1, buffer.Push(4, DUMMY));
+
+    // released before expiry, then claimed without lease
+    EXPECT_EQ(1, buffer.Release({2}));
+    EXPECT_EQ(2, buffer.ClaimBatch(1).at(0).id_);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(0, buffer.GetExpiredLeaseCount());   // expired leases are only processed when needed
+
+    // lease of 1 expired, can be evicted again; 2 and 3 are still locked
+    EXPECT_EQ(1, buffer.Push(4, DUMMY));
+    EXPECT_EQ(1, buffer.GetExpiredLeaseCount());
+    EXPECT_EQ(buffer.end(), buffer.Find(1));
+
+    // the lease is renewed by claiming again
+    EXPECT_EQ(4, buffer.ClaimBatch(1, 20).at(0).id_);
+    EXPECT_EQ(1, buffer.Release({4}));
+    EXPECT_EQ(4, buffer.ClaimBatch(1, 1000).at(0).id_);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(-1, buffer.Push(5, DUMMY));
+    EXPECT_EQ(1, buffer.GetExpiredLeaseCount());
+}
+
+TEST(RingBufferTest, WaitForNewData) {
+    RingBuffer buffer{5, 0};
+
+    EXPECT_FALSE(buffer.WaitForNewData(-1, 10));
+
+    buffer.Push(1, DUMMY);
+    EXPECT_TRUE(buffer.WaitForNewData(-1, 0));
+    EXPECT_FALSE(buffer.WaitForNewData(1, 10));
+
+    // woken up by a push
+    std::thread producer([&buffer]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        buffer.PushBatch({{2, DUMMY}, {3, DUMMY}});
+    });
+    EXPECT_TRUE(buffer.WaitForNewData(1, 10000));
+    producer.join();
+    EXPECT_TRUE(buffer.WaitForNewData(2, 0));
+    EXPECT_FALSE(buffer.WaitForNewData(3, 0));
+
+    // woken up by a reset
+    std::thread resetter([&buffer]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        buffer.Reset(ResetReason::UNKNOWN);
+    });
+    EXPECT_TRUE(buffer.WaitForNewData(3, 10000));
+    resetter.join();
+    EXPECT_FALSE(buffer.WaitForNewData(-1, 0));
+}
+
+TEST(RingBufferTest, WaitForNewDataCounterMode1) {
+    RingBuffer buffer{5, 1};
+
+    EXPECT_FALSE(buffer.WaitForNewData(-1, 10));
+    buffer.Push(10, DUMMY);
+    EXPECT_TRUE(buffer.WaitForNewData(-1, 0));
+    EXPECT_FALSE(buffer.WaitForNewData(10, 10));
+
+    // a lower id is new data as well
+    std::thread producer([&buffer]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        buffer.PushBatch({{3, DUMMY}, {2, DUMMY}});
+    });
+    EXPECT_TRUE(buffer.WaitForNewData(10, 10000));
+    producer.join();
+    EXPECT_EQ(2, buffer.GetLastId());
+    EXPECT_TRUE(buffer.WaitForNewData(3, 0));
+    EXPECT_FALSE(buffer.WaitForNewData(2, 0));
+
+    // adding an id again
+    buffer.Push(10, DUMMY);
+    EXPECT_TRUE(buffer.WaitForNewData(2, 0));
+    EXPECT_FALSE(buffer.WaitForNewData(10, 0));
+
+    // unknown id: immediately if the buffer has entries
+    EXPECT_TRUE(buffer.WaitForNewData(42, 0));
+    buffer.Reset(ResetReason::UNKNOWN);
+    EXPECT_FALSE(buffer.WaitForNewData(42, 10));
+}
+
+TEST(RingBufferTest, ConsumerGroups) {
+    RingBuffer buffer{5, 0};
+    for (int64_t id = 1; id <= 3; id++) {
+        buffer.Push(id, DUMMY);
+    }
+
+    EXPECT_THROW(buffer.ReadGroup("opcua", 10), RingBufferException);
+    buffer.RegisterConsumerGroup("opcua");
+    buffer.RegisterConsumerGroup("rest");
+    buffer.RegisterConsumerGroup("rest");
+
+    // independent cursors
+    auto entries = buffer.ReadGroup("opcua", 2);
+    ASSERT_EQ(2, entries.size());
+    EXPECT_EQ(1, entries[0].id_);
+    EXPECT_EQ(2, entries[1].id_);
+    EXPECT_EQ(1, buffer.ReadGroup("rest", 1).at(0).id_);
+    EXPECT_EQ(3, buffer.ReadGroup("opcua", 10).at(0).id_);
+    EXPECT_TRUE(buffer.ReadGroup("opcua", 10).empty());
+    EXPECT_EQ((std::vector<int64_t>{2, 3}), buffer.PeekGroup("rest", 10));
+
+    // a cursor at the end continues with new entries
+    buffer.Push(4, DUMMY);
+    EXPECT_EQ(4, buffer.ReadGroup("opcua", 10).at(0).id_);
+
+    // deleted after all groups acknowledged
+    EXPECT_EQ(2, buffer.AcknowledgeGroup("opcua", {1, 2, 42}));
+    EXPECT_EQ(0, buffer.AcknowledgeGroup("opcua", {1}));
+    EXPECT_EQ(4, buffer.GetSize());
+    EXPECT_EQ(1, buffer.AcknowledgeGroup("rest", {1}));
+    EXPECT_EQ(3, buffer.GetSize());
+    EXPECT_EQ(buffer.end(), buffer.Find(1));
+
+    // the cursor of rest moves on if its next entry is deleted
+    buffer.Delete(2);
+    EXPECT_EQ(3, buffer.ReadGroup("rest", 1).at(0).id_);
+
+    // entries only missing the acknowledgement of an unregistered group are deleted
+    EXPECT_EQ(2, buffer.AcknowledgeGroup("rest", {3, 4}));
+    buffer.UnregisterConsumerGroup("opcua");
+    EXPECT_EQ(0, buffer.GetSize());
+
+    buffer.Push(5, DUMMY);
+    buffer.Reset(ResetReason::UNKNOWN);
+    buffer.Push(1, DUMMY);
+    EXPECT_EQ(1, buffer.ReadGroup("rest", 10).at(0).id_);
+}
+
+TEST(RingBufferTest, DeleteBatch) {
+    std::vector<int64_t> deleted;
+    size_t batches = 0;
+    RingBuffer buffer{10, 0, true, nullptr, nullptr, [&deleted, &batches](const std::vector<const BufferEntry*>& entries, uint64_t) {
+        for (auto entry : entries) deleted.push_back(entry->id_);
+        batches++;
+    }};
+    for (int64_t id = 1; id <= 10; id++) {
+        buffer.Push(id, DUMMY);
+    }
+
+    EXPECT_EQ(3, buffer.Delete(std::vector<int64_t>{7, 2, 5, 2, 42}));
+    EXPECT_EQ((std::vector<int64_t>{2, 5, 7}), deleted);
+    EXPECT_EQ(1, batches);
+    EXPECT_EQ(7, buffer.GetSize());
+    EXPECT_EQ(buffer.end(), buffer.Find(5));
+
+    deleted.clear();
+    EXPECT_EQ(5, buffer.DeleteUpTo(8));
+    EXPECT_EQ((std::vector<int64_t>{1, 3, 4, 6, 8}), deleted);
+    EXPECT_EQ(2, batches);
+    EXPECT_EQ(9, buffer.begin()->id_);
+    EXPECT_EQ(0, buffer.Delete(std::vector<int64_t>{}));
+    EXPECT_EQ(2, batches);
+
+    RingBuffer buffer_counter_mode_1{10, 1};
+    EXPECT_THROW(buffer_counter_mode_1.DeleteUpTo(1), RingBufferException);
+}
+
+TEST(RingBufferTest, ReadSince) {
+    RingBuffer buffer{10, 0};
+    EXPECT_TRUE(buffer.ReadSince(-1, 10).empty());
+
+    for (int64_t id = 2; id <= 20; id += 2) {
+        buffer.Push(id, DUMMY);
+    }
+    buffer.Delete(std::vector<int64_t>{8, 10, 12});
+
+    auto ids = [](const std::vector<DataSetHandle>& handles) {
+        std::vector<int64_t> result;
+        for (auto& handle : handles) result.push_back(handle.id_);
+        return result;
+    };
+    EXPECT_EQ((std::vector<int64_t>{2, 4, 6}), ids(buffer.ReadSince(-1, 3)));
+    EXPECT_EQ((std::vector<int64_t>{14, 16}), ids(buffer.ReadSince(6, 2)));
+    EXPECT_EQ((std::vector<int64_t>{14, 16, 18, 20}), ids(buffer.ReadSince(9, 10)));  // unknown id
+    EXPECT_TRUE(buffer.ReadSince(20, 10).empty());
+
+    // the handle keeps the measurements alive
+    auto handles = buffer.ReadSince(18, 1);
+    buffer.Reset(ResetReason::UNKNOWN);
+    ASSERT_EQ(1, handles.size());
+    EXPECT_EQ(DUMMY->size(), handles[0].measurements_->size());
+
+    // ordered by id in counter mode 1
+    RingBuffer buffer_counter_mode_1{10, 1};
+    for (int64_t id : {5, 3, 9, 1, 7}) {
+        buffer_counter_mode_1.Push(id, DUMMY);
+    }
+    buffer_counter_mode_1.Push(3, DUMMY);  // replaced
+    buffer_counter_mode_1.Delete(9);
+    EXPECT_EQ((std::vector<int64_t>{3, 5, 7}), ids(buffer_counter_mode_1.ReadSince(2, 10)));
+}
+
+TEST(RingBufferTest, ReadTimeRange) {
+    RingBuffer buffer{10, 0};
+    EXPECT_TRUE(buffer.ReadTimeRange(0, std::numeric_limits<uint64_t>::max()).empty());
+
+    for (int64_t id = 1; id <= 6; id++) {
+        buffer.Push(id, DUMMY);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    buffer.Delete(3);
+    uint64_t ts2 = buffer.Find(2)->timestamp_ms_;
+    uint64_t ts5 = buffer.Find(5)->timestamp_ms_;
+
+    auto ids = [](const std::vector<DataSetHandle>& handles) {
+        std::vector<int64_t> result;
+        for (auto& handle : handles) result.push_back(handle.id_);
+        return result;
+    };
+    EXPECT_EQ((std::vector<int64_t>{2, 4, 5}), ids(buffer.ReadTimeRange(ts2, ts5)));
+    EXPECT_EQ((std::vector<int64_t>{2, 4}), ids(buffer.ReadTimeRange(ts2, ts5, 2)));
+    EXPECT_EQ((std::vector<int64_t>{5, 6}), ids(buffer.ReadTimeRange(ts5, std::numeric_limits<uint64_t>::max())));
+    EXPECT_TRUE(buffer.ReadTimeRange(0, buffer.Find(1)->timestamp_ms_ - 1).empty());
+
+    // timestamps never decrease in buffer order
+    uint64_t previous = 0;
+    for (auto& entry : buffer) {
+        EXPECT_LE(previous, entry.timestamp_ms_);
+        previous = entry.timestamp_ms_;
+    }
+}
+
+TEST(RingBufferTest, EvictionPolicy) {
+    EXPECT_EQ(EvictionPolicy::OLDEST, (RingBuffer{3, 0}).GetEvictionPolicy());
+
+    // largest first, oldest first if equal
+    RingBuffer largest{3, 0, true, nullptr, nullptr, nullptr, EvictionPolicy::LARGEST};
+    Measurement image;
+    image.name_ = "Image";
+    image.type_ = MeasurementType::kString;
+    image.value_ = std::string(1000, 'x');
+    largest.Push(1, DUMMY);
+    largest.Push(2, std::make_shared<std::vector<Measurement>>(1, image));
+    largest.Push(3, DUMMY);
+    EXPECT_EQ(1, largest.Push(4, DUMMY));
+    EXPECT_EQ(largest.end(), largest.Find(2));
+    EXPECT_EQ(1, largest.Push(5, DUMMY));
+    EXPECT_EQ(largest.end(), largest.Find(1));
+
+    // lowest priority first, locked entries are kept
+    RingBuffer priority{3, 0, true, nullptr, nullptr, nullptr, EvictionPolicy::PRIORITY};
+    for (int64_t id = 1; id <= 3; id++) {
+        priority.Push(id, DUMMY);
+    }
+    EXPECT_TRUE(priority.SetPriority(1, 5));
+    EXPECT_TRUE(priority.SetPriority(3, -1));
+    EXPECT_FALSE(priority.SetPriority(99, 1));
+    EXPECT_EQ(1, priority.Push(4, DUMMY));
+    EXPECT_EQ(priority.end(), priority.Find(3));
+
+    ASSERT_EQ(1, priority.ClaimBatch(1).size());
+    EXPECT_TRUE(priority.SetPriority(1, -10));
+    EXPECT_EQ(1, priority.Push(5, DUMMY));
+    EXPECT_NE(priority.end(), priority.Find(1));
+    EXPECT_EQ(priority.end(), priority.Find(2));
+
+    // deleted entries leave the index
+    priority.Delete(4);
+    priority.Delete(5);
+    EXPECT_EQ(0, priority.Push(6, DUMMY));
+    EXPECT_EQ(0, priority.Push(7, DUMMY));
+    EXPECT_EQ(1, priority.Push(8, DUMMY));
+    EXPECT_EQ(priority.end(), priority.Find(6));
+
+    // no effect on the other policies
+    RingBuffer oldest{2, 0};
+    oldest.Push(1, DUMMY);
+    oldest.Push(2, DUMMY);
+    EXPECT_TRUE(oldest.SetPriority(1, 10));
+    oldest.Push(3, DUMMY);
+    EXPECT_EQ(oldest.end(), oldest.Find(1));
+}
+
+TEST(RingBufferTest, EvictionPolicySkipsLockedEntries) {
+    // the locked entries in front of the index are passed once, the next eviction continues behind them
+    RingBuffer buffer{4, 0, true, nullptr, nullptr, nullptr, EvictionPolicy::PRIORITY};
+    for (int64_t id = 1; id <= 4; id++) {
+        buffer.Push(id, DUMMY);
+        EXPECT_TRUE(buffer.SetPriority(id, id <= 3 ? -1 : 0));
+    }
+    for (int64_t id = 1; id <= 3; id++) {
+        buffer.Find(id)->locked_ = true;
+    }
+    EXPECT_EQ(1, buffer.Push(5, DUMMY));
+    EXPECT_EQ(buffer.end(), buffer.Find(4));
+    EXPECT_EQ(1, buffer.Push(6, DUMMY));
+    EXPECT_EQ(buffer.end(), buffer.Find(5));
+
+    // a key moved in front of the passed ones is found
+    EXPECT_TRUE(buffer.SetPriority(6, -2));
+    EXPECT_EQ(1, buffer.Push(7, DUMMY));
+    EXPECT_EQ(buffer.end(), buffer.Find(6));
+
+    // unlocking restarts at the first key
+    buffer.Find(2)->locked_ = false;
+    EXPECT_EQ(1, buffer.Push(8, DUMMY));
+    EXPECT_EQ(buffer.end(), buffer.Find(2));
+    EXPECT_NE(buffer.end(), buffer.Find(7));
+}
+
+TEST(RingBufferTest, MaxBytes) {
+    Measurement value;
+    value.name_ = "Value";
+    value.type_ = MeasurementType::kString;
+    value.value_ = std::string(1000, 'x');
+    auto measurements = std::make_shared<std::vector<Measurement>>(1, value);
+    size_t entry_bytes = sizeof(BufferEntry) + Measurement::ByteSize(*measurements);
+
+    // room for 3 entries by bytes, 100 by size
+    RingBuffer buffer{100, 0, true, nullptr, nullptr, nullptr, EvictionPolicy::OLDEST, nullptr, 3 * entry_bytes + 200};
+    EXPECT_EQ(3 * entry_bytes + 200, buffer.GetMaxBytes());
+    EXPECT_EQ(0, buffer.GetMemoryUsage());
+
+    for (int64_t id = 1; id <= 3; id++) {
+        EXPECT_EQ(0, buffer.Push(id, measurements));
+    }
+    EXPECT_EQ(3 * entry_bytes, buffer.GetMemoryUsage());
+    EXPECT_EQ(entry_bytes, buffer.Find(1)->bytes_);
+
+    // overflows like the size limit
+    EXPECT_EQ(1, buffer.Push(4, measurements));
+    EXPECT_EQ(3, buffer.GetSize());
+    EXPECT_EQ(buffer.end(), buffer.Find(1));
+
+    // small entries still fit
+    EXPECT_EQ(0, buffer.Push(5, DUMMY));
+    EXPECT_EQ(3 * entry_bytes + sizeof(BufferEntry) + Measurement::ByteSize(std::vector<Measurement>()), buffer.GetMemoryUsage());
+
+    buffer.Delete(2);
+    EXPECT_EQ(2 * entry_bytes + sizeof(BufferEntry) + Measurement::ByteSize(std::vector<Measurement>()), buffer.GetMemoryUsage());
+    buffer.Reset(ResetReason::USER);
+    EXPECT_EQ(0, buffer.GetMemoryUsage());
+
+    // an entry that can never fit is rejected
+    RingBuffer small{100, 0, true, nullptr, nullptr, nullptr, EvictionPolicy::OLDEST, nullptr, entry_bytes - 1};
+    EXPECT_THROW(small.Push(1, measurements), RingBufferException);
+
+    // all locked
+    RingBuffer locked{100, 0, true, nullptr, nullptr, nullptr, EvictionPolicy::OLDEST, nullptr, entry_bytes};
+    EXPECT_EQ(0, locked.Push(1, measurements));
+    ASSERT_EQ(1, locked.ClaimBatch(1).size());
+    EXPECT_EQ(-1, locked.Push(2, measurements));
+
+    RingBuffer no_overflow{100, 0, false, nullptr, nullptr, nullptr, EvictionPolicy::OLDEST, nullptr, entry_bytes};
+    EXPECT_EQ(0, no_overflow.Push(1, measurements));
+    EXPECT_THROW(no_overflow.Push(2, measurements), RingBufferOverflowException);
+}
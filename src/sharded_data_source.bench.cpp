@@ -0,0 +1,54 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#include <boost/thread.hpp>
+#include <data_source_factory.hpp>
+
+#include "benchmark.hpp"
+
+using namespace qds_buffer::core;
+using namespace qds_buffer::core::benchmark;
+
+namespace {
+
+/*
+* Adds 'datasets_per_producer' typed data sets from each of 'producer_count' threads (no parsing, so the buffer lock
+* dominates) and returns the throughput in data sets/s
+*/
+double RunShardedProducers(size_t shard_count, size_t producer_count, int datasets_per_producer) {
+    // counter mode 1, so concurrent producers don't need globally increasing ids
+    auto ds = DataSourceFactory::CreateDataSource(10000, 1, true, 100, 100, false, 0, shard_count);
+
+    Measurement measurement;
+    measurement.name_ = "Power";
+    measurement.type_ = MeasurementType::kDouble;
+    measurement.value_ = 2.5;
+
+    Stopwatch stopwatch;
+    boost::thread_group producers;
+    for (size_t p = 0; p < producer_count; p++) {
+        producers.create_thread([&, p]() {
+            for (int i = 0; i < datasets_per_producer; i++) {
+                int64_t id = static_cast<int64_t>(p) * datasets_per_producer + i + 1;
+                ds->Add(id, std::vector<Measurement>{measurement});
+            }
+        });
+    }
+    producers.join_all();
+
+    return producer_count * datasets_per_producer / stopwatch.ElapsedSeconds();
+}
+
+}  // namespace
+
+QDS_BENCHMARK(ShardedDataSource, Contention) {
+    const size_t producer_count = 8;
+    const int datasets_per_producer = 50000;
+
+    for (size_t shards = 1; shards <= 16; shards *= 2) {
+        std::string name = "Contention/" + std::to_string(producer_count) + " producers";
+        std::string metric = shards == 1 ? "1 shard (former)" : std::to_string(shards) + " shards";
+        Report(name, metric, RunShardedProducers(shards, producer_count, datasets_per_producer), "datasets/s");
+    }
+}
@@ -0,0 +1,645 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#include "sharded_data_source.hpp"
+
+#include <algorithm>
+#include <exception.hpp>
+
+namespace qds_buffer {
+
+namespace core {
+
+using namespace std::placeholders;
+
+ShardedDataSource::ShardedDataSource(size_t shard_count, size_t buffer_size, int8_t counter_mode, bool allow_overflow,
+                                     size_t reset_information_size, size_t deletion_information_size, bool enable_memory_info_logging,
+                                     size_t staging_queue_size, uint32_t max_age_ms, EvictionPolicy eviction_policy,
+                                     size_t max_bytes, bool compact_data_sets)
+    : kCounterMode_(counter_mode),
+      kResetInformationSize_(reset_information_size),
+      kDeletionInformationSize_(deletion_information_size),
+      max_id_(-1),
+      notifier_(std::make_shared<DataNotifier>()) {
+    reset_information_list_.exceeded_max_entries_ = false;
+
+    shard_count = std::max<size_t>(shard_count, 1);
+    size_t shard_buffer_size = std::max<size_t>((buffer_size + shard_count - 1) / shard_count, 1);
+    size_t shard_max_bytes = (max_bytes + shard_count - 1) / shard_count;
+
+    std::vector<boost::shared_mutex*> mutexes;
+    for (size_t i = 0; i < shard_count; i++) {
+        // distinct reference names for REF files of different shards
+        std::string ref_prefix = "ref-" + std::to_string(i) + "-";
+
+        shards_.emplace_back(new DataSourceInternal(shard_buffer_size, counter_mode, allow_overflow, reset_information_size,
+                                                    deletion_information_size, enable_memory_info_logging, staging_queue_size, 0,
+                                                    eviction_policy, shard_max_bytes, compact_data_sets, ref_prefix, std::bind(&ShardedDataSource::TakeReference, this, _1, _2),
+                                                    notifier_));
+
+        auto& shard_mutexes = shards_.back()->GetMergedSharedMutex().GetMutexes();
+        mutexes.insert(mutexes.end(), shard_mutexes.begin(), shard_mutexes.end());
+    }
+    buffer_mutex_.reset(new BufferSharedMutex(mutexes));
+
+    // a single reaper thread for all shards
+    if (max_age_ms > 0) {
+        retention_reaper_.reset(new RetentionReaper(max_age_ms, [this](uint64_t cutoff_ms, size_t max_n) {
+            size_t deleted = 0;
+            for (auto& shard : shards_) {
+                deleted += shard->GetRingBuffer().DeleteOlderThan(cutoff_ms, max_n);
+            }
+            return deleted;
+        }));
+    }
+}
+
+/**
+ * IDataSourceIn methods
+ */
+
+int ShardedDataSource::Add(int64_t id, boost::json::string_view json) {
+    return AddReserved(id, "ShardedDataSource::Add", [&](DataSourceInternal& shard) { return shard.Add(id, json); });
+}
+
+int ShardedDataSource::Add(int64_t id, std::vector<Measurement>&& measurements) {
+    return AddReserved(id, "ShardedDataSource::Add", [&](DataSourceInternal& shard) { return shard.Add(id, std::move(measurements)); });
+}
+
+int ShardedDataSource::AddBinary(int64_t id, const std::vector<std::uint8_t>& bytes) {
+    return AddReserved(id, "ShardedDataSource::AddBinary", [&](DataSourceInternal& shard) { return shard.AddBinary(id, bytes); });
+}
+
+std::vector<AddResult> ShardedDataSource::AddBatch(const DataSetBatch& data_sets) {
+    std::vector<AddResult> results(data_sets.size(), AddResult{-1, "", nullptr});
+
+    // split the batch by shard, keeping the order within every shard
+    std::vector<DataSetBatch> shard_batches(shards_.size());
+    std::vector<std::vector<size_t>> shard_positions(shards_.size());
+    std::vector<std::pair<size_t, size_t>> locations(data_sets.size());   // shard and position within the shard batch
+
+    for (size_t i = 0; i < data_sets.size(); i++) {
+        size_t shard = GetShardIndex(data_sets[i].first);
+        locations[i] = std::make_pair(shard, shard_batches[shard].size());
+        shard_batches[shard].push_back(data_sets[i]);
+        shard_positions[shard].push_back(i);
+    }
+
+    // parse first, so invalid data sets don't reserve their ids
+    std::vector<std::vector<std::shared_ptr<std::vector<Measurement>>>> shard_data(shards_.size());
+    std::vector<std::vector<AddResult>> shard_results(shards_.size());
+    for (size_t shard = 0; shard < shards_.size(); shard++) {
+        shard_data[shard].resize(shard_batches[shard].size());
+        shard_results[shard].assign(shard_batches[shard].size(), AddResult{-1, "", nullptr});
+        shards_[shard]->ParseBatch(shard_batches[shard], shard_data[shard], shard_results[shard]);
+    }
+
+    // in counter mode 0, reserve the ids of the valid data sets in the order of the batch; a valid data set with an id not
+    // greater than the ones before is rejected
+    int64_t previous_id = max_id_.load();
+    int64_t reserved_id = previous_id;
+    std::vector<bool> rejected(data_sets.size(), false);
+    if (kCounterMode_ == 0) {
+        do {
+            reserved_id = previous_id;
+            for (size_t i = 0; i < data_sets.size(); i++) {
+                if (!shard_data[locations[i].first][locations[i].second]) continue;
+
+                rejected[i] = data_sets[i].first <= reserved_id;
+                if (!rejected[i]) reserved_id = data_sets[i].first;
+            }
+        } while (reserved_id != previous_id && !max_id_.compare_exchange_weak(previous_id, reserved_id));
+
+        for (size_t i = 0; i < data_sets.size(); i++) {
+            if (!rejected[i]) continue;
+
+            RingBufferException e("Bad Id", "ShardedDataSource::AddBatch");
+            shard_data[locations[i].first][locations[i].second].reset();
+            shard_results[locations[i].first][locations[i].second] = AddResult{-1, e.what(), std::make_exception_ptr(e)};
+        }
+    }
+
+    int64_t stored_id = previous_id;
+    for (size_t shard = 0; shard < shards_.size(); shard++) {
+        if (shard_batches[shard].empty()) continue;
+
+        shards_[shard]->StoreBatch(shard_batches[shard], shard_data[shard], shard_results[shard]);
+        for (size_t k = 0; k < shard_results[shard].size(); k++) {
+            if (shard_results[shard][k].deletion_count_ >= 0) {
+                stored_id = std::max(stored_id, shard_batches[shard][k].first);
+            }
+            results[shard_positions[shard][k]] = std::move(shard_results[shard][k]);
+        }
+    }
+    ReleaseId(reserved_id, stored_id);
+    return results;
+}
+
+void ShardedDataSource::Flush() {
+    for (auto& shard : shards_) {
+        shard->Flush();
+    }
+}
+
+void ShardedDataSource::SetReference(const std::string& ref, const std::string& data, const std::string& data_format) {
+    // shards lock their reference map before calling TakeReference(), so don't hold references_mutex_ while asking them
+    for (auto& shard : shards_) {
+        try {
+            shard->GetReference(ref);
+        } catch (const RefException&) {
+            continue;
+        }
+        throw RefException("Reference " + ref + " exists already", "ShardedDataSource::SetRef");
+    }
+
+    boost::unique_lock<boost::shared_mutex> lock(references_mutex_);
+
+    // id = 0, the reference moves to the shard of the data set that refers to it
+    if (!references_.emplace(ref, std::make_shared<ReferenceData>(ReferenceData{0, ref, data_format, data})).second) {
+        throw RefException("Reference " + ref + " exists already", "ShardedDataSource::SetRef");
+    }
+}
+
+bool ShardedDataSource::SetPriority(int64_t id, int32_t priority) { return shards_[GetShardIndex(id)]->SetPriority(id, priority); }
+
+void ShardedDataSource::Reset(ResetReason reason) {
+    // a single reset information for all shards
+    ResetInformation reset_information{0, reason, 0, 0, 0};
+
+    for (auto& shard : shards_) {
+        shard->Reset(reason);
+
+        for (auto& shard_information : shard->AcknowledgeReset().list_) {
+            if (reset_information.deleted_datasets_count_ == 0) {
+                reset_information.oldest_dataset_time_ms_ = shard_information.oldest_dataset_time_ms_;
+            }
+            reset_information.reset_time_ms_ = std::max(reset_information.reset_time_ms_, shard_information.reset_time_ms_);
+            reset_information.oldest_dataset_time_ms_ =
+                std::min(reset_information.oldest_dataset_time_ms_, shard_information.oldest_dataset_time_ms_);
+            reset_information.newest_dataset_time_ms_ =
+                std::max(reset_information.newest_dataset_time_ms_, shard_information.newest_dataset_time_ms_);
+            reset_information.deleted_datasets_count_ += shard_information.deleted_datasets_count_;
+        }
+    }
+    max_id_ = -1;
+    std::atomic_store(&snapshot_, std::shared_ptr<const MergedSnapshot>());
+
+    if (reset_information.reset_time_ms_ == 0) {
+        // all shards were empty
+        return;
+    }
+
+    boost::unique_lock<boost::shared_mutex> lock(reset_information_list_mutex_);
+    auto& list = reset_information_list_.list_;
+    list.push_back(reset_information);
+
+    if (list.size() > kResetInformationSize_) {
+        // list has overflown, delete oldest information
+        list.pop_front();
+        reset_information_list_.exceeded_max_entries_ = true;
+    }
+}
+
+/**
+ * IDataSourceOut methods
+ */
+
+void ShardedDataSource::Delete(int64_t id) { shards_[GetShardIndex(id)]->Delete(id); }
+
+size_t ShardedDataSource::Delete(const std::vector<int64_t>& ids) {
+    std::vector<std::vector<int64_t>> shard_ids(shards_.size());
+    for (int64_t id : ids) {
+        shard_ids[GetShardIndex(id)].push_back(id);
+    }
+
+    size_t deleted = 0;
+    for (size_t shard = 0; shard < shards_.size(); shard++) {
+        if (!shard_ids[shard].empty()) {
+            deleted += shards_[shard]->Delete(shard_ids[shard]);
+        }
+    }
+    return deleted;
+}
+
+size_t ShardedDataSource::DeleteUpTo(int64_t id) {
+    size_t deleted = 0;
+    for (auto& shard : shards_) {
+        deleted += shard->DeleteUpTo(id);
+    }
+    return deleted;
+}
+
+bool ShardedDataSource::IsReset() const {
+    boost::shared_lock<boost::shared_mutex> lock(reset_information_list_mutex_);
+
+    return !reset_information_list_.list_.empty();
+}
+
+ResetInformationList ShardedDataSource::AcknowledgeReset() {
+    boost::unique_lock<boost::shared_mutex> lock(reset_information_list_mutex_);
+
+    // create a copy to return
+    ResetInformationList list = reset_information_list_;
+
+    // clear member
+    reset_information_list_ = {{}, false};
+
+    return list;
+}
+
+bool ShardedDataSource::IsOverflown() const {
+    for (auto& shard : shards_) {
+        if (shard->IsOverflown()) return true;
+    }
+    return false;
+}
+
+DeletionInformationList ShardedDataSource::AcknowledgeOverflow() {
+    DeletionInformationList list{{}, false};
+
+    for (auto& shard : shards_) {
+        auto shard_list = shard->AcknowledgeOverflow();
+        list.exceeded_max_entries_ |= shard_list.exceeded_max_entries_;
+        list.list_.insert(list.list_.end(), shard_list.list_.begin(), shard_list.list_.end());
+    }
+
+    // merge the shard lists in order of deletion, keep the newest
+    std::stable_sort(list.list_.begin(), list.list_.end(), [](const DeletionInformation& a, const DeletionInformation& b) {
+        return a.deletion_time_ms_ < b.deletion_time_ms_;
+    });
+    while (list.list_.size() > kDeletionInformationSize_) {
+        list.list_.pop_front();
+        list.exceeded_max_entries_ = true;
+    }
+    return list;
+}
+
+bool ShardedDataSource::GetAllowOverflow() const { return shards_.front()->GetAllowOverflow(); }
+boost::shared_mutex& ShardedDataSource::GetBufferSharedMutex() const {
+    throw RingBufferException("Every shard has its own buffer, use GetMergedSharedMutex()", "ShardedDataSource::GetBufferSharedMutex");
+}
+
+BufferQueueType::iterator ShardedDataSource::begin() {
+    throw RingBufferException("Every shard has its own buffer, use MergedBegin()", "ShardedDataSource::begin");
+}
+
+BufferQueueType::iterator ShardedDataSource::end() {
+    throw RingBufferException("Every shard has its own buffer, use MergedEnd()", "ShardedDataSource::end");
+}
+
+BufferQueueType::iterator ShardedDataSource::Find(int64_t) {
+    throw RingBufferException("Every shard has its own buffer, use MergedFind()", "ShardedDataSource::Find");
+}
+
+BufferSharedMutex& ShardedDataSource::GetMergedSharedMutex() const { return *buffer_mutex_; }
+
+BufferIterator ShardedDataSource::MergedBegin() {
+    // must lock mutex via GetMergedSharedMutex() before calling MergedBegin() and MergedEnd()
+    return BufferIterator(GetRanges());
+}
+
+BufferIterator ShardedDataSource::MergedEnd() {
+    // must lock mutex via GetMergedSharedMutex() before calling MergedBegin() and MergedEnd()
+    return BufferIterator();
+}
+
+BufferIterator ShardedDataSource::MergedFind(int64_t id) {
+    // must lock mutex via GetMergedSharedMutex() before calling MergedFind()
+    size_t shard = GetShardIndex(id);
+    RingBuffer& buffer = shards_[shard]->GetRingBuffer();
+
+    auto it = buffer.Find(id);
+    return it != buffer.end() ? BufferIterator(GetRanges(), shard, it) : BufferIterator();
+}
+
+BufferSnapshot ShardedDataSource::GetSnapshot() {
+    std::vector<BufferSnapshot> shard_snapshots;
+    shard_snapshots.reserve(shards_.size());
+    for (auto& shard : shards_) {
+        shard_snapshots.push_back(shard->GetSnapshot());
+    }
+
+    // reuse the merged snapshot as long as no shard has changed
+    auto snapshot = std::atomic_load(&snapshot_);
+    if (snapshot && snapshot->shard_snapshots_ == shard_snapshots) {
+        return snapshot->entries_;
+    }
+
+    size_t size = 0;
+    for (auto& shard_snapshot : shard_snapshots) {
+        size += shard_snapshot->size();
+    }
+    SnapshotView::Chunk entries;
+    entries.reserve(size);
+
+    // merge by id, like BufferIterator; no shard is locked
+    std::vector<std::pair<SnapshotView::const_iterator, SnapshotView::const_iterator>> positions;
+    for (auto& shard_snapshot : shard_snapshots) {
+        positions.emplace_back(shard_snapshot->begin(), shard_snapshot->end());
+    }
+    for (size_t n = 0; n < size; n++) {
+        size_t next = positions.size();
+        for (size_t i = 0; i < positions.size(); i++) {
+            if (positions[i].first == positions[i].second) continue;
+            if (next == positions.size() || positions[i].first->id_ < positions[next].first->id_) {
+                next = i;
+            }
+        }
+        entries.push_back(*positions[next].first++);
+    }
+
+    auto merged = std::make_shared<const SnapshotView>(std::move(entries));
+    std::atomic_store(&snapshot_, std::shared_ptr<const MergedSnapshot>(new MergedSnapshot{shard_snapshots, merged}));
+    return merged;
+}
+
+std::vector<DataSetHandle> ShardedDataSource::ReadSince(int64_t last_id, size_t max_n) {
+    std::vector<DataSetHandle> handles;
+    for (auto& shard : shards_) {
+        auto shard_handles = shard->ReadSince(last_id, max_n);
+        handles.insert(handles.end(), shard_handles.begin(), shard_handles.end());
+    }
+
+    // every shard returns its max_n oldest, so the max_n oldest of all shards are among them
+    std::sort(handles.begin(), handles.end(), [](const DataSetHandle& a, const DataSetHandle& b) { return a.id_ < b.id_; });
+    if (handles.size() > max_n) {
+        handles.erase(handles.begin() + max_n, handles.end());
+    }
+    return handles;
+}
+
+std::vector<DataSetHandle> ShardedDataSource::ReadTimeRange(uint64_t from_ms, uint64_t to_ms, size_t max_n) {
+    std::vector<DataSetHandle> handles;
+    for (auto& shard : shards_) {
+        auto shard_handles = shard->ReadTimeRange(from_ms, to_ms, max_n);
+        handles.insert(handles.end(), shard_handles.begin(), shard_handles.end());
+    }
+
+    std::sort(handles.begin(), handles.end(), [](const DataSetHandle& a, const DataSetHandle& b) {
+        return a.timestamp_ms_ != b.timestamp_ms_ ? a.timestamp_ms_ < b.timestamp_ms_ : a.id_ < b.id_;
+    });
+    if (handles.size() > max_n) {
+        handles.erase(handles.begin() + max_n, handles.end());
+    }
+    return handles;
+}
+
+std::vector<BufferEntry> ShardedDataSource::ClaimBatch(size_t max_n, uint32_t lease_ms) {
+    if (max_n == 0) return {};
+
+    // the oldest unclaimed ids of all shards determine the greatest id to claim
+    std::vector<int64_t> ids;
+    for (auto& shard : shards_) {
+        auto shard_ids = shard->GetRingBuffer().PeekUnlocked(max_n);
+        ids.insert(ids.end(), shard_ids.begin(), shard_ids.end());
+    }
+    if (ids.empty()) return {};
+
+    size_t n = std::min(max_n, ids.size());
+    std::nth_element(ids.begin(), ids.begin() + (n - 1), ids.end());
+    int64_t max_id = ids[n - 1];
+
+    std::vector<BufferEntry> claimed;
+    for (auto& shard : shards_) {
+        auto shard_claimed = shard->GetRingBuffer().ClaimBatch(max_n - claimed.size(), lease_ms, max_id);
+        claimed.insert(claimed.end(), shard_claimed.begin(), shard_claimed.end());
+    }
+    std::sort(claimed.begin(), claimed.end(), [](const BufferEntry& a, const BufferEntry& b) { return a.id_ < b.id_; });
+    return claimed;
+}
+
+size_t ShardedDataSource::Release(const std::vector<int64_t>& ids) {
+    std::vector<std::vector<int64_t>> shard_ids(shards_.size());
+    for (int64_t id : ids) {
+        shard_ids[GetShardIndex(id)].push_back(id);
+    }
+
+    size_t released = 0;
+    for (size_t shard = 0; shard < shards_.size(); shard++) {
+        if (!shard_ids[shard].empty()) {
+            released += shards_[shard]->Release(shard_ids[shard]);
+        }
+    }
+    return released;
+}
+
+bool ShardedDataSource::WaitForNewData(int64_t after_id, uint32_t timeout_ms) {
+    if (kCounterMode_ == 0) {
+        return notifier_->Wait(after_id, timeout_ms);
+    }
+
+    // counter mode 1: wait for an entry added to any shard after the one with after_id (see RingBuffer::WaitForNewData());
+    // the current sequence number is taken first, so entries added while looking at the shards wake up
+    uint64_t sequence = notifier_->GetSequence();
+    if (!shards_[GetShardIndex(after_id)]->GetRingBuffer().GetSequence(after_id, sequence) && GetSize() > 0) {
+        return true;
+    }
+    return notifier_->WaitForSequence(sequence, timeout_ms);
+}
+
+void ShardedDataSource::RegisterConsumerGroup(const std::string& group) {
+    for (auto& shard : shards_) {
+        shard->RegisterConsumerGroup(group);
+    }
+}
+
+void ShardedDataSource::UnregisterConsumerGroup(const std::string& group) {
+    for (auto& shard : shards_) {
+        shard->UnregisterConsumerGroup(group);
+    }
+}
+
+std::vector<BufferEntry> ShardedDataSource::ReadGroup(const std::string& group, size_t max_n) {
+    if (max_n == 0) return {};
+
+    // like ClaimBatch(): the next ids of all shards determine the greatest id to read
+    std::vector<int64_t> ids;
+    for (auto& shard : shards_) {
+        auto shard_ids = shard->GetRingBuffer().PeekGroup(group, max_n);
+        ids.insert(ids.end(), shard_ids.begin(), shard_ids.end());
+    }
+    if (ids.empty()) return {};
+
+    size_t n = std::min(max_n, ids.size());
+    std::nth_element(ids.begin(), ids.begin() + (n - 1), ids.end());
+    int64_t max_id = ids[n - 1];
+
+    std::vector<BufferEntry> entries;
+    for (auto& shard : shards_) {
+        auto shard_entries = shard->GetRingBuffer().ReadGroup(group, max_n - entries.size(), max_id);
+        entries.insert(entries.end(), shard_entries.begin(), shard_entries.end());
+    }
+    std::sort(entries.begin(), entries.end(), [](const BufferEntry& a, const BufferEntry& b) { return a.id_ < b.id_; });
+    return entries;
+}
+
+size_t ShardedDataSource::AcknowledgeGroup(const std::string& group, const std::vector<int64_t>& ids) {
+    std::vector<std::vector<int64_t>> shard_ids(shards_.size());
+    for (int64_t id : ids) {
+        shard_ids[GetShardIndex(id)].push_back(id);
+    }
+
+    // every shard checks the group, even without ids
+    size_t acknowledged = 0;
+    for (size_t shard = 0; shard < shards_.size(); shard++) {
+        acknowledged += shards_[shard]->AcknowledgeGroup(group, shard_ids[shard]);
+    }
+    return acknowledged;
+}
+
+uint64_t ShardedDataSource::GetExpiredLeaseCount() const {
+    uint64_t count = 0;
+    for (auto& shard : shards_) {
+        count += shard->GetExpiredLeaseCount();
+    }
+    return count;
+}
+
+std::shared_ptr<const ReferenceData> ShardedDataSource::GetReference(const std::string& ref) const {
+    {
+        boost::shared_lock<boost::shared_mutex> lock(references_mutex_);
+
+        auto it = references_.find(ref);
+        if (it != references_.end()) {
+            return it->second;
+        }
+    }
+
+    for (auto& shard : shards_) {
+        try {
+            return shard->GetReference(ref);
+        } catch (const RefException&) {
+        }
+    }
+
+    throw RefException("Reference " + ref + " not found", "ShardedDataSource::GetRef");
+}
+
+/**
+ * shared methods
+ */
+
+size_t ShardedDataSource::GetSize() const {
+    size_t size = 0;
+    for (auto& shard : shards_) {
+        size += shard->GetSize();
+    }
+    return size;
+}
+
+size_t ShardedDataSource::GetMaxSize() const {
+    size_t size = 0;
+    for (auto& shard : shards_) {
+        size += shard->GetMaxSize();
+    }
+    return size;
+}
+
+int64_t ShardedDataSource::GetLastId() const {
+    int64_t id = -1;
+    if (kCounterMode_ == 0) {
+        for (auto& shard : shards_) {
+            id = std::max(id, shard->GetLastId());
+        }
+        return id;
+    }
+
+    // counter mode 1: the entry added last, like a single buffer
+    uint64_t sequence = 0;
+    for (auto& shard : shards_) {
+        uint64_t shard_sequence;
+        int64_t shard_id = shard->GetRingBuffer().GetLastId(shard_sequence);
+        if (shard_id >= 0 && shard_sequence >= sequence) {
+            id = shard_id;
+            sequence = shard_sequence;
+        }
+    }
+    return id;
+}
+
+int8_t ShardedDataSource::GetCounterMode() const { return kCounterMode_; }
+size_t ShardedDataSource::GetDeletionInformationSize() const { return kDeletionInformationSize_; }
+size_t ShardedDataSource::GetResetInformationSize() const { return kResetInformationSize_; }
+bool ShardedDataSource::GetEnableMemoryInfoLogging() const { return shards_.front()->GetEnableMemoryInfoLogging(); }
+size_t ShardedDataSource::GetStagingQueueSize() const { return shards_.front()->GetStagingQueueSize(); }
+size_t ShardedDataSource::GetShardCount() const { return shards_.size(); }
+uint32_t ShardedDataSource::GetMaxAgeMs() const { return retention_reaper_ ? retention_reaper_->GetMaxAgeMs() : 0; }
+EvictionPolicy ShardedDataSource::GetEvictionPolicy() const { return shards_.front()->GetEvictionPolicy(); }
+size_t ShardedDataSource::GetMaxBytes() const { return shards_.front()->GetMaxBytes() * shards_.size(); }
+
+bool ShardedDataSource::GetCompactDataSets() const { return shards_.front()->GetCompactDataSets(); }
+
+size_t ShardedDataSource::GetMemoryUsage() const {
+    size_t bytes = 0;
+    for (auto& shard : shards_) {
+        bytes += shard->GetMemoryUsage();
+    }
+    return bytes;
+}
+
+/**
+ * private methods
+ */
+
+size_t ShardedDataSource::GetShardIndex(int64_t id) const { return static_cast<size_t>(static_cast<uint64_t>(id) % shards_.size()); }
+
+int64_t ShardedDataSource::ReserveId(int64_t id, const std::string& scope) {
+    int64_t max_id = max_id_.load();
+    if (kCounterMode_ != 0) return max_id;
+
+    // concurrent producers adding to different shards must not both pass the check
+    do {
+        if (id <= max_id) {
+            throw RingBufferException("Bad Id", scope);
+        }
+    } while (!max_id_.compare_exchange_weak(max_id, id));
+    return max_id;
+}
+
+void ShardedDataSource::ReleaseId(int64_t reserved_id, int64_t stored_id) {
+    // fails if a greater id was reserved meanwhile; the ids in between stay unusable then
+    if (kCounterMode_ == 0 && stored_id < reserved_id) {
+        max_id_.compare_exchange_strong(reserved_id, stored_id);
+    }
+}
+
+int ShardedDataSource::AddReserved(int64_t id, const std::string& scope, const std::function<int(DataSourceInternal&)>& add) {
+    int64_t previous_id = ReserveId(id, scope);
+
+    int deletion_count = -1;
+    try {
+        deletion_count = add(*shards_[GetShardIndex(id)]);
+    } catch (...) {
+        ReleaseId(id, previous_id);
+        throw;
+    }
+    if (deletion_count < 0) {
+        ReleaseId(id, previous_id);
+    }
+    return deletion_count;
+}
+
+std::vector<BufferIterator::Range> ShardedDataSource::GetRanges() {
+    std::vector<BufferIterator::Range> ranges;
+    ranges.reserve(shards_.size());
+    for (auto& shard : shards_) {
+        RingBuffer& buffer = shard->GetRingBuffer();
+        ranges.emplace_back(buffer.begin(), buffer.end());
+    }
+    return ranges;
+}
+
+bool ShardedDataSource::TakeReference(const std::string& ref, std::shared_ptr<ReferenceData>& data) {
+    boost::unique_lock<boost::shared_mutex> lock(references_mutex_);
+
+    auto it = references_.find(ref);
+    if (it == references_.end()) {
+        return false;
+    }
+    data = std::move(it->second);
+    references_.erase(it);
+    return true;
+}
+}  // namespace core
+}  // namespace qds_buffer
@@ -0,0 +1,147 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/thread.hpp>
+#include <i_data_source_in_out.hpp>
+
+#include "data_source_internal.hpp"
+#include "retention_reaper.hpp"
+
+namespace qds_buffer {
+
+namespace core {
+
+/**
+ * Thread-Safe
+ *
+ * Data source that partitions its entries by id (id modulo shard count) across several DataSourceInternal shards. Every
+ * shard has its own buffer lock, reference map and deletion information, so producers adding to different shards don't
+ * contend. Consumers lock all shards via GetMergedSharedMutex() and iterate the entries merged by id (MergedBegin()); the
+ * single-buffer methods GetBufferSharedMutex(), begin(), end() and Find() throw.
+ *
+ * Differences to a single DataSourceInternal:
+ * - the buffer size and the maximum memory usage are split evenly across the shards; an overflow discards unlocked entries
+ *   of the affected shard only (chosen by the eviction policy among the entries of that shard)
+ * - in counter mode 0, an id must be greater than all ids added before (across all shards); an id is reserved before it is
+ *   stored, so concurrent producers can't store a lower id after a greater one. An id that fails to be stored is released
+ *   again unless a greater one was reserved meanwhile.
+ * - in counter mode 0, GetLastId() returns the greatest of the last ids of the shards; in counter mode 1 the id added last
+ * - references set via SetReference() are kept here until a data set refers to them, then they move to its shard
+ */
+class ShardedDataSource : public IDataSourceInOut {
+   public:
+    ShardedDataSource(size_t shard_count, size_t buffer_size = 100, int8_t counter_mode = 0, bool allow_overflow = true,
+                      size_t reset_information_size = 100, size_t deletion_information_size = 100, bool enable_memory_info_logging = false,
+                      size_t staging_queue_size = 0, uint32_t max_age_ms = 0, EvictionPolicy eviction_policy = EvictionPolicy::OLDEST,
+                      size_t max_bytes = 0, bool compact_data_sets = false);
+    virtual ~ShardedDataSource() = default;
+
+    // IDataSourceIn methods
+    virtual int Add(int64_t id, boost::json::string_view json) override;
+    virtual int Add(int64_t id, std::vector<Measurement>&& measurements) override;
+    virtual int AddBinary(int64_t id, const std::vector<std::uint8_t>& bytes) override;
+    virtual std::vector<AddResult> AddBatch(const DataSetBatch& data_sets) override;
+    virtual void Flush() override;
+    virtual void SetReference(const std::string& ref, const std::string& data, const std::string& data_format) override;
+    virtual bool SetPriority(int64_t id, int32_t priority) override;
+    virtual void Reset(ResetReason reason) override;
+    // /IDataSourceIn methods
+
+    // IDataSourceOut methods
+    virtual void Delete(int64_t id) override;
+    virtual size_t Delete(const std::vector<int64_t>& ids) override;
+    virtual size_t DeleteUpTo(int64_t id) override;
+    virtual bool IsReset() const override;
+    virtual ResetInformationList AcknowledgeReset() override;
+
+    virtual bool IsOverflown() const override;
+    virtual DeletionInformationList AcknowledgeOverflow() override;
+    virtual bool GetAllowOverflow() const override;
+    virtual boost::shared_mutex& GetBufferSharedMutex() const override;
+    virtual BufferQueueType::iterator begin() override;
+    virtual BufferQueueType::iterator end() override;
+    virtual BufferQueueType::iterator Find(int64_t id) override;
+    virtual BufferSharedMutex& GetMergedSharedMutex() const override;
+    virtual BufferIterator MergedBegin() override;
+    virtual BufferIterator MergedEnd() override;
+    virtual BufferIterator MergedFind(int64_t id) override;
+    virtual BufferSnapshot GetSnapshot() override;
+    virtual std::vector<DataSetHandle> ReadSince(int64_t last_id, size_t max_n) override;
+    virtual std::vector<DataSetHandle> ReadTimeRange(uint64_t from_ms, uint64_t to_ms, size_t max_n) override;
+    virtual std::vector<BufferEntry> ClaimBatch(size_t max_n, uint32_t lease_ms = 0) override;
+    virtual size_t Release(const std::vector<int64_t>& ids) override;
+    virtual uint64_t GetExpiredLeaseCount() const override;
+    virtual bool WaitForNewData(int64_t after_id, uint32_t timeout_ms) override;
+    virtual void RegisterConsumerGroup(const std::string& group) override;
+    virtual void UnregisterConsumerGroup(const std::string& group) override;
+    virtual std::vector<BufferEntry> ReadGroup(const std::string& group, size_t max_n) override;
+    virtual size_t AcknowledgeGroup(const std::string& group, const std::vector<int64_t>& ids) override;
+
+    virtual std::shared_ptr<const ReferenceData> GetReference(const std::string& ref) const override;
+    // /IDataSourceOut methods
+
+    // shared methods
+    virtual size_t GetSize() const override;
+    virtual size_t GetMaxSize() const override;
+    virtual int64_t GetLastId() const override;
+    virtual int8_t GetCounterMode() const override;
+    virtual size_t GetDeletionInformationSize() const override;
+    virtual size_t GetResetInformationSize() const override;
+    virtual bool GetEnableMemoryInfoLogging() const override;
+    virtual size_t GetStagingQueueSize() const override;
+    virtual size_t GetShardCount() const override;
+    virtual uint32_t GetMaxAgeMs() const override;
+    virtual EvictionPolicy GetEvictionPolicy() const override;
+    virtual size_t GetMaxBytes() const override;
+    virtual bool GetCompactDataSets() const override;
+    virtual size_t GetMemoryUsage() const override;
+    // /shared methods
+
+   private:
+    size_t GetShardIndex(int64_t id) const;
+    // in counter mode 0, atomically raises max_id_ to the id before it is stored; throws if the id is not greater than all ids
+    // added or reserved before. Returns the previous max_id_.
+    int64_t ReserveId(int64_t id, const std::string& scope);
+    // lowers max_id_ from a reserved id to the greatest id actually stored, unless a greater id was reserved meanwhile
+    void ReleaseId(int64_t reserved_id, int64_t stored_id);
+    // adds a data set to its shard with a reserved id
+    int AddReserved(int64_t id, const std::string& scope, const std::function<int(DataSourceInternal&)>& add);
+    std::vector<BufferIterator::Range> GetRanges();
+    bool TakeReference(const std::string& ref, std::shared_ptr<ReferenceData>& data);
+
+    const int8_t kCounterMode_;
+    const size_t kResetInformationSize_;
+    const size_t kDeletionInformationSize_;
+
+    std::vector<std::unique_ptr<DataSourceInternal>> shards_;
+    std::unique_ptr<BufferSharedMutex> buffer_mutex_;   // mutexes of all shards
+    std::atomic<int64_t> max_id_;                       // greatest id reserved since the last reset (-1 = none)
+    std::shared_ptr<DataNotifier> notifier_;            // shared by all shards
+
+    // merged snapshot and the shard snapshots it was built from; replaced as a whole (std::atomic_load/std::atomic_store)
+    struct MergedSnapshot {
+        std::vector<BufferSnapshot> shard_snapshots_;
+        BufferSnapshot entries_;
+    };
+    std::shared_ptr<const MergedSnapshot> snapshot_;
+
+    mutable boost::shared_mutex references_mutex_;
+    std::unordered_map<std::string, std::shared_ptr<ReferenceData>> references_;   // set, but not yet referred to by a data set
+
+    ResetInformationList reset_information_list_;
+    mutable boost::shared_mutex reset_information_list_mutex_;
+
+    // declared last: reaps the shards, has to stop first
+    std::unique_ptr<RetentionReaper> retention_reaper_;   // null if the age is unlimited
+};
+}  // namespace core
+}  // namespace qds_buffer
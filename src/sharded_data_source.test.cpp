@@ -0,0 +1,460 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <limits>
+#include <thread>
+
+#include <boost/thread.hpp>
+#include <data_source_factory.hpp>
+#include <exception.hpp>
+
+#include "sharded_data_source.hpp"
+
+using namespace qds_buffer::core;
+
+#define DUMMY_JSON "{\"NAME\":\"a\",\"TYPE\":\"STRING\",\"VALUE\":\"\"}"
+
+TEST(ShardedDataSourceTest, Factory) {
+    auto ds = DataSourceFactory::CreateDataSource(100, 0, true, 100, 100, false, 0, 4);
+    EXPECT_EQ(4, ds->GetShardCount());
+    EXPECT_EQ(100, ds->GetMaxSize());
+
+    EXPECT_EQ(1, DataSourceFactory::CreateDataSource()->GetShardCount());
+}
+
+TEST(ShardedDataSourceTest, Add) {
+    ShardedDataSource ds{4, 100};
+
+    EXPECT_EQ(-1, ds.GetLastId());
+    for (int64_t id = 1; id <= 10; id++) {
+        EXPECT_EQ(0, ds.Add(id, DUMMY_JSON));
+    }
+    EXPECT_EQ(10, ds.GetSize());
+    EXPECT_EQ(10, ds.GetLastId());
+
+    // counter mode 0: ids must increase across all shards
+    EXPECT_THROW(ds.Add(10, DUMMY_JSON), RingBufferException);
+    EXPECT_THROW(ds.Add(7, DUMMY_JSON), RingBufferException);
+    EXPECT_THROW(ds.Add(11, "{\"NAME\":a\",\"TYPE\":\"STRING\",\"VALUE\":\"\"}"), ParsingException);
+    EXPECT_EQ(0, ds.Add(11, DUMMY_JSON));   // not taken by the failed Add
+
+    ds.Delete(11);
+    ds.Delete(4);
+    EXPECT_EQ(9, ds.GetSize());
+    EXPECT_EQ(10, ds.GetLastId());
+}
+
+TEST(ShardedDataSourceTest, MergedIteration) {
+    ShardedDataSource ds{3, 100};
+
+    for (int64_t id = 1; id <= 20; id++) {
+        if (id % 4 == 0) continue;
+        ds.Add(id, DUMMY_JSON);
+    }
+
+    boost::shared_lock<BufferSharedMutex> lock(ds.GetMergedSharedMutex());
+    std::vector<int64_t> ids;
+    for (auto it = ds.MergedBegin(); it != ds.MergedEnd(); ++it) {
+        ids.push_back(it->id_);
+    }
+    ASSERT_EQ(15, ids.size());
+    EXPECT_TRUE(std::is_sorted(ids.begin(), ids.end()));
+
+    // Find continues in id order
+    auto it = ds.MergedFind(6);
+    ASSERT_NE(ds.MergedEnd(), it);
+    EXPECT_EQ(6, it->id_);
+    EXPECT_EQ(7, (++it)->id_);
+    EXPECT_EQ(9, (++it)->id_);
+    EXPECT_EQ(10, (it + 1)->id_);
+    EXPECT_EQ(ds.MergedEnd(), ds.MergedFind(8));
+    EXPECT_EQ(ds.MergedEnd(), ds.MergedFind(21));
+
+    it = ds.MergedFind(19);
+    EXPECT_EQ(ds.MergedEnd(), ++it);
+
+    // there is no single buffer to iterate
+    EXPECT_THROW(ds.GetBufferSharedMutex(), RingBufferException);
+    EXPECT_THROW(ds.begin(), RingBufferException);
+    EXPECT_THROW(ds.Find(6), RingBufferException);
+}
+
+TEST(ShardedDataSourceTest, Overflow) {
+    ShardedDataSource ds{2, 4};
+    EXPECT_EQ(4, ds.GetMaxSize());
+
+    for (int64_t id = 1; id <= 6; id++) {
+        ds.Add(id, DUMMY_JSON);
+    }
+    EXPECT_EQ(4, ds.GetSize());
+    EXPECT_TRUE(ds.IsOverflown());
+
+    auto info = ds.AcknowledgeOverflow();
+    EXPECT_EQ(2, info.list_.size());
+    EXPECT_FALSE(ds.IsOverflown());
+
+    // the oldest entry of each shard was discarded
+    boost::shared_lock<BufferSharedMutex> lock(ds.GetMergedSharedMutex());
+    std::vector<int64_t> ids;
+    for (auto it = ds.MergedBegin(); it != ds.MergedEnd(); ++it) {
+        ids.push_back(it->id_);
+    }
+    EXPECT_EQ((std::vector<int64_t>{3, 4, 5, 6}), ids);
+}
+
+TEST(ShardedDataSourceTest, Reset) {
+    ShardedDataSource ds{4, 100};
+
+    ds.Reset(ResetReason::USER);
+    EXPECT_FALSE(ds.IsReset());
+
+    for (int64_t id = 1; id <= 10; id++) {
+        ds.Add(id, DUMMY_JSON);
+    }
+    ds.Reset(ResetReason::USER);
+    EXPECT_EQ(0, ds.GetSize());
+    EXPECT_TRUE(ds.IsReset());
+
+    // one reset information for all shards
+    auto info = ds.AcknowledgeReset();
+    ASSERT_EQ(1, info.list_.size());
+    EXPECT_EQ(10, info.list_.front().deleted_datasets_count_);
+    EXPECT_EQ(ResetReason::USER, info.list_.front().reset_reason);
+    EXPECT_LE(info.list_.front().oldest_dataset_time_ms_, info.list_.front().newest_dataset_time_ms_);
+
+    // ids start over after a reset
+    EXPECT_NO_THROW(ds.Add(1, DUMMY_JSON));
+}
+
+TEST(ShardedDataSourceTest, AddBatch) {
+    ShardedDataSource ds{4, 100};
+
+    ds.Add(2, DUMMY_JSON);
+    auto results = ds.AddBatch({{1, DUMMY_JSON}, {3, DUMMY_JSON}, {4, "{\"NAME\":a\"}"}, {5, DUMMY_JSON}, {5, DUMMY_JSON}});
+    ASSERT_EQ(5, results.size());
+    EXPECT_NE("", results[0].error_);   // Bad Id
+    EXPECT_THROW(std::rethrow_exception(results[0].exception_), RingBufferException);
+    EXPECT_EQ(0, results[1].deletion_count_);
+    EXPECT_THROW(std::rethrow_exception(results[2].exception_), ParsingException);
+    EXPECT_EQ(0, results[3].deletion_count_);
+    EXPECT_THROW(std::rethrow_exception(results[4].exception_), RingBufferException);
+
+    EXPECT_EQ(3, ds.GetSize());
+    EXPECT_EQ(5, ds.GetLastId());
+
+    // an invalid data set doesn't reserve its id, ids of valid data sets must increase within the batch
+    results = ds.AddBatch({{9, "{\"NAME\":a\"}"}, {7, DUMMY_JSON}, {6, DUMMY_JSON}});
+    EXPECT_THROW(std::rethrow_exception(results[0].exception_), ParsingException);
+    EXPECT_EQ(0, results[1].deletion_count_);
+    EXPECT_THROW(std::rethrow_exception(results[2].exception_), RingBufferException);
+    EXPECT_EQ(0, ds.Add(8, DUMMY_JSON));
+    EXPECT_EQ(5, ds.GetSize());
+}
+
+TEST(ShardedDataSourceTest, References) {
+    ShardedDataSource ds{4, 4};
+
+    ds.SetReference("ref-123", "testdata", "abc");
+    EXPECT_THROW(ds.SetReference("ref-123", "testdata", "abc"), RefException); // exists already
+    auto pending = ds.GetReference("ref-123");
+    EXPECT_EQ(0, pending->id_);
+
+    // the reference moves to the shard of the data set; the one returned before stays valid
+    ds.Add(6, "{\"NAME\":\"a\",\"TYPE\":\"REF\",\"VALUE\":\"ref-123\"}");
+    EXPECT_EQ(0, pending->id_);
+    EXPECT_EQ("testdata", pending->content_);
+    EXPECT_EQ(6, ds.GetReference("ref-123")->id_);
+    EXPECT_EQ("testdata", ds.GetReference("ref-123")->content_);
+    EXPECT_THROW(ds.SetReference("ref-123", "testdata", "abc"), RefException);
+    EXPECT_THROW(ds.Add(7, "{\"NAME\":\"a\",\"TYPE\":\"REF\",\"VALUE\":\"ref-123\"}"), RefException);
+
+    // REF files get names that are unique across shards
+    for (int64_t id = 8; id <= 9; id++) {
+        std::ofstream file("ShardedDataSourceTest.data");
+        file << "testdata";
+        file.close();
+        ds.Add(id, "{\"NAME\":\"a\",\"TYPE\":\"REF\",\"VALUE\":\"ShardedDataSourceTest.data\"}");
+    }
+    EXPECT_EQ(8, ds.GetReference("ref-0-0")->id_);
+    EXPECT_EQ(9, ds.GetReference("ref-1-0")->id_);
+
+    // deleted together with the data set
+    ds.Delete(6);
+    EXPECT_THROW(ds.GetReference("ref-123"), RefException);
+    ds.Reset(ResetReason::USER);
+    EXPECT_THROW(ds.GetReference("ref-0-0"), RefException);
+}
+
+TEST(ShardedDataSourceTest, ConcurrentAdd) {
+    const int producer_count = 8;
+    const int datasets_per_producer = 500;
+    ShardedDataSource ds{4, producer_count * datasets_per_producer, 1};
+
+    boost::thread_group producers;
+    for (int p = 0; p < producer_count; p++) {
+        producers.create_thread([&ds, p]() {
+            for (int i = 0; i < datasets_per_producer; i++) {
+                int64_t id = p * datasets_per_producer + i + 1;
+                ds.Add(id, "{\"NAME\":\"id\",\"TYPE\":\"LONG\",\"VALUE\":" + std::to_string(id) + "}");
+            }
+        });
+    }
+
+    // consumer iterates concurrently
+    for (int i = 0; i < 50; i++) {
+        boost::shared_lock<BufferSharedMutex> lock(ds.GetMergedSharedMutex());
+        size_t count = 0;
+        for (auto it = ds.MergedBegin(); it != ds.MergedEnd(); ++it) {
+            EXPECT_EQ(it->id_, boost::get<std::int64_t>(it->measurements_->front().value_));
+            count++;
+        }
+        EXPECT_LE(count, producer_count * datasets_per_producer);
+    }
+    producers.join_all();
+
+    EXPECT_EQ(producer_count * datasets_per_producer, ds.GetSize());
+}
+
+TEST(ShardedDataSourceTest, ConcurrentAddCounterMode0) {
+    const int producer_count = 8;
+    const int datasets_per_producer = 500;
+    ShardedDataSource ds{4, producer_count * datasets_per_producer};
+
+    // producers draw ids from a shared counter; an id drawn before a greater one may arrive too late and is rejected
+    std::atomic<int64_t> next_id(1);
+    std::atomic<int> rejected(0);
+    std::atomic<int64_t> max_stored_id(-1);
+
+    boost::thread_group producers;
+    for (int p = 0; p < producer_count; p++) {
+        producers.create_thread([&]() {
+            for (int i = 0; i < datasets_per_producer; i++) {
+                int64_t id = next_id++;
+                try {
+                    ds.Add(id, DUMMY_JSON);
+                } catch (const RingBufferException&) {
+                    rejected++;
+                    continue;
+                }
+                int64_t max_id = max_stored_id.load();
+                while (id > max_id && !max_stored_id.compare_exchange_weak(max_id, id)) {
+                }
+            }
+        });
+    }
+    producers.join_all();
+
+    EXPECT_EQ(producer_count * datasets_per_producer, ds.GetSize() + rejected);
+    EXPECT_EQ(max_stored_id.load(), ds.GetLastId());
+    EXPECT_THROW(ds.Add(ds.GetLastId(), DUMMY_JSON), RingBufferException);
+}
+
+TEST(ShardedDataSourceTest, GetSnapshot) {
+    ShardedDataSource ds{3, 100};
+
+    for (int64_t id = 1; id <= 10; id++) {
+        ds.Add(id, DUMMY_JSON);
+    }
+    auto snapshot = ds.GetSnapshot();
+    EXPECT_EQ(snapshot, ds.GetSnapshot()); // unchanged shards, shared copy
+
+    ds.Delete(5);
+    ds.Add(11, DUMMY_JSON);
+
+    // merged by id
+    std::vector<int64_t> ids;
+    for (const BufferEntry& entry : *snapshot) {
+        ids.push_back(entry.id_);
+    }
+    EXPECT_EQ((std::vector<int64_t>{1, 2, 3, 4, 5, 6, 7, 8, 9, 10}), ids);
+
+    ids.clear();
+    for (const BufferEntry& entry : *ds.GetSnapshot()) {
+        ids.push_back(entry.id_);
+    }
+    EXPECT_EQ((std::vector<int64_t>{1, 2, 3, 4, 6, 7, 8, 9, 10, 11}), ids);
+}
+
+TEST(ShardedDataSourceTest, ClaimBatch) {
+    ShardedDataSource ds{3, 100};
+
+    for (int64_t id = 1; id <= 10; id++) {
+        ds.Add(id, DUMMY_JSON);
+    }
+
+    // the oldest across all shards
+    auto claimed = ds.ClaimBatch(4);
+    ASSERT_EQ(4, claimed.size());
+    for (int64_t i = 0; i < 4; i++) {
+        EXPECT_EQ(i + 1, claimed[i].id_);
+    }
+    claimed = ds.ClaimBatch(4);
+    ASSERT_EQ(4, claimed.size());
+    EXPECT_EQ(5, claimed.front().id_);
+
+    EXPECT_EQ(2, ds.Release({2, 6}));
+    claimed = ds.ClaimBatch(10);
+    std::vector<int64_t> ids;
+    for (auto& entry : claimed) ids.push_back(entry.id_);
+    EXPECT_EQ((std::vector<int64_t>{2, 6, 9, 10}), ids);
+    EXPECT_TRUE(ds.ClaimBatch(10).empty());
+}
+
+TEST(ShardedDataSourceTest, ReadSince) {
+    ShardedDataSource ds{3, 100};
+    for (int64_t id = 1; id <= 10; id++) {
+        ds.Add(id, DUMMY_JSON);
+    }
+
+    auto handles = ds.ReadSince(4, 3);
+    ASSERT_EQ(3, handles.size());
+    for (int64_t i = 0; i < 3; i++) {
+        EXPECT_EQ(i + 5, handles[i].id_);
+    }
+    EXPECT_EQ(10, ds.ReadSince(0, 100).size());
+}
+
+TEST(ShardedDataSourceTest, ReadTimeRange) {
+    ShardedDataSource ds{3, 100};
+    for (int64_t id = 1; id <= 6; id++) {
+        ds.Add(id, DUMMY_JSON);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    auto all = ds.ReadTimeRange(0, std::numeric_limits<uint64_t>::max(), 100);
+    ASSERT_EQ(6, all.size());
+    for (int64_t i = 0; i < 6; i++) {
+        EXPECT_EQ(i + 1, all[i].id_);
+    }
+    auto range = ds.ReadTimeRange(all[2].timestamp_ms_, all[4].timestamp_ms_, 2);
+    ASSERT_EQ(2, range.size());
+    EXPECT_EQ(3, range[0].id_);
+    EXPECT_EQ(4, range[1].id_);
+}
+
+TEST(ShardedDataSourceTest, MaxAge) {
+    auto ds = DataSourceFactory::CreateDataSource(100, 0, true, 100, 100, false, 0, 3, 100);
+    EXPECT_EQ(100, ds->GetMaxAgeMs());
+
+    for (int64_t id = 1; id <= 6; id++) {
+        ds->Add(id, DUMMY_JSON);
+    }
+    for (int i = 0; i < 100 && ds->GetSize() > 0; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(0, ds->GetSize());
+    EXPECT_EQ(6, ds->AcknowledgeOverflow().list_.size());
+}
+
+TEST(ShardedDataSourceTest, EvictionPolicy) {
+    auto ds = DataSourceFactory::CreateDataSource(6, 0, true, 100, 100, false, 0, 3, 0, EvictionPolicy::PRIORITY);
+    EXPECT_EQ(EvictionPolicy::PRIORITY, ds->GetEvictionPolicy());
+
+    // ids 1 and 4 are on the same shard (2 entries per shard)
+    ds->Add(1, DUMMY_JSON);
+    ds->Add(4, DUMMY_JSON);
+    EXPECT_TRUE(ds->SetPriority(4, -1));
+    EXPECT_FALSE(ds->SetPriority(2, -1));
+    EXPECT_EQ(1, ds->Add(7, DUMMY_JSON));
+
+    boost::shared_lock<BufferSharedMutex> lock(ds->GetMergedSharedMutex());
+    EXPECT_EQ(ds->MergedEnd(), ds->MergedFind(4));
+    EXPECT_NE(ds->MergedEnd(), ds->MergedFind(1));
+}
+
+TEST(ShardedDataSourceTest, MaxBytes) {
+    auto ds = DataSourceFactory::CreateDataSource(100, 0, true, 100, 100, false, 0, 3, 0, EvictionPolicy::OLDEST, 30000);
+    EXPECT_EQ(30000, ds->GetMaxBytes());
+
+    for (int64_t id = 1; id <= 6; id++) {
+        ds->Add(id, DUMMY_JSON);
+    }
+    size_t bytes = 0;
+    for (auto& entry : *ds->GetSnapshot()) {
+        bytes += entry.bytes_;
+    }
+    EXPECT_EQ(bytes, ds->GetMemoryUsage());
+}
+
+TEST(ShardedDataSourceTest, CompactDataSets) {
+    auto ds = DataSourceFactory::CreateDataSource(100, 0, true, 100, 100, false, 0, 3, 0, EvictionPolicy::OLDEST, 0, true);
+    EXPECT_TRUE(ds->GetCompactDataSets());
+
+    for (int64_t id = 1; id <= 6; id++) {
+        ds->Add(id, DUMMY_JSON);
+    }
+    auto handles = ds->ReadSince(0, 10);
+    ASSERT_EQ(6, handles.size());
+    for (auto& handle : handles) {
+        ASSERT_NE(nullptr, handle.compact_);
+        EXPECT_EQ("a", handle.compact_->GetName(0));
+    }
+}
+
+TEST(ShardedDataSourceTest, ConsumerGroups) {
+    ShardedDataSource ds{3, 100};
+    ds.RegisterConsumerGroup("opcua");
+    ds.RegisterConsumerGroup("rest");
+
+    for (int64_t id = 1; id <= 10; id++) {
+        ds.Add(id, DUMMY_JSON);
+    }
+
+    // ordered by id across all shards
+    auto entries = ds.ReadGroup("opcua", 4);
+    ASSERT_EQ(4, entries.size());
+    for (int64_t i = 0; i < 4; i++) {
+        EXPECT_EQ(i + 1, entries[i].id_);
+    }
+    entries = ds.ReadGroup("opcua", 10);
+    ASSERT_EQ(6, entries.size());
+    EXPECT_EQ(5, entries.front().id_);
+    EXPECT_EQ(1, ds.ReadGroup("rest", 1).at(0).id_);
+
+    EXPECT_EQ(3, ds.AcknowledgeGroup("opcua", {1, 2, 3}));
+    EXPECT_EQ(10, ds.GetSize());
+    EXPECT_EQ(2, ds.AcknowledgeGroup("rest", {2, 3}));
+    EXPECT_EQ(8, ds.GetSize());
+    EXPECT_THROW(ds.AcknowledgeGroup("unknown", {}), RingBufferException);
+}
+
+TEST(ShardedDataSourceTest, WaitForNewData) {
+    ShardedDataSource ds{3, 100};
+
+    ds.Add(1, DUMMY_JSON);
+    EXPECT_FALSE(ds.WaitForNewData(1, 10));
+
+    // any shard wakes up the waiter
+    boost::thread producer([&ds]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        ds.Add(3, DUMMY_JSON);
+    });
+    EXPECT_TRUE(ds.WaitForNewData(1, 10000));
+    producer.join();
+    EXPECT_TRUE(ds.WaitForNewData(2, 0));
+}
+
+TEST(ShardedDataSourceTest, WaitForNewDataCounterMode1) {
+    ShardedDataSource ds{3, 100, 1};
+
+    ds.Add(5, DUMMY_JSON);
+    EXPECT_EQ(5, ds.GetLastId());
+    EXPECT_FALSE(ds.WaitForNewData(5, 10));
+
+    // a lower id in another shard is new data as well
+    boost::thread producer([&ds]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        ds.Add(1, DUMMY_JSON);
+    });
+    EXPECT_TRUE(ds.WaitForNewData(5, 10000));
+    producer.join();
+    EXPECT_EQ(1, ds.GetLastId());   // the id added last
+    EXPECT_TRUE(ds.WaitForNewData(5, 0));
+    EXPECT_FALSE(ds.WaitForNewData(1, 0));
+}
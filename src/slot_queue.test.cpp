@@ -0,0 +1,212 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <random>
+
+#include <slot_queue.hpp>
+
+using namespace qds_buffer::core;
+
+namespace {
+
+void ExpectEqual(const std::deque<int>& expected, SlotQueue<int>& queue) {
+    ASSERT_EQ(expected.size(), queue.size());
+    EXPECT_EQ(expected.empty(), queue.empty());
+
+    auto it = queue.begin();
+    for (int value : expected) {
+        ASSERT_NE(queue.end(), it);
+        EXPECT_EQ(value, *it);
+        ++it;
+    }
+    EXPECT_EQ(queue.end(), it);
+
+    // backwards
+    for (auto expected_it = expected.rbegin(); expected_it != expected.rend(); ++expected_it) {
+        --it;
+        EXPECT_EQ(*expected_it, *it);
+    }
+    EXPECT_EQ(queue.begin(), it);
+
+    if (!expected.empty()) {
+        EXPECT_EQ(expected.front(), queue.front());
+        EXPECT_EQ(expected.back(), queue.back());
+    }
+}
+
+}  // namespace
+
+TEST(SlotQueueTest, PushErase) {
+    SlotQueue<int> queue{4};
+    EXPECT_EQ(4, queue.capacity());
+    ExpectEqual({}, queue);
+
+    queue.push_back(1); queue.push_back(2); queue.push_back(3); queue.push_back(4);
+    ExpectEqual({1, 2, 3, 4}, queue);
+    EXPECT_EQ(3, *(queue.begin() + 2));
+    EXPECT_EQ(4, *(queue.end() - 1));
+    EXPECT_TRUE(queue.begin() < queue.end());
+
+    auto it = queue.erase(queue.begin() + 1); // tombstone in the middle
+    EXPECT_EQ(3, *it);
+    ExpectEqual({1, 3, 4}, queue);
+    EXPECT_EQ(4, *(queue.begin() + 2));
+
+    it = queue.erase(queue.begin()); // head advances over the tombstone
+    EXPECT_EQ(queue.begin(), it);
+    ExpectEqual({3, 4}, queue);
+
+    it = queue.erase(queue.end() - 1);
+    EXPECT_EQ(queue.end(), it);
+    ExpectEqual({3}, queue);
+
+    queue.erase(queue.begin());
+    ExpectEqual({}, queue);
+
+    queue.push_back(5);
+    ExpectEqual({5}, queue);
+
+    queue.clear();
+    ExpectEqual({}, queue);
+}
+
+TEST(SlotQueueTest, IteratorsStayValid) {
+    SlotQueue<int> queue{10};
+    for (int i = 0; i < 5; i++) queue.push_back(i);
+
+    auto third = queue.begin() + 2;
+    auto last = queue.end() - 1;
+    queue.erase(queue.begin());
+    queue.erase(queue.begin() + 2);
+    EXPECT_EQ(2, *third);
+    EXPECT_EQ(4, *last);
+    EXPECT_TRUE(third < last);
+}
+
+TEST(SlotQueueTest, IteratorDistance) {
+    SlotQueue<int> queue{10};
+    for (int i = 0; i < 6; i++) queue.push_back(i);
+    EXPECT_EQ(6, queue.end() - queue.begin());
+    EXPECT_EQ(-2, queue.begin() - (queue.begin() + 2));
+
+    // tombstone in the middle
+    queue.erase(queue.begin() + 2);
+    EXPECT_EQ(5, queue.end() - queue.begin());
+    EXPECT_EQ(3, *(queue.begin() + 2));
+    EXPECT_EQ(-3, (queue.begin() + 1) - (queue.end() - 1));
+}
+
+TEST(SlotQueueTest, IncrementalCompaction) {
+    const size_t capacity = 100;
+    SlotQueue<int> queue{capacity};
+    std::deque<int> expected;
+    int next_value = 0;
+    for (; next_value < static_cast<int>(capacity); next_value++) {
+        queue.push_back(next_value);
+        expected.push_back(next_value);
+    }
+
+    // the front element stays, every push erases an element behind it, leaving tombstones in the middle
+    std::mt19937 random(42);
+    size_t max_moves = 0;
+    for (int i = 0; i < 5000; i++) {
+        size_t position = 1 + random() % (expected.size() - 1);
+        queue.erase(queue.begin() + static_cast<std::ptrdiff_t>(position));
+        expected.erase(expected.begin() + static_cast<std::ptrdiff_t>(position));
+
+        size_t moves = 0;
+        queue.push_back(next_value, [&](int&, size_t) { moves++; });
+        expected.push_back(next_value++);
+        max_moves = std::max(max_moves, moves);
+
+        if (i % 100 == 0) {
+            ExpectEqual(expected, queue);
+        }
+    }
+    ExpectEqual(expected, queue);
+    // a push never compacts the whole queue
+    EXPECT_LE(max_moves, 8);
+}
+
+TEST(SlotQueueTest, ReleasesErasedValues) {
+    SlotQueue<std::shared_ptr<int>> queue{2};
+    auto value = std::make_shared<int>(1);
+
+    queue.push_back(value);
+    EXPECT_EQ(2, value.use_count());
+    queue.erase(queue.begin());
+    EXPECT_EQ(1, value.use_count());
+
+    queue.push_back(value);
+    queue.clear();
+    EXPECT_EQ(1, value.use_count());
+}
+
+TEST(SlotQueueTest, RandomOperations) {
+    // compares wrap-around, tombstones and compaction with std::deque
+    const size_t capacity = 50;
+    SlotQueue<int> queue{capacity};
+    std::deque<int> expected;
+
+    std::mt19937 random(4711);
+    int next_value = 0;
+    for (int i = 0; i < 20000; i++) {
+        unsigned operation = random() % 10;
+        if (operation < 6 && expected.size() < capacity) {
+            queue.push_back(next_value);
+            expected.push_back(next_value);
+            next_value++;
+        } else if (!expected.empty()) {
+            size_t position = random() % expected.size();
+            if (operation == 9) position = 0;
+            auto it = queue.erase(queue.begin() + static_cast<std::ptrdiff_t>(position));
+            auto expected_it = expected.erase(expected.begin() + static_cast<std::ptrdiff_t>(position));
+            if (expected_it == expected.end()) {
+                EXPECT_EQ(queue.end(), it);
+            } else {
+                EXPECT_EQ(*expected_it, *it);
+            }
+        }
+        if (i % 100 == 0) {
+            ExpectEqual(expected, queue);
+        }
+    }
+    ExpectEqual(expected, queue);
+}
+
+TEST(SlotQueueTest, PartitionPoint) {
+    SlotQueue<int> queue{100};
+    EXPECT_EQ(queue.end(), queue.partition_point([](int value) { return value < 5; }));
+
+    std::mt19937 random(7);
+    std::deque<int> expected;
+    for (int value = 0; value < 100; value++) {
+        queue.push_back(value);
+        expected.push_back(value);
+    }
+    // tombstones in the middle, at random positions
+    for (int i = 0; i < 60; i++) {
+        auto it = queue.begin();
+        it += random() % queue.size();
+        expected.erase(std::find(expected.begin(), expected.end(), *it));
+        queue.erase(it);
+    }
+    ExpectEqual(expected, queue);
+
+    for (int target = -1; target <= 100; target++) {
+        auto expected_it = std::lower_bound(expected.begin(), expected.end(), target);
+        auto it = queue.partition_point([target](int value) { return value < target; });
+        if (expected_it == expected.end()) {
+            EXPECT_EQ(queue.end(), it);
+        } else {
+            ASSERT_NE(queue.end(), it);
+            EXPECT_EQ(*expected_it, *it);
+        }
+    }
+}
@@ -0,0 +1,180 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <buffer_snapshot.hpp>
+
+namespace qds_buffer {
+
+    namespace core {
+
+        /*
+        * Keeps a copy of the buffer entries in chunks that published snapshots share (see SnapshotView), so the owner of a
+        * buffer can publish a new snapshot after every modification without copying the buffer
+        *
+        * Appending writes behind the last entry of the last chunk, which no published snapshot covers. Erasing the first or
+        * last entry of a range only shrinks the range; erasing one in the middle copies the rest of the range into a new
+        * chunk, and neighbouring ranges that fit into half a chunk are merged, so there are O(n / chunk size) ranges.
+        * Appending is O(1) amortized, erasing is O(chunk size + log n) and publishing is O(n / chunk size).
+        * Entries keep the order in which they were appended; an entry is found by its append sequence.
+        * Not Thread-Safe
+        */
+        class SnapshotBuilder {
+        public:
+            explicit SnapshotBuilder(size_t chunk_size) : kChunkSize_(std::max<size_t>(chunk_size, 2)), sequence_(0), modified_(false) {}
+
+            /*
+            * Appends an entry; its id must not be contained yet
+            */
+            void Append(const BufferEntry& entry) {
+                if (!ranges_.empty() && ranges_.back().end_ != ranges_.back().chunk_->sequences_.size() &&
+                    ranges_.back().Size() < kChunkSize_ / 2) {
+                    // the last entry of the chunk was erased; continue in a copy rather than leaving a small range behind
+                    Copy(ranges_.size() - 1, ranges_.size() - 1, sequence_);
+                }
+                if (ranges_.empty() || ranges_.back().end_ != ranges_.back().chunk_->sequences_.size() ||
+                    ranges_.back().end_ == kChunkSize_) {
+                    ranges_.push_back(Range{NewChunk(), 0, 0});
+                }
+                Range& range = ranges_.back();
+                (*range.chunk_->entries_)[range.end_++] = entry;
+                range.chunk_->sequences_.push_back(sequence_);
+                sequences_[entry.id_] = sequence_++;
+                modified_ = true;
+            }
+
+            /*
+            * Erases the entry with the given id, if contained
+            */
+            void Erase(int64_t id) {
+                auto it = sequences_.find(id);
+                if (it == sequences_.end()) {
+                    return;
+                }
+                uint64_t sequence = it->second;
+                sequences_.erase(it);
+                modified_ = true;
+
+                // last range beginning at or before the sequence
+                size_t index = std::upper_bound(ranges_.begin(), ranges_.end(), sequence,
+                                                [](uint64_t value, const Range& range) { return value < range.First(); }) -
+                               ranges_.begin() - 1;
+                Range& range = ranges_[index];
+                if (sequence == range.First()) {
+                    range.begin_++;
+                } else if (sequence == range.Last()) {
+                    // the chunk is not appended to anymore, the entry behind the range stays in it
+                    range.end_--;
+                } else {
+                    Copy(index, index, sequence);
+                }
+
+                if (ranges_[index].Size() == 0) {
+                    ranges_.erase(ranges_.begin() + index);
+                    if (index > 0) {
+                        Merge(index - 1);
+                    }
+                } else {
+                    Merge(index);
+                    if (index > 0) {
+                        Merge(index - 1);
+                    }
+                }
+            }
+
+            void Clear() {
+                ranges_.clear();
+                sequences_.clear();
+                modified_ = true;
+            }
+
+            /*
+            * @returns true if the entries were modified since the last Publish()
+            */
+            bool IsModified() const { return modified_; }
+
+            /*
+            * @returns the current entries; they are not modified by subsequent calls
+            */
+            BufferSnapshot Publish() {
+                std::vector<SnapshotView::Range> ranges;
+                ranges.reserve(ranges_.size());
+                for (auto& range : ranges_) {
+                    ranges.push_back(SnapshotView::Range{range.chunk_->entries_, range.begin_, range.end_});
+                }
+                modified_ = false;
+                return std::make_shared<const SnapshotView>(std::move(ranges));
+            }
+
+            size_t GetSize() const { return sequences_.size(); }
+            size_t GetRangeCount() const { return ranges_.size(); }
+
+        private:
+            struct Chunk {
+                std::shared_ptr<SnapshotView::Chunk> entries_;   // kChunkSize_ entries, the first sequences_.size() are used
+                std::vector<uint64_t> sequences_;                // append sequence of every used entry, ascending
+            };
+
+            struct Range {
+                std::shared_ptr<Chunk> chunk_;
+                size_t begin_;
+                size_t end_;
+
+                size_t Size() const { return end_ - begin_; }
+                uint64_t First() const { return chunk_->sequences_[begin_]; }
+                uint64_t Last() const { return chunk_->sequences_[end_ - 1]; }
+            };
+
+            std::shared_ptr<Chunk> NewChunk() const {
+                auto chunk = std::make_shared<Chunk>();
+                chunk->entries_ = std::make_shared<SnapshotView::Chunk>(kChunkSize_);
+                chunk->sequences_.reserve(kChunkSize_);
+                return chunk;
+            }
+
+            /*
+            * Replaces the ranges [first, last] by a new chunk with their entries except the one with the sequence skip
+            */
+            void Copy(size_t first, size_t last, uint64_t skip) {
+                auto chunk = NewChunk();
+                size_t size = 0;
+                for (size_t index = first; index <= last; index++) {
+                    Range& range = ranges_[index];
+                    for (size_t position = range.begin_; position < range.end_; position++) {
+                        uint64_t sequence = range.chunk_->sequences_[position];
+                        if (sequence != skip) {
+                            (*chunk->entries_)[size++] = (*range.chunk_->entries_)[position];
+                            chunk->sequences_.push_back(sequence);
+                        }
+                    }
+                }
+                ranges_[first] = Range{chunk, 0, size};
+                ranges_.erase(ranges_.begin() + first + 1, ranges_.begin() + last + 1);
+            }
+
+            /*
+            * Merges the ranges index and index + 1 if they fit into half a chunk
+            */
+            void Merge(size_t index) {
+                if (index + 1 < ranges_.size() && ranges_[index].Size() + ranges_[index + 1].Size() <= kChunkSize_ / 2) {
+                    Copy(index, index + 1, sequence_);
+                }
+            }
+
+            const size_t kChunkSize_;
+            std::vector<Range> ranges_;                         // in append order
+            std::unordered_map<int64_t, uint64_t> sequences_;   // append sequence by id
+            uint64_t sequence_;                                 // append sequence of the next entry
+            bool modified_;
+        };
+    } // namespace core
+} // namespace qds_buffer
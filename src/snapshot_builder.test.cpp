@@ -0,0 +1,121 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "snapshot_builder.hpp"
+
+using namespace qds_buffer::core;
+
+namespace {
+
+BufferEntry Entry(int64_t id) { return BufferEntry{id, std::make_shared<std::vector<Measurement>>(), 0, false, 0, nullptr}; }
+
+std::vector<int64_t> Ids(const BufferSnapshot& snapshot) {
+    std::vector<int64_t> ids;
+    for (const BufferEntry& entry : *snapshot) {
+        ids.push_back(entry.id_);
+    }
+    return ids;
+}
+
+}  // namespace
+
+TEST(SnapshotBuilderTest, AppendErase) {
+    SnapshotBuilder builder{4};
+    EXPECT_FALSE(builder.IsModified());
+    EXPECT_TRUE(builder.Publish()->empty());
+
+    for (int64_t id = 1; id <= 10; id++) {
+        builder.Append(Entry(id));
+    }
+    EXPECT_TRUE(builder.IsModified());
+    auto snapshot = builder.Publish();
+    EXPECT_FALSE(builder.IsModified());
+    EXPECT_EQ((std::vector<int64_t>{1, 2, 3, 4, 5, 6, 7, 8, 9, 10}), Ids(snapshot));
+    EXPECT_EQ(3, builder.GetRangeCount());
+
+    builder.Erase(1);    // first of a range
+    builder.Erase(8);    // last of a range
+    builder.Erase(6);    // in the middle, copied
+    builder.Erase(42);   // unknown
+    builder.Append(Entry(11));
+    auto current = builder.Publish();
+    EXPECT_EQ((std::vector<int64_t>{2, 3, 4, 5, 7, 9, 10, 11}), Ids(current));
+    ASSERT_EQ(8, current->size());
+    EXPECT_EQ(2, (*current)[0].id_);
+    EXPECT_EQ(7, (*current)[4].id_);
+    EXPECT_EQ(11, (*current)[7].id_);
+    EXPECT_EQ(2, current->front().id_);
+    EXPECT_EQ(11, current->back().id_);
+
+    // published snapshots are never modified
+    EXPECT_EQ((std::vector<int64_t>{1, 2, 3, 4, 5, 6, 7, 8, 9, 10}), Ids(snapshot));
+    EXPECT_EQ(8, (*snapshot)[7].id_);
+
+    builder.Clear();
+    EXPECT_TRUE(builder.Publish()->empty());
+    EXPECT_EQ(8, current->size());
+}
+
+TEST(SnapshotBuilderTest, MergeSmallRanges) {
+    SnapshotBuilder builder{16};
+    for (int64_t id = 1; id <= 32; id++) {
+        builder.Append(Entry(id));
+    }
+    EXPECT_EQ(2, builder.GetRangeCount());
+
+    // ranges that fit into half a chunk are merged
+    for (int64_t id = 2; id <= 13; id++) {
+        builder.Erase(id);
+        builder.Erase(id + 16);
+    }
+    EXPECT_EQ(1, builder.GetRangeCount());
+    EXPECT_EQ((std::vector<int64_t>{1, 14, 15, 16, 17, 30, 31, 32}), Ids(builder.Publish()));
+
+    // a small range that can't be appended to anymore is copied before appending
+    builder.Erase(32);
+    builder.Append(Entry(33));
+    EXPECT_EQ(1, builder.GetRangeCount());
+    EXPECT_EQ((std::vector<int64_t>{1, 14, 15, 16, 17, 30, 31, 33}), Ids(builder.Publish()));
+}
+
+TEST(SnapshotBuilderTest, RandomOperations) {
+    SnapshotBuilder builder{5};
+    std::vector<int64_t> expected;
+    std::vector<std::pair<BufferSnapshot, std::vector<int64_t>>> published;
+    std::mt19937 random(7);
+    int64_t next_id = 1;
+
+    for (int step = 0; step < 5000; step++) {
+        if (expected.empty() || random() % 3 != 0) {
+            builder.Append(Entry(next_id));
+            expected.push_back(next_id++);
+        } else {
+            size_t index = random() % 4 == 0 ? 0 : random() % expected.size();
+            builder.Erase(expected[index]);
+            expected.erase(expected.begin() + index);
+        }
+
+        if (step % 50 == 0) {
+            auto snapshot = builder.Publish();
+            ASSERT_EQ(expected, Ids(snapshot)) << "Step: " << step;
+            ASSERT_EQ(expected.size(), snapshot->size());
+            for (size_t i = 0; i < expected.size(); i++) {
+                ASSERT_EQ(expected[i], (*snapshot)[i].id_) << "Step: " << step;
+            }
+            published.emplace_back(snapshot, expected);
+        }
+        // O(n / chunk size) ranges
+        ASSERT_LE(builder.GetRangeCount(), 2 * expected.size() / 3 + 2) << "Step: " << step;
+    }
+
+    for (auto& snapshot : published) {
+        ASSERT_EQ(snapshot.second, Ids(snapshot.first));
+    }
+}
@@ -0,0 +1,100 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#include "staging_publisher.hpp"
+
+namespace qds_buffer {
+
+    namespace core {
+
+        StagingPublisher::StagingPublisher(size_t queue_size, PublishFunction publish_function)
+            : queue_(queue_size),
+            publish_function_(publish_function),
+            staged_count_(0),
+            published_count_(0),
+            publisher_waiting_(false),
+            stop_(false),
+            publisher_(&StagingPublisher::Run, this) {}
+
+        StagingPublisher::~StagingPublisher() {
+            {
+                boost::lock_guard<boost::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            staged_condition_.notify_one();
+            publisher_.join();
+        }
+
+        void StagingPublisher::Stage(int64_t id, std::shared_ptr<std::vector<Measurement>> measurements) {
+            StagedEntry entry(id, std::move(measurements));
+            while (!queue_.TryPush(std::move(entry))) {
+                // queue is full, the publisher is behind
+                boost::this_thread::yield();
+            }
+            staged_count_++;
+
+            // the mutex is only taken if the publisher is idle
+            if (publisher_waiting_) {
+                boost::lock_guard<boost::mutex> lock(mutex_);
+                staged_condition_.notify_one();
+            }
+        }
+
+        void StagingPublisher::Flush() {
+            // entries are published in queue order, so every entry queued before this call is published once the
+            // published count reaches the number of claimed queue positions
+            uint64_t target = queue_.GetEnqueuedCount();
+
+            boost::unique_lock<boost::mutex> lock(mutex_);
+            published_condition_.wait(lock, [&]() { return published_count_ >= target; });
+        }
+
+        size_t StagingPublisher::GetQueueSize() const {
+            return queue_.GetCapacity();
+        }
+
+        void StagingPublisher::Run() {
+            std::vector<StagedEntry> batch;
+            batch.reserve(kMaxBatchSize_);
+
+            for (;;) {
+                StagedEntry entry;
+                while (batch.size() < kMaxBatchSize_ && queue_.TryPop(entry)) {
+                    batch.push_back(std::move(entry));
+                }
+
+                if (!batch.empty()) {
+                    try {
+                        publish_function_(batch);
+                    } catch (...) {
+                        // the publish function reports failures per entry, nothing to recover here
+                    }
+
+                    {
+                        boost::lock_guard<boost::mutex> lock(mutex_);
+                        published_count_ += batch.size();
+                    }
+                    published_condition_.notify_all();
+                    batch.clear();
+                    continue;
+                }
+
+                boost::unique_lock<boost::mutex> lock(mutex_);
+                // staged_count_ is incremented after the push, so a pending entry might not be poppable yet: retry then
+                if (staged_count_ != published_count_) {
+                    lock.unlock();
+                    boost::this_thread::yield();
+                    continue;
+                }
+                if (stop_) {
+                    return;
+                }
+
+                publisher_waiting_ = true;
+                staged_condition_.wait(lock, [&]() { return stop_ || staged_count_ != published_count_; });
+                publisher_waiting_ = false;
+            }
+        }
+    } // namespace core
+} // namespace qds_buffer
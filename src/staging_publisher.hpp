@@ -0,0 +1,65 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <boost/thread.hpp>
+#include <measurement.hpp>
+
+#include "staging_queue.hpp"
+
+namespace qds_buffer {
+
+    namespace core {
+
+        using StagedEntry = std::pair<int64_t, std::shared_ptr<std::vector<Measurement>>>;
+        using PublishFunction = std::function<void(const std::vector<StagedEntry>&)>;
+
+        /**
+         * Thread-Safe
+         *
+         * Decouples producers from the ring buffer lock: Stage() only enqueues into a lock-free StagingQueue, a single
+         * publisher thread drains the queue and hands the entries in batches (in staging order) to the publish function.
+         * Producers only wait if the queue is full or if they explicitly Flush().
+         */
+        class StagingPublisher {
+        public:
+            StagingPublisher(size_t queue_size, PublishFunction publish_function);
+            // publishes all remaining entries before returning
+            ~StagingPublisher();
+
+            void Stage(int64_t id, std::shared_ptr<std::vector<Measurement>> measurements);
+            /*
+            * Waits until all entries staged before the call are published
+            */
+            void Flush();
+
+            size_t GetQueueSize() const;
+
+        private:
+            void Run();
+
+            const size_t kMaxBatchSize_ = 256;
+
+            StagingQueue<StagedEntry> queue_;
+            PublishFunction publish_function_;
+
+            std::atomic<uint64_t> staged_count_;
+            std::atomic<uint64_t> published_count_;
+            std::atomic<bool> publisher_waiting_;
+            std::atomic<bool> stop_;
+
+            boost::mutex mutex_;
+            boost::condition_variable staged_condition_;      // publisher waits for new entries
+            boost::condition_variable published_condition_;   // Flush() waits for published entries
+            boost::thread publisher_;
+        };
+    } // namespace core
+} // namespace qds_buffer
@@ -0,0 +1,117 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace qds_buffer {
+
+    namespace core {
+
+        /**
+         * Thread-Safe for multiple producers (TryPush) and a single consumer (TryPop)
+         *
+         * Bounded lock-free FIFO queue on a ring of cells with per-cell sequence numbers (D. Vyukov's bounded queue):
+         * producers claim a position with a single compare-and-swap and publish the cell by advancing its sequence,
+         * the consumer only reads. The capacity is rounded up to a power of two.
+         */
+        template <typename T>
+        class StagingQueue {
+        public:
+            explicit StagingQueue(size_t capacity)
+                : kCapacity_(RoundUpToPowerOfTwo(capacity)),
+                kMask_(kCapacity_ - 1),
+                cells_(new Cell[kCapacity_]),
+                enqueue_position_(0),
+                dequeue_position_(0) {
+                for (size_t i = 0; i < kCapacity_; i++) {
+                    cells_[i].sequence_.store(i, std::memory_order_relaxed);
+                }
+            }
+
+            /*
+            * @returns false if the queue is full
+            */
+            bool TryPush(T&& value) {
+                size_t position = enqueue_position_.load(std::memory_order_relaxed);
+                for (;;) {
+                    Cell& cell = cells_[position & kMask_];
+                    size_t sequence = cell.sequence_.load(std::memory_order_acquire);
+                    std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+                    if (difference == 0) {
+                        // cell is free, try to claim the position
+                        if (enqueue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                            cell.value_ = std::move(value);
+                            cell.sequence_.store(position + 1, std::memory_order_release);
+                            return true;
+                        }
+                    } else if (difference < 0) {
+                        // cell still holds the value of the previous round
+                        return false;
+                    } else {
+                        // another producer claimed the position
+                        position = enqueue_position_.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            /*
+            * Single consumer only
+            *
+            * @returns false if the queue is empty
+            */
+            bool TryPop(T& value) {
+                Cell& cell = cells_[dequeue_position_ & kMask_];
+                size_t sequence = cell.sequence_.load(std::memory_order_acquire);
+                if (sequence != dequeue_position_ + 1) {
+                    return false;
+                }
+
+                value = std::move(cell.value_);
+                cell.value_ = T();
+                cell.sequence_.store(dequeue_position_ + kCapacity_, std::memory_order_release);
+                dequeue_position_++;
+                return true;
+            }
+
+            /*
+            * @returns number of positions claimed by producers so far (including pushes that are still in progress)
+            */
+            size_t GetEnqueuedCount() const {
+                return enqueue_position_.load();
+            }
+
+            size_t GetCapacity() const {
+                return kCapacity_;
+            }
+
+        private:
+            struct Cell {
+                std::atomic<size_t> sequence_;
+                T value_;
+            };
+
+            static size_t RoundUpToPowerOfTwo(size_t value) {
+                size_t result = 2;
+                while (result < value) result <<= 1;
+                return result;
+            }
+
+            const size_t kCapacity_;
+            const size_t kMask_;
+            std::unique_ptr<Cell[]> cells_;
+
+            // producers and consumer positions on separate cache lines
+            char padding0_[64];
+            std::atomic<size_t> enqueue_position_;
+            char padding1_[64];
+            size_t dequeue_position_;
+        };
+    } // namespace core
+} // namespace qds_buffer
@@ -0,0 +1,102 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#include <gtest/gtest.h>
+
+#include <boost/thread.hpp>
+
+#include "staging_publisher.hpp"
+#include "staging_queue.hpp"
+
+using namespace qds_buffer::core;
+
+TEST(StagingQueueTest, PushPop) {
+    StagingQueue<int> queue{3};
+    EXPECT_EQ(4, queue.GetCapacity());
+
+    int value = 0;
+    EXPECT_FALSE(queue.TryPop(value));
+
+    for (int i = 1; i <= 4; i++) {
+        EXPECT_TRUE(queue.TryPush(std::move(i)));
+    }
+    int overflow = 5;
+    EXPECT_FALSE(queue.TryPush(std::move(overflow))); // full
+    EXPECT_EQ(4, queue.GetEnqueuedCount());
+
+    for (int i = 1; i <= 4; i++) {
+        EXPECT_TRUE(queue.TryPop(value));
+        EXPECT_EQ(i, value);
+    }
+    EXPECT_FALSE(queue.TryPop(value));
+
+    // wraps around
+    int next = 6;
+    EXPECT_TRUE(queue.TryPush(std::move(next)));
+    EXPECT_TRUE(queue.TryPop(value));
+    EXPECT_EQ(6, value);
+}
+
+TEST(StagingQueueTest, MultipleProducers) {
+    const int producer_count = 4;
+    const int values_per_producer = 20000;
+    StagingQueue<int> queue{64};
+
+    boost::thread_group producers;
+    for (int p = 0; p < producer_count; p++) {
+        producers.create_thread([&, p]() {
+            for (int i = 0; i < values_per_producer; i++) {
+                int value = p * values_per_producer + i;
+                while (!queue.TryPush(std::move(value))) {
+                    boost::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    // every value arrives exactly once, the values of each producer in order
+    std::vector<int> last_value(producer_count, -1);
+    int received = 0;
+    while (received < producer_count * values_per_producer) {
+        int value;
+        if (!queue.TryPop(value)) {
+            boost::this_thread::yield();
+            continue;
+        }
+        int producer = value / values_per_producer;
+        ASSERT_LT(last_value[producer], value);
+        last_value[producer] = value;
+        received++;
+    }
+    producers.join_all();
+
+    int value;
+    EXPECT_FALSE(queue.TryPop(value));
+}
+
+TEST(StagingPublisherTest, PublishesInOrder) {
+    std::vector<int64_t> published;
+    size_t batch_count = 0;
+    {
+        StagingPublisher publisher(8, [&](const std::vector<StagedEntry>& entries) {
+            batch_count++;
+            for (auto& entry : entries) published.push_back(entry.first);
+        });
+        EXPECT_EQ(8, publisher.GetQueueSize());
+
+        for (int64_t id = 1; id <= 1000; id++) {
+            publisher.Stage(id, nullptr);
+        }
+        publisher.Flush();
+        ASSERT_EQ(1000, published.size());
+
+        publisher.Stage(1001, nullptr);
+    } // destructor publishes the remaining entries
+
+    ASSERT_EQ(1001, published.size());
+    for (size_t i = 0; i < published.size(); i++) {
+        EXPECT_EQ(static_cast<int64_t>(i + 1), published[i]);
+    }
+    EXPECT_LE(batch_count, published.size());
+}
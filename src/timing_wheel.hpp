@@ -0,0 +1,157 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace qds_buffer {
+
+    namespace core {
+
+        /*
+        * Hierarchical timing wheel for timers with a deadline in ticks
+        *
+        * Level 0 has one slot per tick, every higher level has slots that cover a whole revolution of the level below. A timer
+        * is put into the level that matches its distance to the deadline and moves down (cascades) as the deadline approaches,
+        * so scheduling is O(1) and advancing is O(1) per timer and level; there is no scan over all timers. Advancing jumps
+        * over the ticks without timers in the slots due on them (found via a bit mask of the occupied slots per level), so
+        * its cost doesn't depend on the number of ticks passed. Deadlines beyond the top level are parked in the top level
+        * and rescheduled when they come around.
+        *
+        * Not Thread-Safe
+        */
+        template <typename T>
+        class TimingWheel {
+        public:
+            explicit TimingWheel(uint64_t current_tick = 0)
+                : current_tick_(current_tick), size_(0), slots_(kLevels_ * kSlots_), occupied_(kLevels_, 0) {}
+
+            /*
+            * Schedules a timer; a deadline that has already passed expires on the next tick
+            */
+            void Schedule(uint64_t deadline_tick, T value) {
+                if (deadline_tick <= current_tick_) {
+                    deadline_tick = current_tick_ + 1;
+                }
+                Insert(Timer{deadline_tick, std::move(value)});
+                size_++;
+            }
+
+            /*
+            * Advances the wheel to the given tick and calls on_expire(value) for every timer whose deadline has been reached
+            */
+            template <typename OnExpire>
+            void Advance(uint64_t tick, OnExpire on_expire) {
+                while (current_tick_ < tick) {
+                    // nothing happens on the ticks in between
+                    uint64_t next_tick = GetNextTick();
+                    if (next_tick > tick) {
+                        current_tick_ = tick;
+                        return;
+                    }
+                    current_tick_ = next_tick;
+
+                    // move the timers of the higher level slots that begin with this tick down, highest level first
+                    for (size_t level = kLevels_ - 1; level > 0; level--) {
+                        if ((current_tick_ & (LevelSpan(level) - 1)) == 0) {
+                            std::vector<Timer> timers = Take(level, SlotIndex(level, current_tick_));
+                            for (auto& timer : timers) {
+                                Insert(std::move(timer));
+                            }
+                        }
+                    }
+
+                    std::vector<Timer> timers = Take(0, SlotIndex(0, current_tick_));
+                    for (auto& timer : timers) {
+                        size_--;
+                        on_expire(timer.value_);
+                    }
+                }
+            }
+
+            void Clear() {
+                for (auto& slot : slots_) slot.clear();
+                std::fill(occupied_.begin(), occupied_.end(), 0);
+                size_ = 0;
+            }
+
+            size_t GetSize() const { return size_; }
+            uint64_t GetCurrentTick() const { return current_tick_; }
+
+        private:
+            struct Timer {
+                uint64_t deadline_tick_;
+                T value_;
+            };
+
+            static const size_t kLevels_ = 4;
+            static const size_t kSlotBits_ = 6;
+            static const size_t kSlots_ = size_t(1) << kSlotBits_;
+
+            // number of ticks covered by a single slot of the level
+            static uint64_t LevelSpan(size_t level) { return uint64_t(1) << (kSlotBits_ * level); }
+            static size_t SlotIndex(size_t level, uint64_t tick) { return (tick >> (kSlotBits_ * level)) & (kSlots_ - 1); }
+
+            std::vector<Timer>& Slot(size_t level, size_t index) { return slots_[level * kSlots_ + index]; }
+
+            // empties a slot
+            std::vector<Timer> Take(size_t level, size_t index) {
+                std::vector<Timer> timers;
+                timers.swap(Slot(level, index));
+                occupied_[level] &= ~(uint64_t(1) << index);
+                return timers;
+            }
+
+            /*
+            * @returns the first tick after the current one with timers in a slot due on it (max if there are no timers); the
+            *          slots of a level are due in turn, one per LevelSpan(level) ticks, beginning behind the current slot
+            */
+            uint64_t GetNextTick() const {
+                uint64_t next_tick = std::numeric_limits<uint64_t>::max();
+                for (size_t level = 0; level < kLevels_; level++) {
+                    if (occupied_[level] == 0) {
+                        continue;
+                    }
+                    size_t current = SlotIndex(level, current_tick_);
+                    for (uint64_t step = 1; step <= kSlots_; step++) {
+                        if (occupied_[level] & (uint64_t(1) << ((current + step) & (kSlots_ - 1)))) {
+                            uint64_t slot_tick = ((current_tick_ >> (kSlotBits_ * level)) + step) << (kSlotBits_ * level);
+                            next_tick = std::min(next_tick, slot_tick);
+                            break;
+                        }
+                    }
+                }
+                return next_tick;
+            }
+
+            void Insert(Timer timer) {
+                uint64_t distance = timer.deadline_tick_ - current_tick_;
+
+                size_t level = 0;
+                while (level + 1 < kLevels_ && distance >= LevelSpan(level + 1)) {
+                    level++;
+                }
+
+                // park deadlines beyond the top level in the last slot it reaches
+                uint64_t tick = timer.deadline_tick_;
+                if (distance >= LevelSpan(kLevels_)) {
+                    tick = current_tick_ + LevelSpan(kLevels_) - 1;
+                }
+                Slot(level, SlotIndex(level, tick)).push_back(std::move(timer));
+                occupied_[level] |= uint64_t(1) << SlotIndex(level, tick);
+            }
+
+            uint64_t current_tick_;
+            size_t size_;
+            std::vector<std::vector<Timer>> slots_;   // kLevels_ x kSlots_
+            std::vector<uint64_t> occupied_;          // per level, bit i is set if slot i has timers (kSlots_ bits)
+        };
+    } // namespace core
+} // namespace qds_buffer
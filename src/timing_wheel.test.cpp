@@ -0,0 +1,90 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "timing_wheel.hpp"
+
+using namespace qds_buffer::core;
+
+TEST(TimingWheelTest, Expire) {
+    TimingWheel<int> wheel{100};
+    std::vector<int> expired;
+    auto on_expire = [&expired](int value) { expired.push_back(value); };
+
+    wheel.Schedule(105, 1);
+    wheel.Schedule(101, 2);
+    wheel.Schedule(50, 3);   // already passed, expires on the next tick
+    EXPECT_EQ(3, wheel.GetSize());
+
+    wheel.Advance(100, on_expire);
+    EXPECT_TRUE(expired.empty());
+
+    wheel.Advance(101, on_expire);
+    EXPECT_EQ((std::vector<int>{2, 3}), expired);
+
+    wheel.Advance(104, on_expire);
+    EXPECT_EQ(2, expired.size());
+    wheel.Advance(110, on_expire);
+    EXPECT_EQ((std::vector<int>{2, 3, 1}), expired);
+    EXPECT_EQ(0, wheel.GetSize());
+
+    // nothing to do, jumps ahead
+    wheel.Advance(1000000, on_expire);
+    EXPECT_EQ(1000000, wheel.GetCurrentTick());
+
+    wheel.Schedule(1000001, 4);
+    wheel.Clear();
+    wheel.Advance(1000010, on_expire);
+    EXPECT_EQ(3, expired.size());
+}
+
+TEST(TimingWheelTest, Cascade) {
+    // deadlines on all levels (and beyond), every timer expires exactly at its deadline
+    const uint64_t start = 12345;
+    TimingWheel<uint64_t> wheel{start};   // value: deadline
+
+    std::mt19937_64 random(42);
+    std::vector<uint64_t> deadlines = {start + 63, start + 64, start + 65, start + 4095, start + 4096, start + 262144,
+                                       start + 16777215, start + 16777216, start + 20000000};
+    for (int i = 0; i < 1000; i++) {
+        deadlines.push_back(start + 1 + random() % 300000);
+    }
+    for (uint64_t deadline : deadlines) {
+        wheel.Schedule(deadline, deadline);
+    }
+
+    size_t expired = 0;
+    uint64_t tick = start;
+    while (wheel.GetSize() > 0) {
+        // advance in irregular steps
+        tick += 1 + random() % 1000;
+        wheel.Advance(tick, [&expired, &wheel](uint64_t deadline) {
+            EXPECT_EQ(deadline, wheel.GetCurrentTick());
+            expired++;
+        });
+    }
+    EXPECT_EQ(deadlines.size(), expired);
+}
+
+TEST(TimingWheelTest, SkipIdleTicks) {
+    // a single call over a long idle period only visits the slots with timers
+    TimingWheel<uint64_t> wheel{0};   // value: deadline
+    std::vector<uint64_t> deadlines = {5, 70, 5000, 300000, 16777300, 500000000};
+    for (uint64_t deadline : deadlines) {
+        wheel.Schedule(deadline, deadline);
+    }
+
+    std::vector<uint64_t> expired;
+    wheel.Advance(1000000000, [&expired, &wheel](uint64_t deadline) {
+        EXPECT_EQ(deadline, wheel.GetCurrentTick());
+        expired.push_back(deadline);
+    });
+    EXPECT_EQ(deadlines, expired);
+    EXPECT_EQ(1000000000, wheel.GetCurrentTick());
+    EXPECT_EQ(0, wheel.GetSize());
+}
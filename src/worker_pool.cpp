@@ -0,0 +1,90 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#include "worker_pool.hpp"
+
+#include <algorithm>
+
+namespace qds_buffer {
+
+    namespace core {
+
+        WorkerPool::WorkerPool(size_t thread_count)
+            : kThreadCount_(std::max<size_t>(thread_count, 1)),
+            function_(nullptr),
+            part_count_(0),
+            next_part_(0),
+            pending_parts_(0),
+            stop_(false) {}
+
+        WorkerPool::~WorkerPool() {
+            {
+                boost::lock_guard<boost::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            task_condition_.notify_all();
+            workers_.join_all();
+        }
+
+        void WorkerPool::Run(size_t part_count, const PartFunction& function) {
+            boost::unique_lock<boost::mutex> run_lock(run_mutex_, boost::try_to_lock);
+            if (part_count <= 1 || kThreadCount_ == 1 || !run_lock.owns_lock()) {
+                for (size_t part = 0; part < part_count; part++) {
+                    function(part);
+                }
+                return;
+            }
+
+            // only Run() starts workers, so the run lock protects workers_
+            if (workers_.size() == 0) {
+                for (size_t t = 1; t < kThreadCount_; t++) {
+                    workers_.create_thread([this]() { Work(); });
+                }
+            }
+
+            boost::unique_lock<boost::mutex> lock(mutex_);
+            function_ = &function;
+            part_count_ = part_count;
+            next_part_ = 0;
+            pending_parts_ = part_count;
+            task_condition_.notify_all();
+
+            RunParts(lock);
+            done_condition_.wait(lock, [this]() { return pending_parts_ == 0; });
+            function_ = nullptr;
+            part_count_ = 0;
+            next_part_ = 0;
+        }
+
+        size_t WorkerPool::GetThreadCount() const {
+            return kThreadCount_;
+        }
+
+        void WorkerPool::Work() {
+            boost::unique_lock<boost::mutex> lock(mutex_);
+            for (;;) {
+                task_condition_.wait(lock, [this]() { return stop_ || next_part_ < part_count_; });
+                if (stop_) {
+                    return;
+                }
+                RunParts(lock);
+            }
+        }
+
+        void WorkerPool::RunParts(boost::unique_lock<boost::mutex>& lock) {
+            while (next_part_ < part_count_) {
+                size_t part = next_part_++;
+                const PartFunction& function = *function_;
+
+                lock.unlock();
+                function(part);
+                lock.lock();
+
+                if (--pending_parts_ == 0) {
+                    done_condition_.notify_one();
+                }
+            }
+        }
+    } // namespace core
+} // namespace qds_buffer
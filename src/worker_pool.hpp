@@ -0,0 +1,59 @@
+// SPDX-FileCopyrightText: Copyright (c) 2009-2022 TRUMPF Laser GmbH, authors: Daniel Schnabel
+//
+// SPDX-License-Identifier: MPL-2.0
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+#include <boost/thread.hpp>
+
+namespace qds_buffer {
+
+    namespace core {
+
+        // runs part part of a task; must not throw
+        using PartFunction = std::function<void(size_t part)>;
+
+        /**
+         * Thread-Safe
+         *
+         * Persistent worker threads that run the parts of a task together with the calling thread, so a burst doesn't pay
+         * for starting and joining threads. The workers are started on the first task with more than one part and wait
+         * for the next task in between. A task that is run while another one is running is run on the calling thread only.
+         */
+        class WorkerPool {
+        public:
+            // thread_count: maximum number of threads running a task, including the calling thread
+            explicit WorkerPool(size_t thread_count);
+            ~WorkerPool();
+
+            /*
+            * Runs function for every part in [0, part_count) and returns once all parts are done
+            */
+            void Run(size_t part_count, const PartFunction& function);
+
+            size_t GetThreadCount() const;
+
+        private:
+            void Work();
+            // runs parts of the current task until none are left; requires the lock on mutex_
+            void RunParts(boost::unique_lock<boost::mutex>& lock);
+
+            const size_t kThreadCount_;
+
+            boost::mutex run_mutex_;   // held while a task is run on the workers
+            boost::mutex mutex_;
+            boost::condition_variable task_condition_;   // workers wait for a task
+            boost::condition_variable done_condition_;   // Run() waits for the parts to be done
+
+            const PartFunction* function_;
+            size_t part_count_;
+            size_t next_part_;
+            size_t pending_parts_;
+            bool stop_;
+            boost::thread_group workers_;
+        };
+    } // namespace core
+} // namespace qds_buffer